@@ -0,0 +1,47 @@
+#include "Bench.h"
+#include "BenchGraphs.h"
+#include <algorithm>
+#include <cstdio>
+
+BenchRun::BenchRun(const char* name, const SyntheticGraph* graph, const BenchConfig& config)
+    : name(name), graph(graph), config(config), samples(nullptr), numSamples(0), sampleCapacity(0), totalNs(0),
+      operations(0), startedAt(std::chrono::steady_clock::now()) {}
+
+BenchRun::~BenchRun() {
+    delete[] samples;
+}
+
+bool BenchRun::keepRunning() const {
+    if (operations >= config.maxIterations) return false;
+    return elapsedNs(startedAt) < config.minTimeMs * 1000000LL;
+}
+
+void BenchRun::record(long long ns, long long ops) {
+    if (ops <= 0) return;
+    if (numSamples == sampleCapacity) {
+        long long newCapacity = sampleCapacity > 0 ? sampleCapacity * 2 : 1024;
+        long long* next = new long long[newCapacity];
+        for (long long i = 0; i < numSamples; ++i) next[i] = samples[i];
+        delete[] samples;
+        samples = next;
+        sampleCapacity = newCapacity;
+    }
+    samples[numSamples++] = ns / ops;
+    totalNs += ns;
+    operations += ops;
+}
+
+void BenchRun::report() {
+    std::sort(samples, samples + numSamples);
+    auto at = [this](double q) -> long long {
+        if (numSamples == 0) return 0;
+        long long idx = static_cast<long long>(q * (numSamples - 1) + 0.5);
+        return samples[idx];
+    };
+    double nsPerOp = operations > 0 ? static_cast<double>(totalNs) / operations : 0.0;
+    std::printf("{\"bench\":\"%s\",\"graph\":\"%s\",\"nodes\":%d,\"edges\":%d,\"iterations\":%lld,"
+                "\"ns_per_op\":%.1f,\"p50_ns\":%lld,\"p99_ns\":%lld,\"max_ns\":%lld}\n",
+                name, graph ? graph->kind : "none", graph ? graph->numNodes : 0, graph ? graph->numEdges : 0, operations, nsPerOp, at(0.5), at(0.99),
+                numSamples > 0 ? samples[numSamples - 1] : 0);
+    std::fflush(stdout);
+}
@@ -0,0 +1,56 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+
+struct SyntheticGraph;
+
+struct BenchConfig {
+    long long minTimeMs;
+    long long maxIterations;
+    unsigned long long seed;
+};
+
+// Collects per-operation latencies for one benchmark and prints a single
+// JSON line when done. Operations too cheap to time individually are timed
+// in batches and recorded as per-op averages.
+class BenchRun {
+private:
+    const char* name;
+    const SyntheticGraph* graph;
+    const BenchConfig& config;
+
+    long long* samples;
+    long long numSamples;
+    long long sampleCapacity;
+    long long totalNs;
+    long long operations;
+    std::chrono::steady_clock::time_point startedAt;
+
+public:
+    // `graph` may be null for benchmarks that don't depend on the city
+    BenchRun(const char* name, const SyntheticGraph* graph, const BenchConfig& config);
+    ~BenchRun();
+    BenchRun(const BenchRun&) = delete;
+    BenchRun& operator=(const BenchRun&) = delete;
+
+    // True while the time budget and iteration cap both allow another sample
+    bool keepRunning() const;
+    void record(long long ns, long long ops = 1);
+    // Prints {"bench":..., "graph":..., "ns_per_op":..., "p50_ns":...} to stdout
+    void report();
+};
+
+inline long long elapsedNs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Each suite builds whatever state it needs from `graph` and reports one
+// BenchRun per operation it measures
+void benchRouting(const SyntheticGraph& graph, const BenchConfig& config);
+void benchDispatch(const SyntheticGraph& graph, const BenchConfig& config);
+void benchLifecycle(const SyntheticGraph& graph, const BenchConfig& config);
+// Graph independent; run once per invocation
+void benchRollback(const BenchConfig& config);
+
+#endif
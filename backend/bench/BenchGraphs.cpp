@@ -0,0 +1,168 @@
+#include "BenchGraphs.h"
+#include "../src/core/City.h"
+#include "../src/system/RideShareSystem.h"
+#include <cmath>
+#include <string>
+
+namespace {
+
+// Zones form a ZONE_GRID x ZONE_GRID partition of the unit square
+const int ZONE_GRID = 8;
+const double EXPECTED_DEGREE = 6.0;
+const double PI = 3.14159265358979323846;
+
+// Unit square side in weight units; an edge's weight is its length in these
+const double WEIGHT_SCALE = 100000.0;
+
+int zoneOf(double x, double y) {
+    int zx = static_cast<int>(x * ZONE_GRID);
+    int zy = static_cast<int>(y * ZONE_GRID);
+    if (zx >= ZONE_GRID) zx = ZONE_GRID - 1;
+    if (zy >= ZONE_GRID) zy = ZONE_GRID - 1;
+    return zy * ZONE_GRID + zx;
+}
+
+void allocateNodes(SyntheticGraph& g, int numNodes) {
+    g.numNodes = numNodes;
+    g.x = new double[numNodes];
+    g.y = new double[numNodes];
+    g.zone = new int[numNodes];
+}
+
+void allocateEdges(SyntheticGraph& g, int capacity) {
+    g.numEdges = 0;
+    g.from = new int[capacity];
+    g.to = new int[capacity];
+    g.weight = new int[capacity];
+}
+
+void pushEdge(SyntheticGraph& g, int a, int b, int w) {
+    g.from[g.numEdges] = a;
+    g.to[g.numEdges] = b;
+    g.weight[g.numEdges] = w > 0 ? w : 1;
+    g.numEdges++;
+}
+
+} // namespace
+
+SyntheticGraph::SyntheticGraph()
+    : kind(""), numNodes(0), x(nullptr), y(nullptr), zone(nullptr), numEdges(0), from(nullptr), to(nullptr),
+      weight(nullptr) {}
+
+SyntheticGraph::~SyntheticGraph() {
+    delete[] x;
+    delete[] y;
+    delete[] zone;
+    delete[] from;
+    delete[] to;
+    delete[] weight;
+}
+
+void SyntheticGraph::loadInto(City& city) const {
+    for (int i = 0; i < numNodes; ++i) {
+        city.addNode(i, "n" + std::to_string(i), "z" + std::to_string(zone[i]), 40.0 + y[i] * 0.5, -74.0 + x[i] * 0.5);
+    }
+    for (int e = 0; e < numEdges; ++e) city.addEdge(from[e], to[e], weight[e]);
+}
+
+void SyntheticGraph::loadInto(RideShareSystem& system) const {
+    for (int i = 0; i < numNodes; ++i) {
+        system.addNode(i, "n" + std::to_string(i), "z" + std::to_string(zone[i]), 40.0 + y[i] * 0.5,
+                       -74.0 + x[i] * 0.5);
+    }
+    for (int e = 0; e < numEdges; ++e) system.addEdge(from[e], to[e], weight[e]);
+}
+
+void buildGridGraph(SyntheticGraph& out, int numNodes, unsigned long long seed) {
+    BenchRng rng(seed);
+    int side = static_cast<int>(std::sqrt(static_cast<double>(numNodes)));
+    if (side < 2) side = 2;
+    int n = side * side;
+
+    out.kind = "grid";
+    allocateNodes(out, n);
+    allocateEdges(out, 2 * n);
+    double spacing = 1.0 / side;
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int id = r * side + c;
+            out.x[id] = (c + 0.5) * spacing;
+            out.y[id] = (r + 0.5) * spacing;
+            out.zone[id] = zoneOf(out.x[id], out.y[id]);
+        }
+    }
+    // Blocks cost between 0.75x and 1.25x their length so shortest paths
+    // are unique and not simply Manhattan
+    int base = static_cast<int>(spacing * WEIGHT_SCALE);
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int id = r * side + c;
+            if (c + 1 < side) pushEdge(out, id, id + 1, base * 3 / 4 + rng.nextInt(base / 2 + 1));
+            if (r + 1 < side) pushEdge(out, id, id + side, base * 3 / 4 + rng.nextInt(base / 2 + 1));
+        }
+    }
+}
+
+void buildGeometricGraph(SyntheticGraph& out, int numNodes, unsigned long long seed) {
+    BenchRng rng(seed);
+    int n = numNodes > 2 ? numNodes : 2;
+
+    out.kind = "geometric";
+    allocateNodes(out, n);
+    for (int i = 0; i < n; ++i) {
+        out.x[i] = rng.nextDouble();
+        out.y[i] = rng.nextDouble();
+        out.zone[i] = zoneOf(out.x[i], out.y[i]);
+    }
+
+    // Bucket points into radius-sized cells (counting sort) so each point
+    // only compares against its 3x3 cell neighbourhood
+    double radius = std::sqrt(EXPECTED_DEGREE / (PI * n));
+    int cells = static_cast<int>(1.0 / radius);
+    if (cells < 1) cells = 1;
+    int* cellStart = new int[cells * cells + 1]();
+    int* cellOf = new int[n];
+    int* order = new int[n];
+    for (int i = 0; i < n; ++i) {
+        int cx = static_cast<int>(out.x[i] * cells);
+        int cy = static_cast<int>(out.y[i] * cells);
+        if (cx >= cells) cx = cells - 1;
+        if (cy >= cells) cy = cells - 1;
+        cellOf[i] = cy * cells + cx;
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < cells * cells; ++c) cellStart[c + 1] += cellStart[c];
+    int* fill = new int[cells * cells];
+    for (int c = 0; c < cells * cells; ++c) fill[c] = cellStart[c];
+    for (int i = 0; i < n; ++i) order[fill[cellOf[i]]++] = i;
+    delete[] fill;
+
+    // Expected edge count is n * degree / 2; leave headroom for variance
+    int edgeCapacity = static_cast<int>(n * EXPECTED_DEGREE * 0.75) + 64;
+    allocateEdges(out, edgeCapacity);
+    double r2 = radius * radius;
+    for (int i = 0; i < n; ++i) {
+        int cx = cellOf[i] % cells;
+        int cy = cellOf[i] / cells;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = cx + dx;
+                int ny = cy + dy;
+                if (nx < 0 || ny < 0 || nx >= cells || ny >= cells) continue;
+                int c = ny * cells + nx;
+                for (int k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+                    int j = order[k];
+                    if (j <= i) continue;
+                    double ddx = out.x[i] - out.x[j];
+                    double ddy = out.y[i] - out.y[j];
+                    double d2 = ddx * ddx + ddy * ddy;
+                    if (d2 > r2 || out.numEdges == edgeCapacity) continue;
+                    pushEdge(out, i, j, static_cast<int>(std::sqrt(d2) * WEIGHT_SCALE));
+                }
+            }
+        }
+    }
+    delete[] cellStart;
+    delete[] cellOf;
+    delete[] order;
+}
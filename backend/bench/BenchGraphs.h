@@ -0,0 +1,55 @@
+#ifndef BENCH_GRAPHS_H
+#define BENCH_GRAPHS_H
+
+class City;
+class RideShareSystem;
+
+// splitmix64; deterministic across platforms so runs with the same seed
+// build identical graphs
+class BenchRng {
+private:
+    unsigned long long state;
+
+public:
+    explicit BenchRng(unsigned long long seed) : state(seed) {}
+
+    unsigned long long next() {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    int nextInt(int bound) { return static_cast<int>(next() % static_cast<unsigned long long>(bound)); }
+    double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+// Node ids are 0..numNodes-1; coordinates lie in the unit square and are
+// mapped to a small lat/lon box when loaded
+struct SyntheticGraph {
+    const char* kind;
+    int numNodes;
+    double* x;
+    double* y;
+    int* zone;
+
+    int numEdges;
+    int* from;
+    int* to;
+    int* weight;
+
+    SyntheticGraph();
+    ~SyntheticGraph();
+    SyntheticGraph(const SyntheticGraph&) = delete;
+    SyntheticGraph& operator=(const SyntheticGraph&) = delete;
+
+    void loadInto(City& city) const;
+    void loadInto(RideShareSystem& system) const;
+};
+
+// Square 4-connected grid of about `numNodes` nodes with jittered weights
+void buildGridGraph(SyntheticGraph& out, int numNodes, unsigned long long seed);
+// Uniform points joined to every neighbour within the radius that gives an
+// expected degree of about six
+void buildGeometricGraph(SyntheticGraph& out, int numNodes, unsigned long long seed);
+
+#endif
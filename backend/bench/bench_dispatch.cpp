@@ -0,0 +1,52 @@
+#include "Bench.h"
+#include "BenchGraphs.h"
+#include "../src/core/City.h"
+#include "../src/core/Trip.h"
+#include "../src/engine/DispatchEngine.h"
+#include "../src/engine/DriverTable.h"
+
+namespace {
+
+const int NODES_PER_DRIVER = 50;
+const int MIN_DRIVERS = 64;
+const int K_NEAREST = 8;
+
+} // namespace
+
+void benchDispatch(const SyntheticGraph& graph, const BenchConfig& config) {
+    City city(graph.numNodes);
+    graph.loadInto(city);
+    BenchRng rng(config.seed ^ 0xd15au);
+
+    int numDrivers = graph.numNodes / NODES_PER_DRIVER;
+    if (numDrivers < MIN_DRIVERS) numDrivers = MIN_DRIVERS;
+    DriverTable table(numDrivers);
+    for (int i = 0; i < numDrivers; ++i) {
+        VehicleClass vClass = static_cast<VehicleClass>(rng.nextInt(3));
+        table.addDriver(i + 1, rng.nextInt(graph.numNodes), DriverStatus::AVAILABLE, vClass);
+    }
+
+    {
+        BenchRun run("find_nearest_driver", &graph, config);
+        int tripId = 1;
+        while (run.keepRunning()) {
+            Trip trip(tripId++, 1, rng.nextInt(graph.numNodes), rng.nextInt(graph.numNodes));
+            int distance;
+            auto start = std::chrono::steady_clock::now();
+            DispatchEngine::findNearestDriver(city, trip, table, ALL_VEHICLE_CLASSES, &distance);
+            run.record(elapsedNs(start));
+        }
+        run.report();
+    }
+    {
+        BenchRun run("find_k_nearest_drivers", &graph, config);
+        DriverMatch matches[K_NEAREST];
+        while (run.keepRunning()) {
+            int pickup = rng.nextInt(graph.numNodes);
+            auto start = std::chrono::steady_clock::now();
+            DispatchEngine::findKNearestDrivers(city, pickup, table, K_NEAREST, matches);
+            run.record(elapsedNs(start));
+        }
+        run.report();
+    }
+}
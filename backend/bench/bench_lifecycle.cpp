@@ -0,0 +1,98 @@
+#include "Bench.h"
+#include "BenchGraphs.h"
+#include "../src/system/RideShareSystem.h"
+
+namespace {
+
+const int NODES_PER_DRIVER = 50;
+const int MIN_DRIVERS = 64;
+const int NUM_RIDERS = 1000;
+// Trips per round; capped by the fleet so every dispatch can succeed
+const int MAX_BATCH = 256;
+
+} // namespace
+
+// Drives the public RideShareSystem API the way the server does: each round
+// requests, dispatches and completes a batch of trips, then requests and
+// cancels another batch and undoes the cancellations. Terminal trips are
+// compacted between rounds so the trip table stays small.
+void benchLifecycle(const SyntheticGraph& graph, const BenchConfig& config) {
+    int numDrivers = graph.numNodes / NODES_PER_DRIVER;
+    if (numDrivers < MIN_DRIVERS) numDrivers = MIN_DRIVERS;
+    int batch = numDrivers < MAX_BATCH ? numDrivers : MAX_BATCH;
+
+    RideShareSystem system(graph.numNodes, numDrivers, NUM_RIDERS, 2 * batch);
+    graph.loadInto(system);
+    system.setTripRetention(0);
+    BenchRng rng(config.seed ^ 0x11feu);
+    for (int i = 0; i < numDrivers; ++i) {
+        system.addDriver(i + 1, "d" + std::to_string(i + 1), rng.nextInt(graph.numNodes), "bench");
+    }
+    for (int i = 0; i < NUM_RIDERS; ++i) {
+        system.addRider(i + 1, "r" + std::to_string(i + 1), rng.nextInt(graph.numNodes));
+    }
+
+    BenchRun request("request_trip", &graph, config);
+    BenchRun dispatch("dispatch_trip", &graph, config);
+    BenchRun complete("complete_trip", &graph, config);
+    BenchRun cancel("cancel_trip", &graph, config);
+    BenchRun undo("undo_last_action", &graph, config);
+    int* ids = new int[batch];
+
+    while (request.keepRunning()) {
+        // Pricing routes every request, so on large cities a full batch can
+        // outlast the time budget; stop the round early when it runs out
+        int n = batch;
+        for (int i = 0; i < batch; ++i) {
+            if (i > 0 && !request.keepRunning()) {
+                n = i;
+                break;
+            }
+            int rider = 1 + rng.nextInt(NUM_RIDERS);
+            int pickup = rng.nextInt(graph.numNodes);
+            int dropoff = rng.nextInt(graph.numNodes);
+            auto start = std::chrono::steady_clock::now();
+            ids[i] = system.requestTrip(rider, pickup, dropoff);
+            request.record(elapsedNs(start));
+        }
+        for (int i = 0; i < n; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            system.dispatchTrip(ids[i]);
+            dispatch.record(elapsedNs(start));
+        }
+        for (int i = 0; i < n; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            bool done = system.completeTrip(ids[i]);
+            if (done) complete.record(elapsedNs(start));
+        }
+        // Trips stranded in a disconnected component never got a driver
+        for (int i = 0; i < n; ++i) system.cancelTrip(ids[i]);
+        system.pumpEvents();
+        system.compactTrips();
+
+        for (int i = 0; i < n; ++i) {
+            ids[i] = system.requestTrip(1 + rng.nextInt(NUM_RIDERS), rng.nextInt(graph.numNodes),
+                                        rng.nextInt(graph.numNodes));
+        }
+        for (int i = 0; i < n; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            system.cancelTrip(ids[i]);
+            cancel.record(elapsedNs(start));
+        }
+        for (int i = 0; i < n; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            system.undoLastAction();
+            undo.record(elapsedNs(start));
+        }
+        for (int i = 0; i < n; ++i) system.cancelTrip(ids[i]);
+        system.pumpEvents();
+        system.compactTrips();
+    }
+
+    request.report();
+    dispatch.report();
+    complete.report();
+    cancel.report();
+    undo.report();
+    delete[] ids;
+}
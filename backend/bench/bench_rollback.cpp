@@ -0,0 +1,31 @@
+#include "Bench.h"
+#include "../src/engine/RollbackManager.h"
+
+namespace {
+
+// Record and rollback are tens of nanoseconds, so they are timed in batches
+const int BATCH = 1000;
+
+} // namespace
+
+void benchRollback(const BenchConfig& config) {
+    RollbackManager manager;
+    BenchRun record("rollback_record_action", nullptr, config);
+    BenchRun rollback("rollback_undo", nullptr, config);
+
+    int tripId, driverId;
+    TripStatus oldStatus, newStatus;
+    while (record.keepRunning()) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BATCH; ++i) {
+            manager.recordAction(i, i & 63, TripStatus::REQUESTED, TripStatus::ASSIGNED);
+        }
+        record.record(elapsedNs(start), BATCH);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BATCH; ++i) manager.rollback(tripId, driverId, oldStatus, newStatus);
+        rollback.record(elapsedNs(start), BATCH);
+    }
+    record.report();
+    rollback.report();
+}
@@ -0,0 +1,22 @@
+#include "Bench.h"
+#include "BenchGraphs.h"
+#include "../src/core/City.h"
+
+void benchRouting(const SyntheticGraph& graph, const BenchConfig& config) {
+    City city(graph.numNodes);
+    graph.loadInto(city);
+    BenchRng rng(config.seed ^ 0x5eedu);
+    int* path = new int[graph.numNodes];
+
+    BenchRun run("find_shortest_path", &graph, config);
+    while (run.keepRunning()) {
+        int from = rng.nextInt(graph.numNodes);
+        int to = rng.nextInt(graph.numNodes);
+        int pathLength;
+        auto start = std::chrono::steady_clock::now();
+        city.findShortestPath(from, to, path, pathLength);
+        run.record(elapsedNs(start));
+    }
+    run.report();
+    delete[] path;
+}
@@ -0,0 +1,92 @@
+#include "Bench.h"
+#include "BenchGraphs.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Microbenchmarks for routing, dispatch, rollback and the system lifecycle
+// on synthetic cities. Prints one JSON object per line so results can be
+// appended to a file and diffed between builds.
+//
+//   rideshare_bench [--sizes=1000,100000,1000000] [--graphs=grid,geometric]
+//                   [--suites=routing,dispatch,rollback,lifecycle]
+//                   [--time-ms=1000] [--max-iterations=1000000] [--seed=1]
+
+namespace {
+
+const int MAX_SIZES = 16;
+
+bool listContains(const std::string& list, const char* item) {
+    size_t pos = 0;
+    size_t len = std::strlen(item);
+    while (pos <= list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        if (comma - pos == len && list.compare(pos, len, item) == 0) return true;
+        pos = comma + 1;
+    }
+    return false;
+}
+
+int parseSizes(const std::string& list, int* out) {
+    int count = 0;
+    size_t pos = 0;
+    while (pos < list.size() && count < MAX_SIZES) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        int size = std::atoi(list.substr(pos, comma - pos).c_str());
+        if (size > 0) out[count++] = size;
+        pos = comma + 1;
+    }
+    return count;
+}
+
+const char* optionValue(const char* arg, const char* name) {
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) == 0 && arg[len] == '=') return arg + len + 1;
+    return nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchConfig config = {1000, 1000000, 1};
+    std::string sizeList = "1000,100000,1000000";
+    std::string graphs = "grid,geometric";
+    std::string suites = "routing,dispatch,rollback,lifecycle";
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value;
+        if ((value = optionValue(argv[i], "--sizes"))) sizeList = value;
+        else if ((value = optionValue(argv[i], "--graphs"))) graphs = value;
+        else if ((value = optionValue(argv[i], "--suites"))) suites = value;
+        else if ((value = optionValue(argv[i], "--time-ms"))) config.minTimeMs = std::atoll(value);
+        else if ((value = optionValue(argv[i], "--max-iterations"))) config.maxIterations = std::atoll(value);
+        else if ((value = optionValue(argv[i], "--seed"))) config.seed = std::strtoull(value, nullptr, 10);
+        else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    int sizes[MAX_SIZES];
+    int numSizes = parseSizes(sizeList, sizes);
+
+    if (listContains(suites, "rollback")) benchRollback(config);
+    for (int s = 0; s < numSizes; ++s) {
+        for (int kind = 0; kind < 2; ++kind) {
+            const char* name = kind == 0 ? "grid" : "geometric";
+            if (!listContains(graphs, name)) continue;
+
+            SyntheticGraph graph;
+            if (kind == 0) buildGridGraph(graph, sizes[s], config.seed);
+            else buildGeometricGraph(graph, sizes[s], config.seed);
+
+            if (listContains(suites, "routing")) benchRouting(graph, config);
+            if (listContains(suites, "dispatch")) benchDispatch(graph, config);
+            if (listContains(suites, "lifecycle")) benchLifecycle(graph, config);
+        }
+    }
+    return 0;
+}
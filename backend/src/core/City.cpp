@@ -1,8 +1,121 @@
 #include "City.h"
+#include "../metrics/Metrics.h"
+#include <climits>
 #include <iostream>
 
-City::City(int cap) : capacity(cap), numNodes(0) {
+namespace {
+
+const int EMPTY_SLOT = INT_MIN;
+
+unsigned hashId(int id) {
+    unsigned h = static_cast<unsigned>(id);
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+struct HeapItem {
+    int dist;
+    int idx;
+};
+
+// Per-thread Dijkstra scratch space. A slot is only valid when its stamp
+// equals the current generation, so nothing is cleared between searches.
+struct SearchWorkspace {
+    int capacity;
+    int* dist;
+    int* prev;
+    unsigned* seen;
+    unsigned* done;
+    unsigned generation;
+
+    HeapItem* heap;
+    int heapSize;
+    int heapCapacity;
+
+    SearchWorkspace()
+        : capacity(0), dist(nullptr), prev(nullptr), seen(nullptr), done(nullptr), generation(0),
+          heap(nullptr), heapSize(0), heapCapacity(0) {}
+
+    ~SearchWorkspace() {
+        delete[] dist;
+        delete[] prev;
+        delete[] seen;
+        delete[] done;
+        delete[] heap;
+    }
+
+    void prepare(int n) {
+        if (n > capacity) {
+            delete[] dist;
+            delete[] prev;
+            delete[] seen;
+            delete[] done;
+            capacity = n;
+            dist = new int[capacity];
+            prev = new int[capacity];
+            seen = new unsigned[capacity]();
+            done = new unsigned[capacity]();
+            generation = 0;
+        }
+        if (++generation == 0) {
+            for (int i = 0; i < capacity; ++i) seen[i] = done[i] = 0;
+            generation = 1;
+        }
+        heapSize = 0;
+    }
+
+    void push(int d, int idx) {
+        if (heapSize == heapCapacity) {
+            int newCapacity = heapCapacity > 0 ? heapCapacity * 2 : 256;
+            HeapItem* next = new HeapItem[newCapacity];
+            for (int i = 0; i < heapSize; ++i) next[i] = heap[i];
+            delete[] heap;
+            heap = next;
+            heapCapacity = newCapacity;
+        }
+        int i = heapSize++;
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (heap[parent].dist <= d) break;
+            heap[i] = heap[parent];
+            i = parent;
+        }
+        heap[i].dist = d;
+        heap[i].idx = idx;
+    }
+
+    HeapItem pop() {
+        HeapItem top = heap[0];
+        HeapItem last = heap[--heapSize];
+        int i = 0;
+        while (true) {
+            int child = 2 * i + 1;
+            if (child >= heapSize) break;
+            if (child + 1 < heapSize && heap[child + 1].dist < heap[child].dist) child++;
+            if (last.dist <= heap[child].dist) break;
+            heap[i] = heap[child];
+            i = child;
+        }
+        if (heapSize > 0) heap[i] = last;
+        return top;
+    }
+};
+
+thread_local SearchWorkspace workspace;
+
+} // namespace
+
+City::City(int cap) : numNodes(0), capacity(cap), numEdges(0), numZones(0), zoneCapacity(8) {
     nodes = new Node[capacity];
+    zoneNames = new std::string[zoneCapacity];
+
+    slotCapacity = 16;
+    while (slotCapacity < capacity * 2) slotCapacity <<= 1;
+    slotIds = new int[slotCapacity];
+    slotIdx = new int[slotCapacity];
+    for (int i = 0; i < slotCapacity; ++i) slotIds[i] = EMPTY_SLOT;
 }
 
 City::~City() {
@@ -15,14 +128,47 @@ City::~City() {
         }
     }
     delete[] nodes;
+    delete[] zoneNames;
+    delete[] slotIds;
+    delete[] slotIdx;
+}
+
+int City::findZone(const std::string& zone) const {
+    for (int i = 0; i < numZones; ++i) {
+        if (zoneNames[i] == zone) return i;
+    }
+    return -1;
+}
+
+int City::internZone(const std::string& zone) {
+    int existing = findZone(zone);
+    if (existing != -1) return existing;
+    if (numZones == zoneCapacity) {
+        std::string* next = new std::string[zoneCapacity * 2];
+        for (int i = 0; i < numZones; ++i) next[i] = zoneNames[i];
+        delete[] zoneNames;
+        zoneNames = next;
+        zoneCapacity *= 2;
+    }
+    zoneNames[numZones] = zone;
+    return numZones++;
 }
 
-void City::addNode(int id, std::string name, std::string zone) {
-    if (numNodes < capacity) {
+void City::addNode(int id, std::string name, std::string zone, double lat, double lon) {
+    if (numNodes < capacity && !hasNode(id)) {
         nodes[numNodes].id = id;
         nodes[numNodes].name = name;
         nodes[numNodes].zone = zone;
+        nodes[numNodes].zoneId = internZone(zone);
+        nodes[numNodes].lat = lat;
+        nodes[numNodes].lon = lon;
         nodes[numNodes].head = nullptr;
+
+        unsigned mask = static_cast<unsigned>(slotCapacity - 1);
+        unsigned s = hashId(id) & mask;
+        while (slotIds[s] != EMPTY_SLOT) s = (s + 1) & mask;
+        slotIds[s] = id;
+        slotIdx[s] = numNodes;
         numNodes++;
     }
 }
@@ -38,87 +184,96 @@ void City::addEdge(int from, int to, int weight) {
     if (endNode) {
         endNode->head = new Edge(from, weight, endNode->head);
     }
+    if (startNode || endNode) numEdges++;
 }
 
 Node* City::getNode(int id) {
-    for (int i = 0; i < numNodes; ++i) {
-        if (nodes[i].id == id) return &nodes[i];
+    int idx = getNodeIndex(id);
+    return idx != -1 ? &nodes[idx] : nullptr;
+}
+
+int City::getNodeIndex(int id) const {
+    unsigned mask = static_cast<unsigned>(slotCapacity - 1);
+    unsigned s = hashId(id) & mask;
+    while (slotIds[s] != EMPTY_SLOT) {
+        if (slotIds[s] == id) return slotIdx[s];
+        s = (s + 1) & mask;
     }
-    return nullptr;
+    return -1;
 }
 
-int City::findShortestPath(int startId, int endId, int* path, int& pathLength) {
-    const int INF = 1e9;
-    int* dist = new int[numNodes];
-    int* prev = new int[numNodes];
-    bool* visited = new bool[numNodes];
+int City::getZoneId(int nodeId) const {
+    int idx = getNodeIndex(nodeId);
+    return idx != -1 ? nodes[idx].zoneId : -1;
+}
 
-    for (int i = 0; i < numNodes; ++i) {
-        dist[i] = INF;
-        prev[i] = -1;
-        visited[i] = false;
-    }
+int City::runSearch(int startIdx, int targetIdx, int maxDist, SettleVisitor visit, void* ctx) const {
+    SearchWorkspace& ws = workspace;
+    ws.prepare(numNodes);
+    const unsigned gen = ws.generation;
 
-    int startIdx = -1, endIdx = -1;
-    for (int i = 0; i < numNodes; ++i) {
-        if (nodes[i].id == startId) startIdx = i;
-        if (nodes[i].id == endId) endIdx = i;
-    }
+    ws.dist[startIdx] = 0;
+    ws.prev[startIdx] = -1;
+    ws.seen[startIdx] = gen;
+    ws.push(0, startIdx);
 
-    if (startIdx == -1 || endIdx == -1) return -1;
+    int settled = 0;
+    while (ws.heapSize > 0) {
+        HeapItem top = ws.pop();
+        int u = top.idx;
+        if (ws.done[u] == gen || top.dist != ws.dist[u]) continue;
+        if (maxDist >= 0 && top.dist > maxDist) break;
 
-    dist[startIdx] = 0;
+        ws.done[u] = gen;
+        settled++;
+        if (u == targetIdx) break;
+        if (visit && visit(u, top.dist, ctx)) break;
 
-    for (int i = 0; i < numNodes; ++i) {
-        int u = -1;
-        for (int j = 0; j < numNodes; ++j) {
-            if (!visited[j] && (u == -1 || dist[j] < dist[u])) {
-                u = j;
+        for (Edge* e = nodes[u].head; e; e = e->next) {
+            int v = getNodeIndex(e->to);
+            if (v == -1 || ws.done[v] == gen) continue;
+            int nd = top.dist + e->weight;
+            if (ws.seen[v] != gen || nd < ws.dist[v]) {
+                ws.seen[v] = gen;
+                ws.dist[v] = nd;
+                ws.prev[v] = u;
+                ws.push(nd, v);
             }
         }
+    }
+    Metrics::record(METRIC_NODES_SETTLED, settled);
+    return settled;
+}
 
-        if (dist[u] == INF) break;
-        visited[u] = true;
+int City::searchFrom(int startId, int maxDist, SettleVisitor visit, void* ctx) const {
+    int startIdx = getNodeIndex(startId);
+    if (startIdx == -1) return 0;
+    return runSearch(startIdx, -1, maxDist, visit, ctx);
+}
 
-        Edge* curr = nodes[u].head;
-        while (curr) {
-            int vIdx = -1;
-            for (int k = 0; k < numNodes; ++k) {
-                if (nodes[k].id == curr->to) {
-                    vIdx = k;
-                    break;
-                }
-            }
+int City::findShortestPath(int startId, int endId, int* path, int& pathLength) {
+    ScopedTimer timer(METRIC_FIND_SHORTEST_PATH);
+    pathLength = 0;
+    int startIdx = getNodeIndex(startId);
+    int endIdx = getNodeIndex(endId);
+    if (startIdx == -1 || endIdx == -1) return -1;
 
-            if (vIdx != -1 && dist[u] + curr->weight < dist[vIdx]) {
-                dist[vIdx] = dist[u] + curr->weight;
-                prev[vIdx] = u;
-            }
-            curr = curr->next;
-        }
-    }
+    runSearch(startIdx, endIdx, -1, nullptr, nullptr);
+    SearchWorkspace& ws = workspace;
+    if (ws.done[endIdx] != ws.generation) return -1;
 
-    int totalDist = dist[endIdx];
-    
     // Reconstruct path
-    pathLength = 0;
-    if (totalDist != INF) {
-        int curr = endIdx;
-        while (curr != -1) {
-            path[pathLength++] = nodes[curr].id;
-            curr = prev[curr];
-        }
-        // Reverse path
-        for (int i = 0; i < pathLength / 2; ++i) {
-            int temp = path[i];
-            path[i] = path[pathLength - 1 - i];
-            path[pathLength - 1 - i] = temp;
-        }
+    int curr = endIdx;
+    while (curr != -1) {
+        path[pathLength++] = nodes[curr].id;
+        curr = ws.prev[curr];
+    }
+    // Reverse path
+    for (int i = 0; i < pathLength / 2; ++i) {
+        int temp = path[i];
+        path[i] = path[pathLength - 1 - i];
+        path[pathLength - 1 - i] = temp;
     }
 
-    delete[] dist;
-    delete[] prev;
-    delete[] visited;
-
-    return totalDist == INF ? -1 : totalDist;
+    return ws.dist[endIdx];
 }
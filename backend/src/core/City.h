@@ -7,9 +7,12 @@ struct Node {
     int id;
     std::string name;
     std::string zone;
+    int zoneId;
+    double lat;
+    double lon;
     struct Edge* head;
 
-    Node() : id(-1), head(nullptr) {}
+    Node() : id(-1), zoneId(-1), lat(0.0), lon(0.0), head(nullptr) {}
 };
 
 struct Edge {
@@ -20,24 +23,58 @@ struct Edge {
     Edge(int t, int w, Edge* n) : to(t), weight(w), next(n) {}
 };
 
+// Receives each node settled by City::searchFrom, in nondecreasing distance
+// order. Return true to stop the search.
+typedef bool (*SettleVisitor)(int nodeIdx, int dist, void* ctx);
+
 class City {
 private:
     Node* nodes;
     int numNodes;
     int capacity;
+    int numEdges;
+
+    // Open-addressing index from node id to position in `nodes`
+    int* slotIds;
+    int* slotIdx;
+    int slotCapacity;
+
+    // Zone names interned to dense ids in order of first appearance
+    std::string* zoneNames;
+    int numZones;
+    int zoneCapacity;
+
+    int internZone(const std::string& zone);
+
+    // Heap-based Dijkstra over node indices using per-thread scratch space.
+    // Stops at targetIdx (if >= 0), when visit returns true, or once the
+    // frontier passes maxDist (if >= 0). Returns the number of nodes settled.
+    int runSearch(int startIdx, int targetIdx, int maxDist, SettleVisitor visit, void* ctx) const;
 
 public:
     City(int cap = 100);
     ~City();
 
-    void addNode(int id, std::string name, std::string zone);
+    void addNode(int id, std::string name, std::string zone, double lat = 0.0, double lon = 0.0);
     void addEdge(int from, int to, int weight);
     
     int getNumNodes() const { return numNodes; }
+    int getNumEdges() const { return numEdges; }
+    const Node& getNodeAt(int idx) const { return nodes[idx]; }
     Node* getNode(int id);
+    int getNodeIndex(int id) const;
+    bool hasNode(int id) const { return getNodeIndex(id) != -1; }
+
+    int getNumZones() const { return numZones; }
+    const std::string& getZoneName(int zoneId) const { return zoneNames[zoneId]; }
+    int getZoneId(int nodeId) const;
+    int findZone(const std::string& zone) const;
     
     // Shortest path using Dijkstra (Custom implementation)
     int findShortestPath(int startId, int endId, int* path, int& pathLength);
+
+    // Single-source search that reports settled nodes as it goes; see runSearch
+    int searchFrom(int startId, int maxDist, SettleVisitor visit, void* ctx) const;
 };
 
 #endif
@@ -1,4 +1,41 @@
 #include "Driver.h"
 
-Driver::Driver(int id, std::string name, int locId, std::string vehicle)
-    : id(id), name(name), currentLocationId(locId), status(DriverStatus::AVAILABLE), vehicle(vehicle) {}
+Driver::Driver(int id, std::string name, int locId, std::string vehicle, VehicleClass vClass)
+    : id(id), name(name), currentLocationId(locId), status(DriverStatus::AVAILABLE), vehicle(vehicle), vehicleClass(vClass),
+      seatCapacity(vClass == VehicleClass::XL ? 6 : 4), numStops(0) {}
+
+bool Driver::setRoute(const RouteStop* stops, int count) {
+    if (count > MAX_ROUTE_STOPS) return false;
+    for (int i = 0; i < count; ++i) route[i] = stops[i];
+    numStops = count;
+    return true;
+}
+
+int Driver::removeTripStops(int tripId) {
+    int kept = 0;
+    for (int i = 0; i < numStops; ++i) {
+        if (route[i].tripId != tripId) route[kept++] = route[i];
+    }
+    int removed = numStops - kept;
+    numStops = kept;
+    return removed;
+}
+
+void Driver::boardTrip(int tripId) {
+    int kept = 0;
+    for (int i = 0; i < numStops; ++i) {
+        if (route[i].tripId == tripId && route[i].pickup) continue;
+        if (route[i].tripId == tripId) route[i].ridden = 0;
+        route[kept++] = route[i];
+    }
+    numStops = kept;
+}
+
+void Driver::addRidden(int distance) {
+    for (int i = 0; i < numStops; ++i) {
+        if (route[i].pickup) continue;
+        bool waiting = false;
+        for (int j = 0; j < i; ++j) waiting = waiting || (route[j].pickup && route[j].tripId == route[i].tripId);
+        if (!waiting) route[i].ridden += distance;
+    }
+}
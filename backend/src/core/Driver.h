@@ -9,25 +9,66 @@ enum class DriverStatus {
     OFFLINE
 };
 
+const int NUM_DRIVER_STATUSES = 3;
+
+enum class VehicleClass {
+    ECONOMY,
+    COMFORT,
+    XL
+};
+
+// One pickup or dropoff on a pooled driver's route
+struct RouteStop {
+    int tripId;
+    int nodeId;
+    bool pickup;
+    int maxRide;  // dropoff only: longest allowed in-vehicle distance (-1 = no limit)
+    int ridden;   // dropoff only: in-vehicle distance already covered once the
+                  // pickup has left the route (rider aboard), else 0
+};
+
 class Driver {
+public:
+    static const int MAX_ROUTE_STOPS = 8;
+
 private:
     int id;
     std::string name;
     int currentLocationId;
     DriverStatus status;
     std::string vehicle;
+    VehicleClass vehicleClass;
+    int seatCapacity;
+
+    // Remaining stops of pooled trips in visiting order; empty for solo trips
+    RouteStop route[MAX_ROUTE_STOPS];
+    int numStops;
 
 public:
-    Driver(int id = -1, std::string name = "", int locId = -1, std::string vehicle = "");
+    Driver(int id = -1, std::string name = "", int locId = -1, std::string vehicle = "", VehicleClass vClass = VehicleClass::ECONOMY);
     
     int getId() const { return id; }
     std::string getName() const { return name; }
     int getCurrentLocationId() const { return currentLocationId; }
     DriverStatus getStatus() const { return status; }
     std::string getVehicle() const { return vehicle; }
+    VehicleClass getVehicleClass() const { return vehicleClass; }
+    int getSeatCapacity() const { return seatCapacity; }
+    const RouteStop* getRoute() const { return route; }
+    int getNumStops() const { return numStops; }
     
     void setLocation(int locId) { currentLocationId = locId; }
     void setStatus(DriverStatus s) { status = s; }
+    void setSeatCapacity(int seats) { seatCapacity = seats; }
+
+    // Replaces the route; returns false if it has more than MAX_ROUTE_STOPS stops
+    bool setRoute(const RouteStop* stops, int count);
+    // Drops both stops of a trip; returns the number removed
+    int removeTripStops(int tripId);
+    // Drops a trip's pickup stop once its rider is aboard; no-op for solo trips
+    void boardTrip(int tripId);
+    // Adds distance driven to every dropoff whose rider is aboard
+    void addRidden(int distance);
 };
 
 #endif
@@ -2,4 +2,6 @@
 
 Trip::Trip(int id, int riderId, int pickupId, int dropoffId)
     : id(id), riderId(riderId), driverId(-1), pickupLocationId(pickupId), 
-      dropoffLocationId(dropoffId), status(TripStatus::REQUESTED), distance(0.0) {}
+      dropoffLocationId(dropoffId), status(TripStatus::REQUESTED), priority(0), distance(0.0),
+      pickupZoneId(-1), pickupDistance(-1), requestedAt(0), finishedAt(0), fare(0.0),
+      pooled(false), maxRide(-1) {}
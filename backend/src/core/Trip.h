@@ -11,6 +11,8 @@ enum class TripStatus {
     CANCELLED
 };
 
+const int NUM_TRIP_STATUSES = 5;
+
 class Trip {
 private:
     int id;
@@ -19,7 +21,15 @@ private:
     int pickupLocationId;
     int dropoffLocationId;
     TripStatus status;
+    int priority;
     double distance;
+    int pickupZoneId;
+    int pickupDistance;
+    long long requestedAt;
+    long long finishedAt;
+    double fare;
+    bool pooled;
+    int maxRide;  // pooled only: longest allowed in-vehicle distance
 
 public:
     Trip(int id = -1, int riderId = -1, int pickupId = -1, int dropoffId = -1);
@@ -30,11 +40,27 @@ public:
     int getPickupLocationId() const { return pickupLocationId; }
     int getDropoffLocationId() const { return dropoffLocationId; }
     TripStatus getStatus() const { return status; }
+    int getPriority() const { return priority; }
     double getDistance() const { return distance; }
+    int getPickupZoneId() const { return pickupZoneId; }
+    int getPickupDistance() const { return pickupDistance; }
+    long long getRequestedAt() const { return requestedAt; }
+    long long getFinishedAt() const { return finishedAt; }
+    double getFare() const { return fare; }
+    bool isPooled() const { return pooled; }
+    int getMaxRide() const { return maxRide; }
+    bool isTerminal() const { return status == TripStatus::COMPLETED || status == TripStatus::CANCELLED; }
     
     void setDriverId(int dId) { driverId = dId; }
     void setStatus(TripStatus s) { status = s; }
+    void setPriority(int p) { priority = p; }
     void setDistance(double d) { distance = d; }
+    void setPickupZoneId(int z) { pickupZoneId = z; }
+    void setPickupDistance(int d) { pickupDistance = d; }
+    void setRequestedAt(long long t) { requestedAt = t; }
+    void setFinishedAt(long long t) { finishedAt = t; }
+    void setFare(double f) { fare = f; }
+    void setPooled(int ride) { pooled = true; maxRide = ride; }
 };
 
 #endif
@@ -1,6 +1,69 @@
 #include "DispatchEngine.h"
+#include "../metrics/Metrics.h"
+
+namespace {
+
+// Candidate drivers bucketed by node index: bucketHead[node] starts a chain
+// through nextCandidate. Buckets are stamped so they need no clearing.
+struct CandidateIndex {
+    int capacity;
+    int* bucketHead;
+    unsigned* bucketStamp;
+    unsigned generation;
+
+    CandidateIndex() : capacity(0), bucketHead(nullptr), bucketStamp(nullptr), generation(0) {}
+    ~CandidateIndex() {
+        delete[] bucketHead;
+        delete[] bucketStamp;
+    }
+
+    void prepare(int numNodes) {
+        if (numNodes > capacity) {
+            delete[] bucketHead;
+            delete[] bucketStamp;
+            capacity = numNodes;
+            bucketHead = new int[capacity];
+            bucketStamp = new unsigned[capacity]();
+            generation = 0;
+        }
+        if (++generation == 0) {
+            for (int i = 0; i < capacity; ++i) bucketStamp[i] = 0;
+            generation = 1;
+        }
+    }
+
+    int head(int node) const { return bucketStamp[node] == generation ? bucketHead[node] : -1; }
+    void setHead(int node, int candidate) {
+        bucketStamp[node] = generation;
+        bucketHead[node] = candidate;
+    }
+};
+
+thread_local CandidateIndex candidateIndex;
+
+struct KnnSearch {
+    const DriverTable* table;
+    const int* rows;
+    const int* nextCandidate;
+    DriverMatch* out;
+    int k;
+    int found;
+};
+
+bool collectDrivers(int nodeIdx, int dist, void* ctx) {
+    KnnSearch& search = *static_cast<KnnSearch*>(ctx);
+    for (int c = candidateIndex.head(nodeIdx); c != -1; c = search.nextCandidate[c]) {
+        search.out[search.found].driverId = search.table->getId(search.rows[c]);
+        search.out[search.found].distance = dist;
+        if (++search.found == search.k) return true;
+    }
+    return false;
+}
+
+} // namespace
 
 int DispatchEngine::findNearestDriver(City& city, Trip& trip, Driver** drivers, int numDrivers) {
+    ScopedTimer timer(METRIC_FIND_NEAREST_DRIVER);
     int nearestDriverId = -1;
     int minDistance = 1e9;
     
@@ -20,3 +83,42 @@ int DispatchEngine::findNearestDriver(City& city, Trip& trip, Driver** drivers,
     delete[] path;
     return nearestDriverId;
 }
+
+int DispatchEngine::findNearestDriver(City& city, Trip& trip, const DriverTable& table,
+                                      unsigned classMask, int* outDistance, int maxDistance) {
+    ScopedTimer timer(METRIC_FIND_NEAREST_DRIVER);
+    DriverMatch match;
+    int found = findKNearestDrivers(city, trip.getPickupLocationId(), table, 1, &match, maxDistance, classMask);
+    if (outDistance) *outDistance = found ? match.distance : -1;
+    return found ? match.driverId : -1;
+}
+
+int DispatchEngine::findKNearestDrivers(const City& city, int pickupId, const DriverTable& table, int k, DriverMatch* out,
+                                        int maxDistance, unsigned classMask) {
+    if (k <= 0 || table.size() == 0 || !city.hasNode(pickupId)) return 0;
+
+    int* rows = new int[table.size()];
+    int numCandidates = table.filterCandidates(DriverStatus::AVAILABLE, classMask, rows);
+    if (numCandidates == 0) {
+        delete[] rows;
+        return 0;
+    }
+
+    int* nextCandidate = new int[numCandidates];
+    candidateIndex.prepare(city.getNumNodes());
+    int reachable = 0;
+    for (int c = 0; c < numCandidates; ++c) {
+        int node = city.getNodeIndex(table.getLocation(rows[c]));
+        if (node == -1) continue;
+        nextCandidate[c] = candidateIndex.head(node);
+        candidateIndex.setHead(node, c);
+        reachable++;
+    }
+
+    KnnSearch search = {&table, rows, nextCandidate, out, k < reachable ? k : reachable, 0};
+    if (search.k > 0) city.searchFrom(pickupId, maxDistance, collectDrivers, &search);
+
+    delete[] nextCandidate;
+    delete[] rows;
+    return search.found;
+}
@@ -4,10 +4,27 @@
 #include "../core/City.h"
 #include "../core/Driver.h"
 #include "../core/Trip.h"
+#include "DriverTable.h"
+
+struct DriverMatch {
+    int driverId;
+    int distance;
+};
 
 class DispatchEngine {
 public:
     static int findNearestDriver(City& city, Trip& trip, Driver** drivers, int numDrivers);
+    // One search outward from the pickup over AVAILABLE drivers from the SoA
+    // table; gives up once the frontier passes maxDistance (< 0 = unbounded)
+    static int findNearestDriver(City& city, Trip& trip, const DriverTable& table,
+                                 unsigned classMask = ALL_VEHICLE_CLASSES, int* outDistance = nullptr,
+                                 int maxDistance = -1);
+
+    // Up to k AVAILABLE drivers closest to pickupId, found with a single
+    // search outward from the pickup. `out` is filled in increasing distance
+    // (ETA) order; maxDistance < 0 means unbounded. Returns the match count.
+    static int findKNearestDrivers(const City& city, int pickupId, const DriverTable& table, int k, DriverMatch* out,
+                                   int maxDistance = -1, unsigned classMask = ALL_VEHICLE_CLASSES);
 };
 
 #endif
@@ -0,0 +1,172 @@
+#include "DistanceCache.h"
+
+namespace {
+
+const int NO_NODE = -1;
+
+// Per-thread marks for the targets of one prefetch, indexed by node index
+// and stamped so they need no clearing between calls
+struct TargetMarks {
+    int capacity;
+    unsigned* stamp;
+    unsigned generation;
+
+    TargetMarks() : capacity(0), stamp(nullptr), generation(0) {}
+    ~TargetMarks() { delete[] stamp; }
+
+    void prepare(int numNodes) {
+        if (numNodes > capacity) {
+            delete[] stamp;
+            capacity = numNodes;
+            stamp = new unsigned[capacity]();
+            generation = 0;
+        }
+        if (++generation == 0) {
+            for (int i = 0; i < capacity; ++i) stamp[i] = 0;
+            generation = 1;
+        }
+    }
+
+    bool marked(int node) const { return stamp[node] == generation; }
+    void mark(int node) { stamp[node] = generation; }
+    void unmark(int node) { stamp[node] = 0; }
+};
+
+thread_local TargetMarks targetMarks;
+
+struct PrefetchSearch {
+    const City* city;
+    DistanceCache* cache;
+    int fromId;
+    int remaining;
+};
+
+bool cacheTarget(int nodeIdx, int dist, void* ctx) {
+    if (!targetMarks.marked(nodeIdx)) return false;
+    PrefetchSearch& search = *static_cast<PrefetchSearch*>(ctx);
+    targetMarks.unmark(nodeIdx);
+    search.cache->store(search.fromId, search.city->getNodeAt(nodeIdx).id, dist);
+    return --search.remaining == 0;
+}
+
+} // namespace
+
+DistanceCache::DistanceCache(int slotCount) : currentEpoch(0), hits(0), misses(0) {
+    unsigned size = 16;
+    while (size < static_cast<unsigned>(slotCount)) size <<= 1;
+    mask = size - 1;
+    slots = new Slot[size];
+    for (unsigned i = 0; i < size; ++i) {
+        slots[i].seq.store(0, std::memory_order_relaxed);
+        slots[i].epoch.store(0, std::memory_order_relaxed);
+        slots[i].a.store(NO_NODE, std::memory_order_relaxed);
+        slots[i].b.store(NO_NODE, std::memory_order_relaxed);
+        slots[i].dist.store(UNREACHABLE, std::memory_order_relaxed);
+    }
+}
+
+DistanceCache::~DistanceCache() {
+    delete[] slots;
+}
+
+unsigned DistanceCache::slotFor(int a, int b) const {
+    unsigned long long key = (static_cast<unsigned long long>(static_cast<unsigned>(a)) << 32) |
+                             static_cast<unsigned>(b);
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return static_cast<unsigned>(key) & mask;
+}
+
+bool DistanceCache::peek(int fromId, int toId, int& dist) const {
+    if (fromId == toId) {
+        dist = 0;
+        return true;
+    }
+    int a = fromId < toId ? fromId : toId;
+    int b = fromId < toId ? toId : fromId;
+    const Slot& slot = slots[slotFor(a, b)];
+
+    unsigned before = slot.seq.load(std::memory_order_acquire);
+    if (before & 1) return false;
+    int slotA = slot.a.load(std::memory_order_relaxed);
+    int slotB = slot.b.load(std::memory_order_relaxed);
+    int slotDist = slot.dist.load(std::memory_order_relaxed);
+    unsigned slotEpoch = slot.epoch.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    unsigned after = slot.seq.load(std::memory_order_relaxed);
+
+    if (before != after || slotA != a || slotB != b) return false;
+    if (slotEpoch != currentEpoch.load(std::memory_order_acquire)) return false;
+    dist = slotDist;
+    return true;
+}
+
+bool DistanceCache::lookup(int fromId, int toId, int& dist) const {
+    bool found = peek(fromId, toId, dist);
+    (found ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+    return found;
+}
+
+void DistanceCache::store(int fromId, int toId, int dist) {
+    if (fromId == toId) return;
+    int a = fromId < toId ? fromId : toId;
+    int b = fromId < toId ? toId : fromId;
+    Slot& slot = slots[slotFor(a, b)];
+
+    unsigned seq = slot.seq.load(std::memory_order_relaxed);
+    if ((seq & 1) || !slot.seq.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) return;
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.a.store(a, std::memory_order_relaxed);
+    slot.b.store(b, std::memory_order_relaxed);
+    slot.dist.store(dist, std::memory_order_relaxed);
+    slot.epoch.store(currentEpoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    slot.seq.store(seq + 2, std::memory_order_release);
+}
+
+int DistanceCache::get(const City& city, int fromId, int toId) {
+    int dist;
+    if (lookup(fromId, toId, dist)) return dist;
+
+    struct Target {
+        int idx;
+        int dist;
+    } target = {city.getNodeIndex(toId), UNREACHABLE};
+    if (target.idx == -1) return UNREACHABLE;
+    city.searchFrom(fromId, -1, [](int nodeIdx, int d, void* ctx) {
+        Target& t = *static_cast<Target*>(ctx);
+        if (nodeIdx != t.idx) return false;
+        t.dist = d;
+        return true;
+    }, &target);
+    store(fromId, toId, target.dist);
+    return target.dist;
+}
+
+void DistanceCache::prefetch(const City& city, int fromId, const int* targetIds, int count) {
+    if (!city.hasNode(fromId)) return;
+
+    targetMarks.prepare(city.getNumNodes());
+    PrefetchSearch search = {&city, this, fromId, 0};
+    for (int i = 0; i < count; ++i) {
+        int dist;
+        int idx = city.getNodeIndex(targetIds[i]);
+        if (idx == -1 || targetMarks.marked(idx) || peek(fromId, targetIds[i], dist)) continue;
+        targetMarks.mark(idx);
+        search.remaining++;
+    }
+    if (search.remaining == 0) return;
+
+    city.searchFrom(fromId, -1, cacheTarget, &search);
+
+    // Whatever the search never reached is unreachable
+    if (search.remaining > 0) {
+        for (int i = 0; i < count; ++i) {
+            int idx = city.getNodeIndex(targetIds[i]);
+            if (idx != -1 && targetMarks.marked(idx)) {
+                targetMarks.unmark(idx);
+                store(fromId, targetIds[i], UNREACHABLE);
+            }
+        }
+    }
+}
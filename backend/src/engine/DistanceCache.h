@@ -0,0 +1,62 @@
+#ifndef DISTANCE_CACHE_H
+#define DISTANCE_CACHE_H
+
+#include "../core/City.h"
+#include <atomic>
+
+// Fixed-size, direct-mapped cache of node-to-node travel costs. Edges are
+// undirected, so (a, b) and (b, a) share an entry. Each slot is guarded by a
+// sequence counter: readers never block (a torn read is just a miss that
+// falls back to a search), and a writer that loses a race for a slot simply
+// skips caching.
+//
+// Entries are only valid for the graph they were computed on; call
+// invalidate() after changing the city. It is O(1): entries carry the epoch
+// they were written in and older epochs read as misses.
+class DistanceCache {
+private:
+    struct Slot {
+        std::atomic<unsigned> seq;  // odd while a write is in progress
+        std::atomic<unsigned> epoch;
+        std::atomic<int> a;
+        std::atomic<int> b;
+        std::atomic<int> dist;
+    };
+
+    Slot* slots;
+    unsigned mask;
+    std::atomic<unsigned> currentEpoch;
+
+    mutable std::atomic<long long> hits;
+    mutable std::atomic<long long> misses;
+
+    unsigned slotFor(int a, int b) const;
+    // lookup() without touching the hit/miss counters
+    bool peek(int fromId, int toId, int& dist) const;
+
+public:
+    static const int UNREACHABLE = -1;
+
+    // slotCount is rounded up to a power of two
+    DistanceCache(int slotCount = 1 << 16);
+    ~DistanceCache();
+    DistanceCache(const DistanceCache&) = delete;
+    DistanceCache& operator=(const DistanceCache&) = delete;
+
+    bool lookup(int fromId, int toId, int& dist) const;
+    void store(int fromId, int toId, int dist);
+
+    // Cached distance, running a search on a miss (UNREACHABLE if none)
+    int get(const City& city, int fromId, int toId);
+    // Caches the distance from fromId to every target with a single search
+    // that stops once the last uncached target is settled
+    void prefetch(const City& city, int fromId, const int* targetIds, int count);
+
+    // Must not race with searches that will store results
+    void invalidate() { currentEpoch.fetch_add(1, std::memory_order_acq_rel); }
+
+    long long getHits() const { return hits.load(std::memory_order_relaxed); }
+    long long getMisses() const { return misses.load(std::memory_order_relaxed); }
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "DriverTable.h"
+#include <cstring>
+#include <climits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DRIVER_TABLE_X86 1
+#endif
+
+namespace {
+
+const int EMPTY_SLOT = INT_MIN;
+const int NUM_VEHICLE_CLASSES = 3;
+
+unsigned hashId(int id) {
+    unsigned h = static_cast<unsigned>(id);
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+template <typename T>
+void growArray(T*& arr, int oldSize, int newSize) {
+    T* next = new T[newSize];
+    if (oldSize > 0) std::memcpy(next, arr, sizeof(T) * oldSize);
+    delete[] arr;
+    arr = next;
+}
+
+int filterScalar(const unsigned char* statuses, const unsigned char* classes, int begin, int end,
+                 unsigned char status, unsigned classMask, int* outRows) {
+    int count = 0;
+    for (int i = begin; i < end; ++i) {
+        if (statuses[i] == status && (classMask & (1u << classes[i]))) {
+            outRows[count++] = i;
+        }
+    }
+    return count;
+}
+
+#ifdef DRIVER_TABLE_X86
+int filterSse2(const unsigned char* statuses, const unsigned char* classes, int n,
+               unsigned char status, unsigned classMask, bool anyClass, int* outRows) {
+    const __m128i wantStatus = _mm_set1_epi8(static_cast<char>(status));
+    __m128i classKeys[NUM_VEHICLE_CLASSES];
+    for (int c = 0; c < NUM_VEHICLE_CLASSES; ++c) classKeys[c] = _mm_set1_epi8(static_cast<char>(c));
+
+    int count = 0;
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i match = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(statuses + i)), wantStatus);
+        if (!anyClass) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(classes + i));
+            __m128i classMatch = _mm_setzero_si128();
+            for (int c = 0; c < NUM_VEHICLE_CLASSES; ++c) {
+                if (classMask & (1u << c)) classMatch = _mm_or_si128(classMatch, _mm_cmpeq_epi8(v, classKeys[c]));
+            }
+            match = _mm_and_si128(match, classMatch);
+        }
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(match));
+        while (bits) {
+            outRows[count++] = i + __builtin_ctz(bits);
+            bits &= bits - 1;
+        }
+    }
+    return count + filterScalar(statuses, classes, i, n, status, classMask, outRows + count);
+}
+
+__attribute__((target("avx2")))
+int filterAvx2(const unsigned char* statuses, const unsigned char* classes, int n,
+               unsigned char status, unsigned classMask, bool anyClass, int* outRows) {
+    const __m256i wantStatus = _mm256_set1_epi8(static_cast<char>(status));
+    __m256i classKeys[NUM_VEHICLE_CLASSES];
+    for (int c = 0; c < NUM_VEHICLE_CLASSES; ++c) classKeys[c] = _mm256_set1_epi8(static_cast<char>(c));
+
+    int count = 0;
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i match = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(statuses + i)), wantStatus);
+        if (!anyClass) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(classes + i));
+            __m256i classMatch = _mm256_setzero_si256();
+            for (int c = 0; c < NUM_VEHICLE_CLASSES; ++c) {
+                if (classMask & (1u << c)) classMatch = _mm256_or_si256(classMatch, _mm256_cmpeq_epi8(v, classKeys[c]));
+            }
+            match = _mm256_and_si256(match, classMatch);
+        }
+        unsigned bits = static_cast<unsigned>(_mm256_movemask_epi8(match));
+        while (bits) {
+            outRows[count++] = i + __builtin_ctz(bits);
+            bits &= bits - 1;
+        }
+    }
+    return count + filterScalar(statuses, classes, i, n, status, classMask, outRows + count);
+}
+
+bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+} // namespace
+
+DriverTable::DriverTable(int cap)
+    : numRows(0), capacity(cap > 0 ? cap : 1), slotCapacity(0) {
+    ids = new int[capacity];
+    locations = new int[capacity];
+    statuses = new unsigned char[capacity];
+    vehicleClasses = new unsigned char[capacity];
+    lastPingAt = new long long[capacity];
+    slotIds = nullptr;
+    slotRows = nullptr;
+    rehash(64);
+}
+
+DriverTable::~DriverTable() {
+    delete[] ids;
+    delete[] locations;
+    delete[] statuses;
+    delete[] vehicleClasses;
+    delete[] lastPingAt;
+    delete[] slotIds;
+    delete[] slotRows;
+}
+
+void DriverTable::grow() {
+    int newCapacity = capacity * 2;
+    growArray(ids, numRows, newCapacity);
+    growArray(locations, numRows, newCapacity);
+    growArray(statuses, numRows, newCapacity);
+    growArray(vehicleClasses, numRows, newCapacity);
+    growArray(lastPingAt, numRows, newCapacity);
+    capacity = newCapacity;
+}
+
+void DriverTable::rehash(int newSlotCapacity) {
+    delete[] slotIds;
+    delete[] slotRows;
+    slotCapacity = newSlotCapacity;
+    slotIds = new int[slotCapacity];
+    slotRows = new int[slotCapacity];
+    for (int i = 0; i < slotCapacity; ++i) slotIds[i] = EMPTY_SLOT;
+    for (int row = 0; row < numRows; ++row) insertSlot(ids[row], row);
+}
+
+void DriverTable::insertSlot(int id, int row) {
+    unsigned mask = static_cast<unsigned>(slotCapacity - 1);
+    unsigned s = hashId(id) & mask;
+    while (slotIds[s] != EMPTY_SLOT && slotIds[s] != id) s = (s + 1) & mask;
+    slotIds[s] = id;
+    slotRows[s] = row;
+}
+
+int DriverTable::addDriver(int id, int locId, DriverStatus status, VehicleClass vClass) {
+    if (numRows == capacity) grow();
+    if ((numRows + 1) * 2 > slotCapacity) rehash(slotCapacity * 2);
+
+    int row = numRows++;
+    ids[row] = id;
+    locations[row] = locId;
+    statuses[row] = static_cast<unsigned char>(status);
+    vehicleClasses[row] = static_cast<unsigned char>(vClass);
+    lastPingAt[row] = LLONG_MIN;  // no ping yet; any timestamp is newer
+    insertSlot(id, row);
+    return row;
+}
+
+int DriverTable::findRow(int id) const {
+    unsigned mask = static_cast<unsigned>(slotCapacity - 1);
+    unsigned s = hashId(id) & mask;
+    while (slotIds[s] != EMPTY_SLOT) {
+        if (slotIds[s] == id) return slotRows[s];
+        s = (s + 1) & mask;
+    }
+    return -1;
+}
+
+int DriverTable::filterCandidates(DriverStatus status, unsigned classMask, int* outRows, FilterPath path) const {
+    unsigned char wanted = static_cast<unsigned char>(status);
+    unsigned allClasses = (1u << NUM_VEHICLE_CLASSES) - 1;
+    bool anyClass = (classMask & allClasses) == allClasses;
+
+#ifdef DRIVER_TABLE_X86
+    if ((path == FilterPath::AUTO || path == FilterPath::AVX2) && cpuHasAvx2()) {
+        return filterAvx2(statuses, vehicleClasses, numRows, wanted, classMask, anyClass, outRows);
+    }
+    if (path != FilterPath::SCALAR) {
+        return filterSse2(statuses, vehicleClasses, numRows, wanted, classMask, anyClass, outRows);
+    }
+#else
+    (void)path;
+    (void)anyClass;
+#endif
+    return filterScalar(statuses, vehicleClasses, 0, numRows, wanted, classMask, outRows);
+}
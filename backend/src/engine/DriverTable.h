@@ -0,0 +1,62 @@
+#ifndef DRIVER_TABLE_H
+#define DRIVER_TABLE_H
+
+#include "../core/Driver.h"
+
+// Bit mask over VehicleClass values, used to restrict candidate filtering.
+const unsigned ALL_VEHICLE_CLASSES = 0xFFu;
+
+inline unsigned vehicleClassBit(VehicleClass c) { return 1u << static_cast<unsigned>(c); }
+
+// Structure-of-arrays copy of the hot driver fields used by dispatch.
+// Row i mirrors the i-th driver added to the system; rows are never removed.
+class DriverTable {
+public:
+    // Implementation of filterCandidates; AUTO takes the widest one the CPU
+    // supports, and a variant the CPU lacks falls back to a narrower one
+    enum class FilterPath { AUTO, SCALAR, SSE2, AVX2 };
+
+private:
+    int* ids;
+    int* locations;
+    unsigned char* statuses;
+    unsigned char* vehicleClasses;
+    long long* lastPingAt;
+    int numRows;
+    int capacity;
+
+    // Open-addressing index from driver id to row
+    int* slotIds;
+    int* slotRows;
+    int slotCapacity;
+
+    void grow();
+    void rehash(int newSlotCapacity);
+    void insertSlot(int id, int row);
+
+public:
+    DriverTable(int cap = 128);
+    ~DriverTable();
+
+    int addDriver(int id, int locId, DriverStatus status, VehicleClass vClass);
+    int findRow(int id) const;
+
+    int size() const { return numRows; }
+    int getId(int row) const { return ids[row]; }
+    int getLocation(int row) const { return locations[row]; }
+    DriverStatus getStatus(int row) const { return static_cast<DriverStatus>(statuses[row]); }
+    VehicleClass getVehicleClass(int row) const { return static_cast<VehicleClass>(vehicleClasses[row]); }
+    long long getLastPingAt(int row) const { return lastPingAt[row]; }
+
+    void setLocation(int row, int locId) { locations[row] = locId; }
+    void setStatus(int row, DriverStatus s) { statuses[row] = static_cast<unsigned char>(s); }
+    void setLastPingAt(int row, long long t) { lastPingAt[row] = t; }
+
+    // Writes the rows whose status equals `status` and whose vehicle class is in
+    // `classMask` to outRows (must hold size() entries), in row order. Returns
+    // the match count.
+    int filterCandidates(DriverStatus status, unsigned classMask, int* outRows,
+                         FilterPath path = FilterPath::AUTO) const;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "EventBus.h"
+#include <chrono>
+
+EventBus::EventBus(int capacity)
+    : enqueuePos(0), dequeuePos(0), dropped(0), droppedSeen(0), numSubscribers(0),
+      running(false), consumerWaiting(false) {
+    unsigned long long size = 2;
+    while (size < static_cast<unsigned long long>(capacity)) size <<= 1;
+    cells = new Cell[size];
+    mask = size - 1;
+    for (unsigned long long i = 0; i < size; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+EventBus::~EventBus() {
+    stop();
+    delete[] cells;
+}
+
+bool EventBus::publish(const StateEvent& event) {
+    unsigned long long pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+        cell = &cells[pos & mask];
+        unsigned long long seq = cell->sequence.load(std::memory_order_acquire);
+        long long diff = static_cast<long long>(seq) - static_cast<long long>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->event = event;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+
+    if (consumerWaiting.load()) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeCv.notify_one();
+    }
+    return true;
+}
+
+bool EventBus::tryPop(StateEvent& out) {
+    unsigned long long pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell& cell = cells[pos & mask];
+    unsigned long long seq = cell.sequence.load(std::memory_order_acquire);
+    if (static_cast<long long>(seq) - static_cast<long long>(pos + 1) < 0) return false;
+
+    out = cell.event;
+    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+    dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool EventBus::subscribe(EventHandler handler, void* ctx) {
+    if (numSubscribers == MAX_SUBSCRIBERS) return false;
+    subscribers[numSubscribers].handler = handler;
+    subscribers[numSubscribers].ctx = ctx;
+    numSubscribers++;
+    return true;
+}
+
+void EventBus::deliver(const StateEvent& event) {
+    for (int i = 0; i < numSubscribers; ++i) subscribers[i].handler(event, subscribers[i].ctx);
+}
+
+int EventBus::poll(int maxEvents) {
+    int delivered = 0;
+    StateEvent event;
+    while (delivered < maxEvents && tryPop(event)) {
+        deliver(event);
+        delivered++;
+    }
+
+    long long droppedNow = dropped.load(std::memory_order_relaxed);
+    if (droppedNow != droppedSeen) {
+        droppedSeen = droppedNow;
+        StateEvent overflow = {EventType::EVENTS_DROPPED, -1, 0, 0, -1, 0, -1};
+        deliver(overflow);
+    }
+    return delivered;
+}
+
+void EventBus::run() {
+    while (running.load(std::memory_order_relaxed)) {
+        if (poll(256) > 0) continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        consumerWaiting.store(true);
+        // Re-check after announcing the wait so a concurrent publish is not missed
+        if (getDepth() == 0 && running.load(std::memory_order_relaxed)) {
+            wakeCv.wait_for(lock, std::chrono::milliseconds(10));
+        }
+        consumerWaiting.store(false);
+    }
+    poll();
+}
+
+void EventBus::start() {
+    if (running.exchange(true)) return;
+    worker = std::thread(&EventBus::run, this);
+}
+
+void EventBus::stop() {
+    if (!running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeCv.notify_one();
+    }
+    worker.join();
+}
+
+long long EventBus::getDepth() const {
+    return static_cast<long long>(enqueuePos.load(std::memory_order_relaxed) -
+                                  dequeuePos.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,89 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+enum class EventType {
+    DRIVER_STATUS,
+    DRIVER_LOCATION,
+    // oldState is -1 when the trip was just requested
+    TRIP_STATUS,
+    // Delivered once after the ring overflowed; subscribers should resync
+    EVENTS_DROPPED
+};
+
+struct StateEvent {
+    EventType type;
+    int driverId;
+    int oldState;
+    int newState;
+    int locationId;
+    long long timestamp;
+    int tripId;  // TRIP_STATUS only, -1 otherwise
+};
+
+typedef void (*EventHandler)(const StateEvent& event, void* ctx);
+
+// Bounded lock-free multi-producer / single-consumer ring of state changes.
+// Producers never block: when the ring is full the event is dropped and
+// counted. Events are consumed either by the background thread started with
+// start() or by calling poll() directly, never both.
+class EventBus {
+private:
+    struct Cell {
+        std::atomic<unsigned long long> sequence;
+        StateEvent event;
+    };
+
+    struct Subscriber {
+        EventHandler handler;
+        void* ctx;
+    };
+
+    static const int MAX_SUBSCRIBERS = 8;
+
+    Cell* cells;
+    unsigned long long mask;
+
+    alignas(64) std::atomic<unsigned long long> enqueuePos;
+    alignas(64) std::atomic<unsigned long long> dequeuePos;
+    std::atomic<long long> dropped;
+    long long droppedSeen;
+
+    Subscriber subscribers[MAX_SUBSCRIBERS];
+    int numSubscribers;
+
+    std::thread worker;
+    std::atomic<bool> running;
+    std::atomic<bool> consumerWaiting;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCv;
+
+    bool tryPop(StateEvent& out);
+    void deliver(const StateEvent& event);
+    void run();
+
+public:
+    // Capacity is rounded up to a power of two
+    EventBus(int capacity = 16384);
+    ~EventBus();
+
+    bool publish(const StateEvent& event);
+
+    // Register before start(); returns false when the subscriber table is full
+    bool subscribe(EventHandler handler, void* ctx);
+
+    // Delivers up to maxEvents queued events on the calling thread
+    int poll(int maxEvents = 1 << 30);
+
+    void start();
+    void stop();
+
+    long long getDropped() const { return dropped.load(std::memory_order_relaxed); }
+    long long getDepth() const;
+};
+
+#endif
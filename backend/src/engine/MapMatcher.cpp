@@ -0,0 +1,176 @@
+#include "MapMatcher.h"
+#include <cmath>
+
+namespace {
+
+const double METERS_PER_DEGREE_LAT = 110574.0;
+const double METERS_PER_DEGREE_LON_EQUATOR = 111320.0;
+const double PI = 3.14159265358979323846;
+// Average number of nodes per grid cell
+const int POINTS_PER_CELL = 2;
+
+// Euclidean distance from (x, y) to the axis-aligned rectangle
+double rectDistance(double x, double y, double minX, double minY, double maxX, double maxY) {
+    double dx = x < minX ? minX - x : (x > maxX ? x - maxX : 0.0);
+    double dy = y < minY ? minY - y : (y > maxY ? y - maxY : 0.0);
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Minimum where a negative current value means "unset"
+double minDistance(double current, double d) {
+    return (current < 0.0 || d < current) ? d : current;
+}
+
+} // namespace
+
+MapMatcher::MapMatcher()
+    : numPoints(0), nodeIds(nullptr), xs(nullptr), ys(nullptr), cellStart(nullptr),
+      gridWidth(0), gridHeight(0), cellSize(1.0), originLat(0.0), originLon(0.0), lonScale(METERS_PER_DEGREE_LON_EQUATOR) {}
+
+MapMatcher::~MapMatcher() {
+    delete[] nodeIds;
+    delete[] xs;
+    delete[] ys;
+    delete[] cellStart;
+}
+
+void MapMatcher::project(double lat, double lon, double& x, double& y) const {
+    x = (lon - originLon) * lonScale;
+    y = (lat - originLat) * METERS_PER_DEGREE_LAT;
+}
+
+void MapMatcher::build(const City& city) {
+    delete[] nodeIds;
+    delete[] xs;
+    delete[] ys;
+    delete[] cellStart;
+    nodeIds = nullptr;
+    xs = ys = nullptr;
+    cellStart = nullptr;
+
+    numPoints = city.getNumNodes();
+    if (numPoints == 0) return;
+
+    double minLat = city.getNodeAt(0).lat, maxLat = minLat;
+    double minLon = city.getNodeAt(0).lon, maxLon = minLon;
+    for (int i = 1; i < numPoints; ++i) {
+        const Node& n = city.getNodeAt(i);
+        if (n.lat < minLat) minLat = n.lat;
+        if (n.lat > maxLat) maxLat = n.lat;
+        if (n.lon < minLon) minLon = n.lon;
+        if (n.lon > maxLon) maxLon = n.lon;
+    }
+    originLat = minLat;
+    originLon = minLon;
+    lonScale = METERS_PER_DEGREE_LON_EQUATOR * std::cos((minLat + maxLat) * 0.5 * PI / 180.0);
+
+    double width, height;
+    project(maxLat, maxLon, width, height);
+    if (width < 1.0) width = 1.0;
+    if (height < 1.0) height = 1.0;
+
+    int targetCells = numPoints / POINTS_PER_CELL;
+    if (targetCells < 1) targetCells = 1;
+    cellSize = std::sqrt(width * height / targetCells);
+    // Keep degenerate (near-linear) layouts from producing huge grids
+    double minCell = (width > height ? width : height) / targetCells;
+    if (cellSize < minCell) cellSize = minCell;
+    gridWidth = static_cast<int>(width / cellSize) + 1;
+    gridHeight = static_cast<int>(height / cellSize) + 1;
+    int numCells = gridWidth * gridHeight;
+
+    // Counting sort of nodes by cell
+    int* cellOf = new int[numPoints];
+    double* px = new double[numPoints];
+    double* py = new double[numPoints];
+    cellStart = new int[numCells + 1]();
+    for (int i = 0; i < numPoints; ++i) {
+        const Node& n = city.getNodeAt(i);
+        project(n.lat, n.lon, px[i], py[i]);
+        int cx = static_cast<int>(px[i] / cellSize);
+        int cy = static_cast<int>(py[i] / cellSize);
+        cellOf[i] = cy * gridWidth + cx;
+        cellStart[cellOf[i] + 1]++;
+    }
+    for (int c = 0; c < numCells; ++c) cellStart[c + 1] += cellStart[c];
+
+    int* fill = new int[numCells];
+    for (int c = 0; c < numCells; ++c) fill[c] = cellStart[c];
+    nodeIds = new int[numPoints];
+    xs = new float[numPoints];
+    ys = new float[numPoints];
+    for (int i = 0; i < numPoints; ++i) {
+        int slot = fill[cellOf[i]]++;
+        nodeIds[slot] = city.getNodeAt(i).id;
+        xs[slot] = static_cast<float>(px[i]);
+        ys[slot] = static_cast<float>(py[i]);
+    }
+
+    delete[] fill;
+    delete[] cellOf;
+    delete[] px;
+    delete[] py;
+}
+
+int MapMatcher::nearestNode(double lat, double lon, double* outDistanceMeters) const {
+    if (numPoints == 0) return -1;
+
+    double qx, qy;
+    project(lat, lon, qx, qy);
+    int cx = static_cast<int>(std::floor(qx / cellSize));
+    int cy = static_cast<int>(std::floor(qy / cellSize));
+    if (cx < 0) cx = 0;
+    if (cx >= gridWidth) cx = gridWidth - 1;
+    if (cy < 0) cy = 0;
+    if (cy >= gridHeight) cy = gridHeight - 1;
+
+    const float fx = static_cast<float>(qx);
+    const float fy = static_cast<float>(qy);
+    float best = 0.0f;
+    int bestSlot = -1;
+    int maxRing = gridWidth > gridHeight ? gridWidth : gridHeight;
+
+    for (int r = 0; r <= maxRing; ++r) {
+        for (int dy = -r; dy <= r; ++dy) {
+            int y = cy + dy;
+            if (y < 0 || y >= gridHeight) continue;
+            // Interior rows of the ring only contribute their two end cells
+            int step = (dy == -r || dy == r || r == 0) ? 1 : 2 * r;
+            for (int dx = -r; dx <= r; dx += step) {
+                int x = cx + dx;
+                if (x < 0 || x >= gridWidth) continue;
+                int cell = y * gridWidth + x;
+                for (int i = cellStart[cell]; i < cellStart[cell + 1]; ++i) {
+                    float ddx = xs[i] - fx;
+                    float ddy = ys[i] - fy;
+                    float d = ddx * ddx + ddy * ddy;
+                    if (bestSlot == -1 || d < best) {
+                        best = d;
+                        bestSlot = i;
+                    }
+                }
+            }
+        }
+
+        // Unvisited cells lie in the strips of the grid outside the square of
+        // rings 0..r; the nearest strip bounds any node not yet seen
+        double gridW = gridWidth * cellSize;
+        double gridH = gridHeight * cellSize;
+        double x0 = (cx - r) * cellSize, x1 = (cx + r + 1) * cellSize;
+        double y0 = (cy - r) * cellSize, y1 = (cy + r + 1) * cellSize;
+        double bound = -1.0;
+        if (x0 > 0.0) bound = minDistance(bound, rectDistance(qx, qy, 0.0, 0.0, x0, gridH));
+        if (x1 < gridW) bound = minDistance(bound, rectDistance(qx, qy, x1, 0.0, gridW, gridH));
+        if (y0 > 0.0) bound = minDistance(bound, rectDistance(qx, qy, 0.0, 0.0, gridW, y0));
+        if (y1 < gridH) bound = minDistance(bound, rectDistance(qx, qy, 0.0, y1, gridW, gridH));
+        if (bound < 0.0) break;
+        if (bestSlot != -1 && best <= bound * bound) break;
+    }
+
+    if (outDistanceMeters) *outDistanceMeters = std::sqrt(static_cast<double>(best));
+    return nodeIds[bestSlot];
+}
+
+void MapMatcher::matchBatch(const double* lats, const double* lons, int count, int* outNodeIds) const {
+    for (int i = 0; i < count; ++i) outNodeIds[i] = nearestNode(lats[i], lons[i]);
+}
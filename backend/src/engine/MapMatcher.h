@@ -0,0 +1,41 @@
+#ifndef MAP_MATCHER_H
+#define MAP_MATCHER_H
+
+#include "../core/City.h"
+
+// Snaps raw coordinates to the nearest City node using a uniform grid.
+// Coordinates are projected once (equirectangular, metres) and stored
+// cell-by-cell in flat arrays, so a query touches a few contiguous runs.
+// The index is immutable after build(), so concurrent queries need no locks.
+class MapMatcher {
+private:
+    int numPoints;
+    int* nodeIds;       // in cell order
+    float* xs;
+    float* ys;
+    int* cellStart;     // numCells + 1 offsets into the point arrays
+
+    int gridWidth;
+    int gridHeight;
+    double cellSize;
+    double originLat;
+    double originLon;
+    double lonScale;    // metres per degree of longitude at the origin
+
+    void project(double lat, double lon, double& x, double& y) const;
+
+public:
+    MapMatcher();
+    ~MapMatcher();
+    MapMatcher(const MapMatcher&) = delete;
+    MapMatcher& operator=(const MapMatcher&) = delete;
+
+    void build(const City& city);
+    int size() const { return numPoints; }
+
+    // Returns the nearest node id, or -1 if the index is empty
+    int nearestNode(double lat, double lon, double* outDistanceMeters = nullptr) const;
+    void matchBatch(const double* lats, const double* lons, int count, int* outNodeIds) const;
+};
+
+#endif
@@ -0,0 +1,148 @@
+#include "PendingTripQueue.h"
+#include <climits>
+#include <cstring>
+
+namespace {
+
+const int EMPTY_SLOT = INT_MIN;
+const int DELETED_SLOT = INT_MIN + 1;
+
+unsigned hashId(int id) {
+    unsigned h = static_cast<unsigned>(id);
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+} // namespace
+
+PendingTripQueue::PendingTripQueue(int cap)
+    : size(0), capacity(cap > 0 ? cap : 1), slotIds(nullptr), slotPos(nullptr), slotCapacity(0), numTombstones(0) {
+    heap = new Entry[capacity];
+    rehash(64);
+}
+
+PendingTripQueue::~PendingTripQueue() {
+    delete[] heap;
+    delete[] slotIds;
+    delete[] slotPos;
+}
+
+void PendingTripQueue::rehash(int newSlotCapacity) {
+    delete[] slotIds;
+    delete[] slotPos;
+    slotCapacity = newSlotCapacity;
+    slotIds = new int[slotCapacity];
+    slotPos = new int[slotCapacity];
+    numTombstones = 0;
+    for (int i = 0; i < slotCapacity; ++i) slotIds[i] = EMPTY_SLOT;
+    for (int i = 0; i < size; ++i) setPosition(heap[i].tripId, i);
+}
+
+int PendingTripQueue::findSlot(int tripId) const {
+    unsigned mask = static_cast<unsigned>(slotCapacity - 1);
+    unsigned s = hashId(tripId) & mask;
+    while (slotIds[s] != EMPTY_SLOT) {
+        if (slotIds[s] == tripId) return static_cast<int>(s);
+        s = (s + 1) & mask;
+    }
+    return -1;
+}
+
+void PendingTripQueue::setPosition(int tripId, int pos) {
+    int existing = findSlot(tripId);
+    if (existing != -1) {
+        slotPos[existing] = pos;
+        return;
+    }
+    unsigned mask = static_cast<unsigned>(slotCapacity - 1);
+    unsigned s = hashId(tripId) & mask;
+    while (slotIds[s] != EMPTY_SLOT && slotIds[s] != DELETED_SLOT) s = (s + 1) & mask;
+    slotIds[s] = tripId;
+    slotPos[s] = pos;
+}
+
+void PendingTripQueue::eraseSlot(int tripId) {
+    int s = findSlot(tripId);
+    if (s != -1) {
+        slotIds[s] = DELETED_SLOT;
+        numTombstones++;
+    }
+}
+
+void PendingTripQueue::swapEntries(int a, int b) {
+    Entry tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+    setPosition(heap[a].tripId, a);
+    setPosition(heap[b].tripId, b);
+}
+
+void PendingTripQueue::siftUp(int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (heap[parent].key <= heap[i].key) break;
+        swapEntries(parent, i);
+        i = parent;
+    }
+}
+
+void PendingTripQueue::siftDown(int i) {
+    while (true) {
+        int smallest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < size && heap[left].key < heap[smallest].key) smallest = left;
+        if (right < size && heap[right].key < heap[smallest].key) smallest = right;
+        if (smallest == i) break;
+        swapEntries(i, smallest);
+        i = smallest;
+    }
+}
+
+bool PendingTripQueue::push(int tripId, long long requestedAt, int priority) {
+    if (contains(tripId)) return false;
+
+    if (size == capacity) {
+        Entry* next = new Entry[capacity * 2];
+        std::memcpy(next, heap, sizeof(Entry) * size);
+        delete[] heap;
+        heap = next;
+        capacity *= 2;
+    }
+    // Tombstones count against the load factor until the next rehash
+    if ((size + 1) * 2 > slotCapacity) rehash(slotCapacity * 2);
+    else if ((size + 1 + numTombstones) * 4 > slotCapacity * 3) rehash(slotCapacity);
+
+    heap[size].tripId = tripId;
+    heap[size].key = requestedAt - priority * PRIORITY_BOOST_MS;
+    setPosition(tripId, size);
+    siftUp(size++);
+    return true;
+}
+
+void PendingTripQueue::removeAt(int i) {
+    eraseSlot(heap[i].tripId);
+    size--;
+    if (i == size) return;
+
+    heap[i] = heap[size];
+    setPosition(heap[i].tripId, i);
+    siftDown(i);
+    siftUp(i);
+}
+
+bool PendingTripQueue::remove(int tripId) {
+    int s = findSlot(tripId);
+    if (s == -1) return false;
+    removeAt(slotPos[s]);
+    return true;
+}
+
+int PendingTripQueue::pop() {
+    if (size == 0) return -1;
+    int tripId = heap[0].tripId;
+    removeAt(0);
+    return tripId;
+}
@@ -0,0 +1,53 @@
+#ifndef PENDING_TRIP_QUEUE_H
+#define PENDING_TRIP_QUEUE_H
+
+// Trips that could not be dispatched, ordered so the trip that has waited
+// longest (adjusted by priority) is retried first. Each priority level counts
+// as PRIORITY_BOOST_MS of extra waiting time.
+//
+// Indexed binary min-heap: a trip id maps to its heap slot, so a trip can be
+// removed in O(log n) when it is cancelled or dispatched elsewhere.
+class PendingTripQueue {
+private:
+    struct Entry {
+        int tripId;
+        long long key;
+    };
+
+    Entry* heap;
+    int size;
+    int capacity;
+
+    // Open-addressing index from trip id to heap slot
+    int* slotIds;
+    int* slotPos;
+    int slotCapacity;
+    int numTombstones;
+
+    void swapEntries(int a, int b);
+    void siftUp(int i);
+    void siftDown(int i);
+    int findSlot(int tripId) const;
+    void setPosition(int tripId, int pos);
+    void eraseSlot(int tripId);
+    void rehash(int newSlotCapacity);
+    void removeAt(int i);
+
+public:
+    static const long long PRIORITY_BOOST_MS = 60 * 1000;
+
+    PendingTripQueue(int cap = 64);
+    ~PendingTripQueue();
+
+    // Returns false if the trip is already queued
+    bool push(int tripId, long long requestedAt, int priority = 0);
+    bool remove(int tripId);
+    bool contains(int tripId) const { return findSlot(tripId) != -1; }
+
+    bool empty() const { return size == 0; }
+    int getSize() const { return size; }
+    int top() const { return heap[0].tripId; }
+    int pop();
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "PoolingEngine.h"
+
+namespace {
+
+const int MAX_NODES = Driver::MAX_ROUTE_STOPS + 1;
+
+} // namespace
+
+bool PoolingEngine::findBestInsertion(const City& city, DistanceCache& cache, int startId, const RouteStop* stops,
+                                      int numStops, int seats, int pickupId, int dropoffId, int maxRide,
+                                      int maxPickup, PoolInsertion& out) {
+    if (numStops + 2 > Driver::MAX_ROUTE_STOPS) return false;
+
+    // Route nodes: r[0] is the driver, r[k] is stop k-1. arrive[k] is the
+    // route distance to r[k]; load[k] the riders aboard after leaving it.
+    int r[MAX_NODES];
+    int arrive[MAX_NODES];
+    int load[MAX_NODES];
+    int toPickup[MAX_NODES];
+    int toDropoff[MAX_NODES];
+    int pickupAt[MAX_NODES];  // for dropoff nodes: node index of the pickup (0 = already aboard)
+
+    int n = numStops;
+    r[0] = startId;
+    arrive[0] = 0;
+    load[0] = 0;
+    for (int k = 1; k <= n; ++k) {
+        r[k] = stops[k - 1].nodeId;
+        int leg = cache.get(city, r[k - 1], r[k]);
+        if (leg == DistanceCache::UNREACHABLE) return false;
+        arrive[k] = arrive[k - 1] + leg;
+
+        pickupAt[k] = -1;
+        if (!stops[k - 1].pickup) {
+            pickupAt[k] = 0;
+            for (int a = 1; a < k; ++a) {
+                if (stops[a - 1].pickup && stops[a - 1].tripId == stops[k - 1].tripId) pickupAt[k] = a;
+            }
+            if (pickupAt[k] == 0) load[0]++;
+        }
+    }
+    for (int k = 1; k <= n; ++k) load[k] = load[k - 1] + (stops[k - 1].pickup ? 1 : -1);
+
+    for (int k = 0; k <= n; ++k) {
+        toPickup[k] = cache.get(city, r[k], pickupId);
+        toDropoff[k] = cache.get(city, r[k], dropoffId);
+    }
+    int direct = cache.get(city, pickupId, dropoffId);
+    if (direct == DistanceCache::UNREACHABLE) return false;
+
+    bool found = false;
+    for (int i = 0; i <= n; ++i) {
+        // Pickup goes right after r[i]
+        if (toPickup[i] == DistanceCache::UNREACHABLE || load[i] + 1 > seats) continue;
+        int pickupEta = arrive[i] + toPickup[i];
+        if (maxPickup >= 0 && pickupEta > maxPickup) continue;
+
+        for (int j = i; j <= n; ++j) {
+            // Dropoff goes right after r[j] (directly after the pickup if j == i)
+            if (j > i && load[j] + 1 > seats) break;
+            if (toDropoff[j] == DistanceCache::UNREACHABLE) continue;
+
+            int shiftMid;  // delay for original stops i+1..j
+            int shiftEnd;  // delay for original stops after j
+            int ride;
+            if (j == i) {
+                int back = i < n ? toDropoff[i + 1] : 0;
+                if (i < n && back == DistanceCache::UNREACHABLE) continue;
+                shiftMid = 0;
+                shiftEnd = toPickup[i] + direct + back - (i < n ? arrive[i + 1] - arrive[i] : 0);
+                ride = direct;
+            } else {
+                if (toPickup[i + 1] == DistanceCache::UNREACHABLE) continue;
+                int back = j < n ? toDropoff[j + 1] : 0;
+                if (j < n && back == DistanceCache::UNREACHABLE) continue;
+                shiftMid = toPickup[i] + toPickup[i + 1] - (arrive[i + 1] - arrive[i]);
+                shiftEnd = shiftMid + toDropoff[j] + back - (j < n ? arrive[j + 1] - arrive[j] : 0);
+                ride = toPickup[i + 1] + (arrive[j] - arrive[i + 1]) + toDropoff[j];
+            }
+            if (maxRide >= 0 && ride > maxRide) continue;
+            if (found && shiftEnd >= out.addedCost) continue;
+
+            // Riders already on the route must stay within their own limits
+            bool feasible = true;
+            for (int k = 1; k <= n && feasible; ++k) {
+                if (pickupAt[k] == -1 || stops[k - 1].maxRide < 0) continue;
+                int a = pickupAt[k];
+                int shiftK = k <= i ? 0 : (k <= j ? shiftMid : shiftEnd);
+                int shiftA = a <= i ? 0 : (a <= j ? shiftMid : shiftEnd);
+                // Riders already aboard (a == 0) count what they have ridden so far
+                int ridden = a == 0 ? stops[k - 1].ridden : 0;
+                if (ridden + arrive[k] - arrive[a] + shiftK - shiftA > stops[k - 1].maxRide) feasible = false;
+            }
+            if (!feasible) continue;
+
+            found = true;
+            out.pickupPos = i;
+            out.dropoffPos = j + 1;
+            out.addedCost = shiftEnd;
+            out.pickupEta = pickupEta;
+            out.rideLength = ride;
+        }
+    }
+    return found;
+}
+
+int PoolingEngine::applyInsertion(const RouteStop* stops, int numStops, const PoolInsertion& insertion, int tripId,
+                                  int pickupId, int dropoffId, int maxRide, RouteStop* out) {
+    int count = 0;
+    for (int k = 0; k <= numStops; ++k) {
+        if (k == insertion.pickupPos) out[count++] = RouteStop{tripId, pickupId, true, -1, 0};
+        if (k + 1 == insertion.dropoffPos) out[count++] = RouteStop{tripId, dropoffId, false, maxRide, 0};
+        if (k < numStops) out[count++] = stops[k];
+    }
+    return count;
+}
@@ -0,0 +1,36 @@
+#ifndef POOLING_ENGINE_H
+#define POOLING_ENGINE_H
+
+#include "../core/City.h"
+#include "../core/Driver.h"
+#include "DistanceCache.h"
+
+// Where a new pickup/dropoff pair goes in a driver's route. Positions index
+// the route after insertion; costs are in edge-weight units.
+struct PoolInsertion {
+    int pickupPos;
+    int dropoffPos;
+    int addedCost;   // extra route length caused by the new trip
+    int pickupEta;   // route distance from the driver to the new pickup
+    int rideLength;  // in-vehicle distance of the new rider
+};
+
+class PoolingEngine {
+public:
+    // Cheapest feasible insertion of pickupId -> dropoffId into the route
+    // that starts at the driver's current node. Every rider, old and new,
+    // must stay within their maxRide (for riders already aboard, counting the
+    // stop's `ridden` distance) and seat use may never exceed `seats`.
+    // Distances come from `cache`; prefetch them from the pickup and dropoff
+    // for speed. Returns false if no insertion is feasible.
+    static bool findBestInsertion(const City& city, DistanceCache& cache, int startId, const RouteStop* stops,
+                                  int numStops, int seats, int pickupId, int dropoffId, int maxRide,
+                                  int maxPickup, PoolInsertion& out);
+
+    // Writes the route with the trip's two stops inserted into `out`, which
+    // must hold numStops + 2 entries. Returns the new stop count.
+    static int applyInsertion(const RouteStop* stops, int numStops, const PoolInsertion& insertion, int tripId,
+                              int pickupId, int dropoffId, int maxRide, RouteStop* out);
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include "PricingEngine.h"
+
+FareSchedule PricingEngine::defaultSchedule() {
+    FareSchedule s;
+    s.baseFare = 2.0;
+    s.perDistance = 0.5;
+    s.minimumFare = 5.0;
+    s.surgeSlope = 0.5;
+    s.maxMultiplier = 3.0;
+    s.demandWindowMs = 60 * 1000;
+    return s;
+}
+
+PricingEngine::PricingEngine(const ZoneStats& stats, int maxZones)
+    : stats(stats), schedule(defaultSchedule()), maxZones(maxZones) {
+    idleDrivers = new int[maxZones]();
+    waitingRequests = new int[maxZones]();
+    multiplierTenths = new std::atomic<int>[maxZones];
+    for (int z = 0; z < maxZones; ++z) multiplierTenths[z].store(10, std::memory_order_relaxed);
+}
+
+PricingEngine::~PricingEngine() {
+    delete[] idleDrivers;
+    delete[] waitingRequests;
+    delete[] multiplierTenths;
+}
+
+void PricingEngine::recompute(int zone, long long now) {
+    // A request is either still waiting or was dispatched; counting window
+    // requests as well would count a waiting one twice
+    double demand = waitingRequests[zone] + stats.getCount(zone, ZC_DISPATCHES, now, schedule.demandWindowMs);
+    double supply = idleDrivers[zone] > 0 ? idleDrivers[zone] : 1;
+    double multiplier = 1.0 + schedule.surgeSlope * (demand / supply - 1.0);
+    if (multiplier < 1.0) multiplier = 1.0;
+    if (multiplier > schedule.maxMultiplier) multiplier = schedule.maxMultiplier;
+    multiplierTenths[zone].store(static_cast<int>(multiplier * 10.0), std::memory_order_relaxed);
+}
+
+void PricingEngine::driverArrived(int zone, long long now) {
+    if (!validZone(zone)) return;
+    idleDrivers[zone]++;
+    recompute(zone, now);
+}
+
+void PricingEngine::driverLeft(int zone, long long now) {
+    if (!validZone(zone)) return;
+    if (idleDrivers[zone] > 0) idleDrivers[zone]--;
+    recompute(zone, now);
+}
+
+void PricingEngine::requestOpened(int zone, long long now) {
+    if (!validZone(zone)) return;
+    waitingRequests[zone]++;
+    recompute(zone, now);
+}
+
+void PricingEngine::requestClosed(int zone, long long now) {
+    if (!validZone(zone)) return;
+    if (waitingRequests[zone] > 0) waitingRequests[zone]--;
+    recompute(zone, now);
+}
+
+void PricingEngine::refresh(int numZones, long long now) {
+    if (numZones > maxZones) numZones = maxZones;
+    for (int z = 0; z < numZones; ++z) recompute(z, now);
+}
+
+double PricingEngine::getMultiplier(int zone) const {
+    if (!validZone(zone)) return 1.0;
+    return multiplierTenths[zone].load(std::memory_order_relaxed) / 10.0;
+}
+
+FareQuote PricingEngine::quote(int zone, double distance) const {
+    FareQuote q;
+    q.multiplier = getMultiplier(zone);
+    double fare = (schedule.baseFare + schedule.perDistance * distance) * q.multiplier;
+    q.fare = fare < schedule.minimumFare ? schedule.minimumFare : fare;
+    return q;
+}
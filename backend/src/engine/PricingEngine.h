@@ -0,0 +1,68 @@
+#ifndef PRICING_ENGINE_H
+#define PRICING_ENGINE_H
+
+#include "ZoneStats.h"
+#include <atomic>
+
+struct FareSchedule {
+    double baseFare;
+    double perDistance;     // per edge-weight unit of trip distance
+    double minimumFare;
+    double surgeSlope;      // multiplier gained per unit of demand/supply above 1
+    double maxMultiplier;
+    long long demandWindowMs;  // recent dispatches counted as demand
+};
+
+struct FareQuote {
+    double fare;
+    double multiplier;
+};
+
+// Per-zone surge multipliers kept current as drivers and trips change state.
+//
+// The owner reports idle drivers entering/leaving a zone and requests opening
+// (waiting for a driver) or closing; each report recomputes only that zone's
+// multiplier from
+//     demand = waiting requests + requests dispatched in the recent window
+//     supply = idle drivers
+// so quote() is a table lookup and never searches the graph. Updates must be
+// serialised by the caller; multipliers are atomics, so quotes need no lock.
+class PricingEngine {
+private:
+    const ZoneStats& stats;
+    FareSchedule schedule;
+    int maxZones;
+    int* idleDrivers;
+    int* waitingRequests;
+    std::atomic<int>* multiplierTenths;  // multiplier * 10, rounded down
+
+    void recompute(int zone, long long now);
+    bool validZone(int zone) const { return zone >= 0 && zone < maxZones; }
+
+public:
+    static FareSchedule defaultSchedule();
+
+    PricingEngine(const ZoneStats& stats, int maxZones = 256);
+    ~PricingEngine();
+    PricingEngine(const PricingEngine&) = delete;
+    PricingEngine& operator=(const PricingEngine&) = delete;
+
+    void setSchedule(const FareSchedule& s) { schedule = s; }
+    const FareSchedule& getSchedule() const { return schedule; }
+
+    void driverArrived(int zone, long long now);
+    void driverLeft(int zone, long long now);
+    void requestOpened(int zone, long long now);
+    void requestClosed(int zone, long long now);
+    // Recomputes every zone, letting old requests age out of the window
+    void refresh(int numZones, long long now);
+
+    double getMultiplier(int zone) const;
+    int getIdleDrivers(int zone) const { return validZone(zone) ? idleDrivers[zone] : 0; }
+    int getWaitingRequests(int zone) const { return validZone(zone) ? waitingRequests[zone] : 0; }
+
+    // Fare for a trip of `distance` starting in `zone`. O(1).
+    FareQuote quote(int zone, double distance) const;
+};
+
+#endif
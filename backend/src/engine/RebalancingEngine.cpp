@@ -0,0 +1,232 @@
+#include "RebalancingEngine.h"
+
+namespace {
+
+struct RepSearch {
+    const int* zoneOfRep;  // by node index, -1 if not a representative
+    int* row;              // zoneCost row being filled
+    int remaining;
+};
+
+bool recordRepresentative(int nodeIdx, int dist, void* ctx) {
+    RepSearch& search = *static_cast<RepSearch*>(ctx);
+    int zone = search.zoneOfRep[nodeIdx];
+    if (zone == -1) return false;
+    search.row[zone] = dist;
+    return --search.remaining == 0;
+}
+
+struct FlowArc {
+    int to;
+    int capacity;
+    int cost;
+    int flow;
+};
+
+} // namespace
+
+RebalancingEngine::RebalancingEngine() : numZones(0), representative(nullptr), zoneCost(nullptr) {}
+
+RebalancingEngine::~RebalancingEngine() {
+    delete[] representative;
+    delete[] zoneCost;
+}
+
+void RebalancingEngine::buildZoneCosts(const City& city) {
+    delete[] representative;
+    delete[] zoneCost;
+    numZones = city.getNumZones();
+    representative = new int[numZones];
+    zoneCost = new int[numZones * numZones];
+
+    // Representative = node closest to the zone's coordinate centroid
+    double* sumLat = new double[numZones]();
+    double* sumLon = new double[numZones]();
+    int* count = new int[numZones]();
+    for (int i = 0; i < city.getNumNodes(); ++i) {
+        const Node& node = city.getNodeAt(i);
+        sumLat[node.zoneId] += node.lat;
+        sumLon[node.zoneId] += node.lon;
+        count[node.zoneId]++;
+    }
+    double* best = new double[numZones];
+    int* repIdx = new int[numZones];
+    for (int z = 0; z < numZones; ++z) {
+        repIdx[z] = -1;
+        if (count[z] > 0) {
+            sumLat[z] /= count[z];
+            sumLon[z] /= count[z];
+        }
+    }
+    for (int i = 0; i < city.getNumNodes(); ++i) {
+        const Node& node = city.getNodeAt(i);
+        int z = node.zoneId;
+        double dLat = node.lat - sumLat[z];
+        double dLon = node.lon - sumLon[z];
+        double d = dLat * dLat + dLon * dLon;
+        if (repIdx[z] == -1 || d < best[z]) {
+            best[z] = d;
+            repIdx[z] = i;
+        }
+    }
+
+    int* zoneOfRep = new int[city.getNumNodes()];
+    for (int i = 0; i < city.getNumNodes(); ++i) zoneOfRep[i] = -1;
+    int numReps = 0;
+    for (int z = 0; z < numZones; ++z) {
+        representative[z] = repIdx[z] == -1 ? -1 : city.getNodeAt(repIdx[z]).id;
+        if (repIdx[z] != -1) {
+            zoneOfRep[repIdx[z]] = z;
+            numReps++;
+        }
+    }
+
+    for (int z = 0; z < numZones; ++z) {
+        int* row = zoneCost + z * numZones;
+        for (int t = 0; t < numZones; ++t) row[t] = -1;
+        if (representative[z] == -1) continue;
+        RepSearch search = {zoneOfRep, row, numReps};
+        city.searchFrom(representative[z], -1, recordRepresentative, &search);
+    }
+
+    delete[] zoneOfRep;
+    delete[] repIdx;
+    delete[] best;
+    delete[] count;
+    delete[] sumLon;
+    delete[] sumLat;
+}
+
+int RebalancingEngine::plan(const int* supply, const double* demand, int maxMoves, ZoneMove* out,
+                            int maxOut) const {
+    if (numZones == 0 || maxMoves <= 0) return 0;
+
+    // Target share of the idle fleet per zone, largest remainders first
+    int totalSupply = 0;
+    double totalDemand = 0.0;
+    for (int z = 0; z < numZones; ++z) {
+        totalSupply += supply[z];
+        if (representative[z] != -1) totalDemand += demand[z];
+    }
+    if (totalSupply == 0 || totalDemand <= 0.0) return 0;
+
+    int* target = new int[numZones];
+    double* remainder = new double[numZones];
+    int assigned = 0;
+    for (int z = 0; z < numZones; ++z) {
+        double share = representative[z] != -1 ? totalSupply * demand[z] / totalDemand : 0.0;
+        target[z] = static_cast<int>(share);
+        remainder[z] = share - target[z];
+        assigned += target[z];
+    }
+    while (assigned < totalSupply) {
+        int pick = 0;
+        for (int z = 1; z < numZones; ++z) {
+            if (remainder[z] > remainder[pick]) pick = z;
+        }
+        target[pick]++;
+        remainder[pick] = -1.0;
+        assigned++;
+    }
+
+    // Transport network: source -> surplus zones -> deficit zones -> sink
+    int* surplusZones = new int[numZones];
+    int* deficitZones = new int[numZones];
+    int numSurplus = 0, numDeficit = 0;
+    for (int z = 0; z < numZones; ++z) {
+        if (supply[z] > target[z]) surplusZones[numSurplus++] = z;
+        else if (supply[z] < target[z]) deficitZones[numDeficit++] = z;
+    }
+
+    int numMoves = 0;
+    if (numSurplus > 0 && numDeficit > 0) {
+        int source = 0, sink = numSurplus + numDeficit + 1;
+        int numVertices = sink + 1;
+        int maxArcs = 2 * (numSurplus + numDeficit + numSurplus * numDeficit);
+        FlowArc* arcs = new FlowArc[maxArcs];
+        int* firstArc = new int[numVertices];
+        int* nextArc = new int[maxArcs];
+        int numArcs = 0;
+        for (int v = 0; v < numVertices; ++v) firstArc[v] = -1;
+
+        auto addArc = [&](int from, int to, int capacity, int cost) {
+            arcs[numArcs] = FlowArc{to, capacity, cost, 0};
+            nextArc[numArcs] = firstArc[from];
+            firstArc[from] = numArcs++;
+            arcs[numArcs] = FlowArc{from, 0, -cost, 0};
+            nextArc[numArcs] = firstArc[to];
+            firstArc[to] = numArcs++;
+        };
+        for (int s = 0; s < numSurplus; ++s) {
+            addArc(source, 1 + s, supply[surplusZones[s]] - target[surplusZones[s]], 0);
+        }
+        for (int d = 0; d < numDeficit; ++d) {
+            addArc(1 + numSurplus + d, sink, target[deficitZones[d]] - supply[deficitZones[d]], 0);
+        }
+        int firstTransport = numArcs;
+        for (int s = 0; s < numSurplus; ++s) {
+            for (int d = 0; d < numDeficit; ++d) {
+                int cost = getZoneCost(surplusZones[s], deficitZones[d]);
+                if (cost >= 0) addArc(1 + s, 1 + numSurplus + d, maxMoves, cost);
+            }
+        }
+
+        // Successive shortest paths; Bellman-Ford copes with the negative
+        // residual arcs and the network has only a few dozen vertices
+        long long* dist = new long long[numVertices];
+        int* viaArc = new int[numVertices];
+        int moved = 0;
+        while (moved < maxMoves) {
+            for (int v = 0; v < numVertices; ++v) viaArc[v] = -1;
+            dist[source] = 0;
+            bool changed = true;
+            for (int round = 0; round < numVertices && changed; ++round) {
+                changed = false;
+                for (int v = 0; v < numVertices; ++v) {
+                    if (v != source && viaArc[v] == -1) continue;
+                    for (int a = firstArc[v]; a != -1; a = nextArc[a]) {
+                        if (arcs[a].flow >= arcs[a].capacity) continue;
+                        long long nd = dist[v] + arcs[a].cost;
+                        int to = arcs[a].to;
+                        if (to != source && (viaArc[to] == -1 || nd < dist[to])) {
+                            dist[to] = nd;
+                            viaArc[to] = a;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+            if (viaArc[sink] == -1) break;
+
+            int push = maxMoves - moved;
+            for (int v = sink; v != source; v = arcs[viaArc[v] ^ 1].to) {
+                int a = viaArc[v];
+                if (arcs[a].capacity - arcs[a].flow < push) push = arcs[a].capacity - arcs[a].flow;
+            }
+            for (int v = sink; v != source; v = arcs[viaArc[v] ^ 1].to) {
+                arcs[viaArc[v]].flow += push;
+                arcs[viaArc[v] ^ 1].flow -= push;
+            }
+            moved += push;
+        }
+
+        for (int a = firstTransport; a < numArcs && numMoves < maxOut; a += 2) {
+            if (arcs[a].flow <= 0) continue;
+            int s = arcs[a + 1].to - 1;
+            int d = arcs[a].to - 1 - numSurplus;
+            out[numMoves++] = ZoneMove{surplusZones[s], deficitZones[d], arcs[a].flow, arcs[a].cost};
+        }
+
+        delete[] viaArc;
+        delete[] dist;
+        delete[] nextArc;
+        delete[] firstArc;
+        delete[] arcs;
+    }
+
+    delete[] deficitZones;
+    delete[] surplusZones;
+    delete[] remainder;
+    delete[] target;
+    return numMoves;
+}
@@ -0,0 +1,47 @@
+#ifndef REBALANCING_ENGINE_H
+#define REBALANCING_ENGINE_H
+
+#include "../core/City.h"
+
+// Net flow of idle drivers from one zone to another
+struct ZoneMove {
+    int fromZone;
+    int toZone;
+    int drivers;
+    int cost;  // travel cost between the zones' representative nodes
+};
+
+// Plans zone-level moves of idle drivers toward forecast demand.
+//
+// Each zone is represented by the node closest to its centroid; travel costs
+// between representatives are computed once by buildZoneCosts() and reused
+// until the city changes. plan() splits the idle fleet across zones in
+// proportion to demand and moves the surplus with a min-cost flow (successive
+// shortest paths over a surplus -> deficit transport network), so each run
+// costs O(moves * zones^2) and never touches the road graph.
+class RebalancingEngine {
+private:
+    int numZones;
+    int* representative;  // node id per zone (-1 for zones without nodes)
+    int* zoneCost;        // numZones * numZones, -1 = unreachable
+
+public:
+    RebalancingEngine();
+    ~RebalancingEngine();
+    RebalancingEngine(const RebalancingEngine&) = delete;
+    RebalancingEngine& operator=(const RebalancingEngine&) = delete;
+
+    // One search per zone; call again after the city changes
+    void buildZoneCosts(const City& city);
+
+    int getNumZones() const { return numZones; }
+    int getRepresentative(int zone) const { return representative[zone]; }
+    int getZoneCost(int from, int to) const { return zoneCost[from * numZones + to]; }
+
+    // supply[z]: idle drivers in zone z; demand[z]: forecast requests. Moves
+    // at most maxMoves drivers. Writes up to maxOut zone pairs to `out` and
+    // returns the count.
+    int plan(const int* supply, const double* demand, int maxMoves, ZoneMove* out, int maxOut) const;
+};
+
+#endif
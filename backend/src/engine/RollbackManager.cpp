@@ -25,3 +25,19 @@ bool RollbackManager::rollback(int& tripId, int& driverId, TripStatus& oldStatus
     delete temp;
     return true;
 }
+
+int RollbackManager::discard(ActionFilter matches, void* ctx) {
+    int removed = 0;
+    Action** link = &top;
+    while (*link) {
+        Action* action = *link;
+        if (matches(*action, ctx)) {
+            *link = action->next;
+            delete action;
+            removed++;
+        } else {
+            link = &action->next;
+        }
+    }
+    return removed;
+}
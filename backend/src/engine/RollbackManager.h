@@ -14,6 +14,8 @@ struct Action {
         : tripId(tId), driverId(dId), oldStatus(oldS), newStatus(newS), next(n) {}
 };
 
+typedef bool (*ActionFilter)(const Action& action, void* ctx);
+
 class RollbackManager {
 private:
     Action* top;
@@ -24,6 +26,8 @@ public:
 
     void recordAction(int tripId, int driverId, TripStatus oldStatus, TripStatus newStatus);
     bool rollback(int& tripId, int& driverId, TripStatus& oldStatus, TripStatus& newStatus);
+    // Removes every action the filter matches; returns how many were removed
+    int discard(ActionFilter matches, void* ctx);
 };
 
 #endif
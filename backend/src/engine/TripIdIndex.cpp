@@ -0,0 +1,140 @@
+#include "TripIdIndex.h"
+#include <climits>
+#include <cstring>
+
+namespace {
+
+const int EMPTY_SLOT = INT_MIN;
+
+unsigned hashKey(int key) {
+    unsigned h = static_cast<unsigned>(key);
+    h ^= h >> 16;
+    h *= 0x45d9f3bu;
+    h ^= h >> 16;
+    return h;
+}
+
+// First position whose id is >= tripId
+int lowerBound(const int* ids, int size, int tripId) {
+    int lo = 0, hi = size;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (ids[mid] < tripId) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+} // namespace
+
+TripIdIndex::TripIdIndex()
+    : slotKeys(nullptr), slotList(nullptr), slotCapacity(0), numLists(0), listCapacity(16) {
+    lists = new List[listCapacity];
+    rehash(64);
+}
+
+TripIdIndex::~TripIdIndex() {
+    for (int i = 0; i < numLists; ++i) delete[] lists[i].ids;
+    delete[] lists;
+    delete[] slotKeys;
+    delete[] slotList;
+}
+
+void TripIdIndex::rehash(int newSlotCapacity) {
+    delete[] slotKeys;
+    delete[] slotList;
+    slotCapacity = newSlotCapacity;
+    slotKeys = new int[slotCapacity];
+    slotList = new int[slotCapacity];
+    for (int i = 0; i < slotCapacity; ++i) slotKeys[i] = EMPTY_SLOT;
+    for (int i = 0; i < numLists; ++i) placeSlot(lists[i].key, i);
+}
+
+void TripIdIndex::placeSlot(int key, int listIdx) {
+    unsigned mask = static_cast<unsigned>(slotCapacity - 1);
+    unsigned s = hashKey(key) & mask;
+    while (slotKeys[s] != EMPTY_SLOT) s = (s + 1) & mask;
+    slotKeys[s] = key;
+    slotList[s] = listIdx;
+}
+
+int TripIdIndex::findList(int key) const {
+    unsigned mask = static_cast<unsigned>(slotCapacity - 1);
+    unsigned s = hashKey(key) & mask;
+    while (slotKeys[s] != EMPTY_SLOT) {
+        if (slotKeys[s] == key) return slotList[s];
+        s = (s + 1) & mask;
+    }
+    return -1;
+}
+
+int TripIdIndex::addList(int key) {
+    if (numLists == listCapacity) {
+        listCapacity *= 2;
+        List* grown = new List[listCapacity];
+        std::memcpy(grown, lists, numLists * sizeof(List));
+        delete[] lists;
+        lists = grown;
+    }
+    List& list = lists[numLists];
+    list.key = key;
+    list.capacity = 4;
+    list.size = 0;
+    list.ids = new int[list.capacity];
+    numLists++;
+
+    if (numLists * 2 > slotCapacity) rehash(slotCapacity * 2);
+    else placeSlot(key, numLists - 1);
+    return numLists - 1;
+}
+
+void TripIdIndex::insert(int key, int tripId) {
+    int idx = findList(key);
+    if (idx == -1) idx = addList(key);
+    List& list = lists[idx];
+
+    if (list.size == list.capacity) {
+        list.capacity *= 2;
+        int* grown = new int[list.capacity];
+        std::memcpy(grown, list.ids, list.size * sizeof(int));
+        delete[] list.ids;
+        list.ids = grown;
+    }
+    // Common case: the newest trip goes at the tail
+    int pos = (list.size == 0 || list.ids[list.size - 1] < tripId) ? list.size
+                                                                     : lowerBound(list.ids, list.size, tripId);
+    if (pos < list.size && list.ids[pos] == tripId) return;
+    std::memmove(list.ids + pos + 1, list.ids + pos, (list.size - pos) * sizeof(int));
+    list.ids[pos] = tripId;
+    list.size++;
+}
+
+void TripIdIndex::remove(int key, int tripId) {
+    int idx = findList(key);
+    if (idx == -1) return;
+    List& list = lists[idx];
+    int pos = lowerBound(list.ids, list.size, tripId);
+    if (pos == list.size || list.ids[pos] != tripId) return;
+    std::memmove(list.ids + pos, list.ids + pos + 1, (list.size - pos - 1) * sizeof(int));
+    list.size--;
+}
+
+void TripIdIndex::clear() {
+    for (int i = 0; i < numLists; ++i) lists[i].size = 0;
+}
+
+const int* TripIdIndex::get(int key, int& size) const {
+    int idx = findList(key);
+    if (idx == -1) {
+        size = 0;
+        return nullptr;
+    }
+    size = lists[idx].size;
+    return lists[idx].ids;
+}
+
+int TripIdIndex::count(int key) const {
+    int size;
+    get(key, size);
+    return size;
+}
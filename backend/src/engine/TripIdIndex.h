@@ -0,0 +1,48 @@
+#ifndef TRIP_ID_INDEX_H
+#define TRIP_ID_INDEX_H
+
+// Secondary index from an integer key (a status, driver, rider or zone) to
+// the trips that currently have it, each list sorted by trip id. Ids grow
+// over time and trips mostly change keys in id order, so inserts and
+// removals land near the tail of a list and shift few entries.
+class TripIdIndex {
+private:
+    struct List {
+        int key;
+        int* ids;
+        int size;
+        int capacity;
+    };
+
+    // Open-addressing map from key to position in `lists`; lists are never
+    // removed, so there are no tombstones
+    int* slotKeys;
+    int* slotList;
+    int slotCapacity;
+
+    List* lists;
+    int numLists;
+    int listCapacity;
+
+    int findList(int key) const;
+    int addList(int key);
+    void placeSlot(int key, int listIdx);
+    void rehash(int newSlotCapacity);
+
+public:
+    TripIdIndex();
+    ~TripIdIndex();
+    TripIdIndex(const TripIdIndex&) = delete;
+    TripIdIndex& operator=(const TripIdIndex&) = delete;
+
+    void insert(int key, int tripId);
+    void remove(int key, int tripId);
+    // Empties every list but keeps its storage
+    void clear();
+
+    // The key's trip ids in ascending order; nullptr (size 0) if none
+    const int* get(int key, int& size) const;
+    int count(int key) const;
+};
+
+#endif
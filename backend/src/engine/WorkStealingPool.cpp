@@ -0,0 +1,120 @@
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(int workers)
+    : queued(0), unfinished(0), nextQueue(0), stopping(false) {
+    numThreads = workers > 0 ? workers : static_cast<int>(std::thread::hardware_concurrency());
+    if (numThreads <= 0) numThreads = 1;
+
+    queues = new TaskDeque[numThreads];
+    for (int i = 0; i < numThreads; ++i) {
+        queues[i].capacity = 64;
+        queues[i].tasks = new Task[queues[i].capacity];
+        queues[i].head = 0;
+        queues[i].size = 0;
+    }
+
+    threads = new std::thread[numThreads];
+    for (int i = 0; i < numThreads; ++i) threads[i] = std::thread(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping.store(true);
+    }
+    workCv.notify_all();
+    for (int i = 0; i < numThreads; ++i) threads[i].join();
+
+    for (int i = 0; i < numThreads; ++i) delete[] queues[i].tasks;
+    delete[] queues;
+    delete[] threads;
+}
+
+void WorkStealingPool::submit(TaskFn fn, void* arg) {
+    int q = static_cast<int>(nextQueue.fetch_add(1, std::memory_order_relaxed) % numThreads);
+    TaskDeque& d = queues[q];
+    unfinished.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(d.lock);
+        if (d.size == d.capacity) {
+            Task* grown = new Task[d.capacity * 2];
+            for (int i = 0; i < d.size; ++i) grown[i] = d.tasks[(d.head + i) % d.capacity];
+            delete[] d.tasks;
+            d.tasks = grown;
+            d.head = 0;
+            d.capacity *= 2;
+        }
+        d.tasks[(d.head + d.size) % d.capacity] = Task{fn, arg};
+        d.size++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued.fetch_add(1);
+    }
+    workCv.notify_one();
+}
+
+bool WorkStealingPool::popBack(int q, Task& out) {
+    TaskDeque& d = queues[q];
+    std::lock_guard<std::mutex> lock(d.lock);
+    if (d.size == 0) return false;
+    d.size--;
+    out = d.tasks[(d.head + d.size) % d.capacity];
+    return true;
+}
+
+bool WorkStealingPool::popFront(int q, Task& out) {
+    TaskDeque& d = queues[q];
+    std::lock_guard<std::mutex> lock(d.lock);
+    if (d.size == 0) return false;
+    out = d.tasks[d.head];
+    d.head = (d.head + 1) % d.capacity;
+    d.size--;
+    return true;
+}
+
+bool WorkStealingPool::findTask(int self, Task& out) {
+    if (self >= 0 && popBack(self, out)) {
+        queued.fetch_sub(1);
+        return true;
+    }
+    int start = self >= 0 ? self + 1 : 0;
+    for (int i = 0; i < numThreads; ++i) {
+        int victim = (start + i) % numThreads;
+        if (victim != self && popFront(victim, out)) {
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::runTask(const Task& task) {
+    task.fn(task.arg);
+    if (unfinished.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        doneCv.notify_all();
+    }
+}
+
+void WorkStealingPool::workerLoop(int self) {
+    Task task;
+    while (true) {
+        if (findTask(self, task)) {
+            runTask(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        workCv.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+        if (stopping.load()) return;
+    }
+}
+
+void WorkStealingPool::waitIdle() {
+    Task task;
+    while (findTask(-1, task)) runTask(task);
+
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    doneCv.wait(lock, [this] { return unfinished.load() == 0; });
+}
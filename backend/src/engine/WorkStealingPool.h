@@ -0,0 +1,63 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+typedef void (*TaskFn)(void* arg);
+
+// Fixed set of worker threads, each with its own task deque. A worker runs
+// its newest task first and, when its deque is empty, steals the oldest task
+// from another worker, so uneven batches (e.g. one busy zone) still spread
+// over every core.
+class WorkStealingPool {
+private:
+    struct Task {
+        TaskFn fn;
+        void* arg;
+    };
+
+    struct TaskDeque {
+        std::mutex lock;
+        Task* tasks;
+        int head;
+        int size;
+        int capacity;
+    };
+
+    TaskDeque* queues;
+    std::thread* threads;
+    int numThreads;
+
+    std::atomic<int> queued;      // submitted but not yet taken
+    std::atomic<int> unfinished;  // submitted but not yet completed
+    std::atomic<unsigned> nextQueue;
+    std::atomic<bool> stopping;
+
+    std::mutex sleepMutex;
+    std::condition_variable workCv;
+    std::condition_variable doneCv;
+
+    bool popBack(int q, Task& out);
+    bool popFront(int q, Task& out);
+    bool findTask(int self, Task& out);
+    void runTask(const Task& task);
+    void workerLoop(int self);
+
+public:
+    // workers <= 0 uses the hardware concurrency
+    WorkStealingPool(int workers = 0);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(TaskFn fn, void* arg);
+    // Blocks until every submitted task has finished; the caller helps run them
+    void waitIdle();
+
+    int getThreadCount() const { return numThreads; }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "ZoneStats.h"
+
+ZoneStats::ZoneStats(int maxZones, int numBuckets, long long bucketMs) : numBuckets(numBuckets), bucketMs(bucketMs) {
+    Table* t = new Table;
+    t->maxZones = maxZones > 0 ? maxZones : 1;
+    t->buckets = new Bucket[t->maxZones * numBuckets];
+    t->retired = nullptr;
+    for (int i = 0; i < t->maxZones * numBuckets; ++i) {
+        t->buckets[i].period.store(-1, std::memory_order_relaxed);
+        for (int c = 0; c < NUM_ZONE_COUNTERS; ++c) t->buckets[i].counts[c].store(0, std::memory_order_relaxed);
+    }
+    table.store(t, std::memory_order_release);
+}
+
+ZoneStats::~ZoneStats() {
+    Table* t = table.load(std::memory_order_acquire);
+    while (t) {
+        Table* older = t->retired;
+        delete[] t->buckets;
+        delete t;
+        t = older;
+    }
+}
+
+void ZoneStats::reserveZones(int numZones) {
+    Table* old = table.load(std::memory_order_acquire);
+    if (numZones <= old->maxZones) return;
+
+    Table* t = new Table;
+    t->maxZones = old->maxZones;
+    while (t->maxZones < numZones) t->maxZones *= 2;
+    t->buckets = new Bucket[t->maxZones * numBuckets];
+    t->retired = old;
+    int copied = old->maxZones * numBuckets;
+    for (int i = 0; i < t->maxZones * numBuckets; ++i) {
+        long long period = i < copied ? old->buckets[i].period.load(std::memory_order_acquire) : -1;
+        t->buckets[i].period.store(period, std::memory_order_relaxed);
+        for (int c = 0; c < NUM_ZONE_COUNTERS; ++c) {
+            long long count = i < copied ? old->buckets[i].counts[c].load(std::memory_order_relaxed) : 0;
+            t->buckets[i].counts[c].store(count, std::memory_order_relaxed);
+        }
+    }
+    table.store(t, std::memory_order_release);
+}
+
+void ZoneStats::add(int zone, ZoneCounter counter, long long now, long long amount) {
+    const Table* t = table.load(std::memory_order_acquire);
+    if (zone < 0 || zone >= t->maxZones) return;
+    long long period = now / bucketMs;
+    Bucket& bucket = t->buckets[zone * numBuckets + static_cast<int>(period % numBuckets)];
+
+    long long seen = bucket.period.load(std::memory_order_acquire);
+    while (seen != period) {
+        // Events older than the bucket's current period are outside the window
+        if (seen > period) return;
+        if (bucket.period.compare_exchange_weak(seen, period, std::memory_order_acq_rel)) {
+            for (int c = 0; c < NUM_ZONE_COUNTERS; ++c) bucket.counts[c].store(0, std::memory_order_relaxed);
+            break;
+        }
+    }
+    bucket.counts[counter].fetch_add(amount, std::memory_order_relaxed);
+}
+
+void ZoneStats::recordDispatch(int zone, long long now, long long waitMs) {
+    add(zone, ZC_DISPATCHES, now, 1);
+    add(zone, ZC_WAIT_MS, now, waitMs > 0 ? waitMs : 0);
+}
+
+void ZoneStats::sumWindow(int zone, long long now, long long windowMs, long long* totals) const {
+    for (int c = 0; c < NUM_ZONE_COUNTERS; ++c) totals[c] = 0;
+    const Table* t = table.load(std::memory_order_acquire);
+    if (zone < 0 || zone >= t->maxZones) return;
+    long long period = now / bucketMs;
+    long long span = (windowMs + bucketMs - 1) / bucketMs;
+    if (span > numBuckets) span = numBuckets;
+
+    const Bucket* ring = t->buckets + zone * numBuckets;
+    for (int i = 0; i < numBuckets; ++i) {
+        long long p = ring[i].period.load(std::memory_order_acquire);
+        if (p <= period - span || p > period) continue;
+        for (int c = 0; c < NUM_ZONE_COUNTERS; ++c) totals[c] += ring[i].counts[c].load(std::memory_order_relaxed);
+    }
+}
+
+long long ZoneStats::getCount(int zone, ZoneCounter counter, long long now, long long windowMs) const {
+    long long totals[NUM_ZONE_COUNTERS];
+    sumWindow(zone, now, windowMs, totals);
+    return totals[counter];
+}
+
+ZoneWindow ZoneStats::getWindow(int zone, long long now, long long windowMs) const {
+    long long totals[NUM_ZONE_COUNTERS];
+    sumWindow(zone, now, windowMs, totals);
+    ZoneWindow w;
+    w.requests = totals[ZC_REQUESTS];
+    w.dispatches = totals[ZC_DISPATCHES];
+    w.cancellations = totals[ZC_CANCELLATIONS];
+    w.avgWaitMs = w.dispatches > 0 ? static_cast<double>(totals[ZC_WAIT_MS]) / w.dispatches : 0.0;
+    return w;
+}
@@ -0,0 +1,77 @@
+#ifndef ZONE_STATS_H
+#define ZONE_STATS_H
+
+#include <atomic>
+
+enum ZoneCounter {
+    ZC_REQUESTS,
+    ZC_DISPATCHES,
+    ZC_CANCELLATIONS,
+    ZC_WAIT_MS,  // summed request-to-dispatch wait of the dispatches
+    NUM_ZONE_COUNTERS
+};
+
+// Sums over the trailing window for one zone
+struct ZoneWindow {
+    long long requests;
+    long long dispatches;
+    long long cancellations;
+    double avgWaitMs;  // 0 when there were no dispatches
+};
+
+// Per-zone sliding-window event counters. Each zone owns a ring of time
+// buckets; an update touches a single bucket with relaxed atomics, and a
+// bucket is recycled by the first writer to see that it belongs to an older
+// period. Readers sum the buckets still inside the window, so neither side
+// takes a lock. An increment racing with a recycle of its bucket can be
+// lost, which is acceptable for statistics.
+//
+// Zone ids at or beyond getMaxZones() are ignored; reserveZones() grows the
+// table as the city gains zones.
+class ZoneStats {
+private:
+    struct Bucket {
+        std::atomic<long long> period;  // time / bucketMs this bucket holds
+        std::atomic<long long> counts[NUM_ZONE_COUNTERS];
+    };
+
+    // Readers load the table once, so a concurrent grow never pairs a new
+    // zone count with an old bucket array. Replaced tables stay allocated
+    // (chained through `retired`) until destruction.
+    struct Table {
+        Bucket* buckets;  // maxZones * numBuckets, zone-major
+        int maxZones;
+        Table* retired;
+    };
+
+    std::atomic<Table*> table;
+    int numBuckets;
+    long long bucketMs;
+
+    void add(int zone, ZoneCounter counter, long long now, long long amount);
+    void sumWindow(int zone, long long now, long long windowMs, long long* totals) const;
+
+public:
+    // Default window: 60 buckets of 10 s
+    ZoneStats(int maxZones = 16, int numBuckets = 60, long long bucketMs = 10 * 1000);
+    ~ZoneStats();
+    ZoneStats(const ZoneStats&) = delete;
+    ZoneStats& operator=(const ZoneStats&) = delete;
+
+    void recordRequest(int zone, long long now) { add(zone, ZC_REQUESTS, now, 1); }
+    void recordCancellation(int zone, long long now) { add(zone, ZC_CANCELLATIONS, now, 1); }
+    void recordDispatch(int zone, long long now, long long waitMs);
+
+    // Sum of one counter over the last windowMs (capped at the full window)
+    long long getCount(int zone, ZoneCounter counter, long long now, long long windowMs) const;
+    ZoneWindow getWindow(int zone, long long now, long long windowMs) const;
+
+    // Makes room for zone ids below numZones, keeping the counts so far.
+    // Must not race with other updates; readers may run concurrently.
+    void reserveZones(int numZones);
+
+    long long getWindowMs() const { return numBuckets * bucketMs; }
+    int getMaxZones() const { return table.load(std::memory_order_acquire)->maxZones; }
+};
+
+#endif
@@ -1,8 +1,20 @@
 #include "system/RideShareSystem.h"
+#include "system/EventBroadcaster.h"
+#include "system/LiveViewCache.h"
+#include "system/MetricsExporter.h"
+#include "storage/CityFile.h"
+#include "metrics/Metrics.h"
 #include "../include/httplib.h"
 #include "../include/json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <cstdio>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 using json = nlohmann::json;
 
@@ -12,25 +24,198 @@ void add_cors_headers(httplib::Response &res) {
     res.set_header("Access-Control-Allow-Headers", "Content-Type");
 }
 
+// Summary of a histogram; latencies are reported in microseconds
+json histogram_json(int id, double scale) {
+    HistogramSnapshot snap;
+    Metrics::snapshot(id, snap);
+    return {{"count", snap.count},
+            {"mean", snap.mean() * scale},
+            {"p50", snap.quantile(0.50) * scale},
+            {"p90", snap.quantile(0.90) * scale},
+            {"p99", snap.quantile(0.99) * scale},
+            {"p999", snap.quantile(0.999) * scale},
+            {"max", snap.max * scale}};
+}
+
+// Per-route latency: the start time is stamped before routing and the
+// histogram ("METHOD /pattern") is resolved once per thread and route
+thread_local std::chrono::steady_clock::time_point request_start;
+
+void record_route_latency(const httplib::Request& req) {
+    thread_local std::unordered_map<std::string, int> routeIds;
+    std::string route = req.method + " " + (req.matched_route.empty() ? "unmatched" : req.matched_route);
+    auto it = routeIds.find(route);
+    if (it == routeIds.end()) it = routeIds.emplace(route, Metrics::registerHistogram("route " + route)).first;
+    Metrics::record(it->second, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - request_start).count());
+}
+
+// ETags are the view's kind plus its version
+void send_view(const httplib::Request& req, httplib::Response& res, const std::shared_ptr<const RenderedView>& view,
+               const char* kind) {
+    std::string etag = std::string("\"") + kind + std::to_string(view->version) + "\"";
+    res.set_header("ETag", etag);
+    if (req.get_header_value("If-None-Match") == etag) {
+        res.status = 304;
+        return;
+    }
+    res.set_content(view->body, "application/json");
+}
+
+const char* const TRIP_STATUS_NAMES[NUM_TRIP_STATUSES] = {"requested", "assigned", "ongoing", "completed",
+                                                          "cancelled"};
+const char* const DRIVER_STATUS_NAMES[NUM_DRIVER_STATUSES] = {"available", "busy", "offline"};
+
+void append_sse(std::string& out, const char* event, const json& data) {
+    out += "event: ";
+    out += event;
+    out += "\ndata: ";
+    out += data.dump();
+    out += "\n\n";
+}
+
+void append_state_event(std::string& out, const StateEvent& e) {
+    switch (e.type) {
+    case EventType::DRIVER_STATUS:
+        append_sse(out, "driver_status", {{"driverId", e.driverId},
+                                          {"from", DRIVER_STATUS_NAMES[e.oldState]},
+                                          {"to", DRIVER_STATUS_NAMES[e.newState]},
+                                          {"nodeId", e.locationId},
+                                          {"timestamp", e.timestamp}});
+        break;
+    case EventType::DRIVER_LOCATION:
+        append_sse(out, "driver_location", {{"driverId", e.driverId},
+                                            {"from", e.oldState},
+                                            {"nodeId", e.locationId},
+                                            {"timestamp", e.timestamp}});
+        break;
+    case EventType::TRIP_STATUS:
+        append_sse(out, "trip_status", {{"tripId", e.tripId},
+                                        {"driverId", e.driverId},
+                                        {"from", e.oldState == -1 ? json(nullptr) : json(TRIP_STATUS_NAMES[e.oldState])},
+                                        {"to", TRIP_STATUS_NAMES[e.newState]},
+                                        {"pickupNode", e.locationId},
+                                        {"timestamp", e.timestamp}});
+        break;
+    case EventType::EVENTS_DROPPED:
+        append_sse(out, "resync", {{"reason", "engine"}});
+        break;
+    }
+}
+
+// Engine-wide counters; read from atomics, so no state lock is taken
+void append_metrics_event(std::string& out, const RideShareSystem& system, long long now) {
+    json drivers, trips;
+    for (int i = 0; i < NUM_DRIVER_STATUSES; ++i) {
+        drivers[DRIVER_STATUS_NAMES[i]] = system.getDriverCount(static_cast<DriverStatus>(i));
+    }
+    for (int i = 0; i < NUM_TRIP_STATUSES; ++i) {
+        trips[TRIP_STATUS_NAMES[i]] = system.getTripCount(static_cast<TripStatus>(i));
+    }
+    append_sse(out, "metrics", {{"drivers", drivers}, {"trips", trips}, {"timestamp", now}});
+}
+
 int main() {
-    RideShareSystem system;
+    // A generated city (see rideshare_citygen) replaces the demo city
+    const char* cityFileEnv = std::getenv("RIDESHARE_CITY_FILE");
+    GeneratedCity generated;
+    if (cityFileEnv && !CityFile::read(cityFileEnv, generated)) {
+        std::cerr << "Could not read city file " << cityFileEnv << std::endl;
+        return 1;
+    }
+
+    // Terminal trips are compacted out every few seconds, so the trip table
+    // only needs room for the in-flight working set
+    int nodeCapacity = cityFileEnv ? generated.numNodes : 100;
+    int driverCapacity = cityFileEnv ? generated.numDrivers : 100;
+    int riderCapacity = cityFileEnv ? generated.numRiders : 100;
+    int tripCapacity = cityFileEnv ? std::max(1024, generated.numDrivers * 4) : 100;
+    RideShareSystem system(nodeCapacity, driverCapacity, riderCapacity, tripCapacity);
     httplib::Server svr;
+    // Responses are written as separate header and body sends; without this,
+    // Nagle holds the body until the client's delayed ACK on keep-alive
+    // connections (~40 ms per request)
+    svr.set_tcp_nodelay(true);
+    // Each event stream holds a worker for its lifetime; reserve enough that
+    // streams never starve ordinary requests
+    svr.new_task_queue = [] {
+        return new httplib::ThreadPool(CPPHTTPLIB_THREAD_POOL_COUNT + EventBroadcaster::MAX_SUBSCRIBERS);
+    };
+
+    if (cityFileEnv) {
+        generated.loadInto(system);
+    } else {
+        // Setup City (Initial State)
+        system.addNode(1, "Downtown", "Zone A", 31.5497, 74.3436);
+        system.addNode(2, "North Station", "Zone B", 31.5770, 74.3380);
+        system.addNode(3, "East Mall", "Zone C", 31.5580, 74.3950);
+        system.addNode(4, "Airport", "Zone D", 31.5216, 74.4036);
+
+        system.addEdge(1, 2, 10);
+        system.addEdge(2, 3, 15);
+        system.addEdge(3, 4, 20);
+        system.addEdge(1, 3, 25);
+
+        // Initial Drivers
+        system.addDriver(101, "Ahmad Khan", 1, "Toyota Camry");
+        system.addDriver(102, "Sara Ahmed", 2, "Honda Civic");
+        system.addDriver(103, "Ali Hassan", 3, "Suzuki Swift");
+    }
+
+    system.buildSpatialIndex();
+
+    // Dispatch search radius in edge-weight units (unset = unbounded)
+    const char* pickupLimitEnv = std::getenv("RIDESHARE_MAX_PICKUP_DISTANCE");
+    if (pickupLimitEnv) system.setMaxPickupDistance(std::atoi(pickupLimitEnv));
+
+    // Trip retention: terminal trips move to the on-disk archive after this age
+    const char* retentionEnv = std::getenv("RIDESHARE_TRIP_RETENTION_SEC");
+    const char* archiveEnv = std::getenv("RIDESHARE_ARCHIVE_PATH");
+    const char* historyEnv = std::getenv("RIDESHARE_HISTORY_PATH");
+    system.setTripRetention((retentionEnv ? std::atoll(retentionEnv) : 300) * 1000);
+    system.setArchivePath(archiveEnv ? archiveEnv : "trip_archive.bin");
+    system.setHistoryPath(historyEnv ? historyEnv : "trip_history.bin");
 
-    // Setup City (Initial State)
-    system.addNode(1, "Downtown", "Zone A");
-    system.addNode(2, "North Station", "Zone B");
-    system.addNode(3, "East Mall", "Zone C");
-    system.addNode(4, "Airport", "Zone D");
+    // Subscribes to the event bus, so it must exist before the loop starts
+    EventBroadcaster broadcaster(system);
+    system.startEventLoop();
 
-    system.addEdge(1, 2, 10);
-    system.addEdge(2, 3, 15);
-    system.addEdge(3, 4, 20);
-    system.addEdge(1, 3, 25);
+    std::thread compactor([&system]() {
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::seconds(5));
+            if (system.compactTrips() > 0) {
+                system.flushArchive();
+                system.flushHistory();
+            }
+        }
+    });
+    compactor.detach();
+
+    // Reposition suggestions for idle drivers, refreshed every few seconds
+    const char* rebalanceEnv = std::getenv("RIDESHARE_REBALANCE_SEC");
+    int rebalanceSec = rebalanceEnv ? std::atoi(rebalanceEnv) : 5;
+    std::thread rebalancer([&system, rebalanceSec]() {
+        while (true) {
+            std::this_thread::sleep_for(std::chrono::seconds(rebalanceSec > 0 ? rebalanceSec : 5));
+            system.rebalance();
+            system.refreshSurge();
+        }
+    });
+    rebalancer.detach();
+
+    svr.set_pre_routing_handler([](const httplib::Request&, httplib::Response&) {
+        request_start = std::chrono::steady_clock::now();
+        return httplib::Server::HandlerResponse::Unhandled;
+    });
+    svr.set_post_routing_handler([](const httplib::Request& req, httplib::Response&) {
+        record_route_latency(req);
+    });
 
-    // Initial Drivers
-    system.addDriver(101, "Ahmad Khan", 1, "Toyota Camry");
-    system.addDriver(102, "Sara Ahmed", 2, "Honda Civic");
-    system.addDriver(103, "Ali Hassan", 3, "Suzuki Swift");
+    // Prometheus exposition, re-rendered in the background every second
+    MetricsExporter exporter(system);
+    exporter.start();
+    // /api/metrics keeps its own CPU baseline, separate from the exporter's
+    ProcessSampler dashboardSampler;
 
     // OPTIONS handler for CORS preflight
     svr.Options(R"(/.*)", [](const httplib::Request&, httplib::Response& res) {
@@ -48,24 +233,78 @@ int main() {
         add_cors_headers(res);
     });
 
-    svr.Get("/api/drivers", [&](const httplib::Request&, httplib::Response& res) {
-        json j;
-        j["drivers"] = json::array();
-        
-        j["drivers"].push_back({
-            {"id", 101},
-            {"name", "Ahmad Khan"},
-            {"status", "available"},
-            {"location", "Downtown"}
-        });
-        j["drivers"].push_back({
-            {"id", 102},
-            {"name", "Sara Ahmed"},
-            {"status", "busy"},
-            {"location", "North Station"}
-        });
+    // Live views are rendered once per state version; a poll copies the
+    // cached body, or gets a 304 if the client already has that version
+    LiveViewCache liveViews(system);
 
-        res.set_content(j.dump(), "application/json");
+    svr.Get("/api/drivers", [&](const httplib::Request& req, httplib::Response& res) {
+        send_view(req, res, liveViews.drivers(), "d");
+        add_cors_headers(res);
+    });
+
+    svr.Get("/api/drivers/nearest", [&](const httplib::Request& req, httplib::Response& res) {
+        const int MAX_K = 50;
+        try {
+            int pickupNode = -1;
+            if (req.has_param("node")) {
+                pickupNode = std::stoi(req.get_param_value("node"));
+            } else if (req.has_param("lat") && req.has_param("lon")) {
+                pickupNode = system.snapToNode(std::stod(req.get_param_value("lat")), std::stod(req.get_param_value("lon")));
+            }
+            int k = req.has_param("k") ? std::stoi(req.get_param_value("k")) : 5;
+            if (k < 1) k = 1;
+            if (k > MAX_K) k = MAX_K;
+
+            DriverMatch matches[MAX_K];
+            int found = system.findNearestDrivers(pickupNode, k, matches);
+
+            json j;
+            j["pickupNode"] = pickupNode;
+            j["drivers"] = json::array();
+            for (int i = 0; i < found; ++i) {
+                j["drivers"].push_back({{"driverId", matches[i].driverId}, {"distance", matches[i].distance}});
+            }
+            res.set_content(j.dump(), "application/json");
+        } catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content("Invalid query parameters", "text/plain");
+        }
+        add_cors_headers(res);
+    });
+
+    svr.Get("/api/trip/quote", [&](const httplib::Request& req, httplib::Response& res) {
+        try {
+            int pickupNode = -1, dropoffNode = -1;
+            if (req.has_param("pickup")) {
+                pickupNode = std::stoi(req.get_param_value("pickup"));
+            } else if (req.has_param("pickupLat") && req.has_param("pickupLon")) {
+                pickupNode = system.snapToNode(std::stod(req.get_param_value("pickupLat")),
+                                               std::stod(req.get_param_value("pickupLon")));
+            }
+            if (req.has_param("dropoff")) {
+                dropoffNode = std::stoi(req.get_param_value("dropoff"));
+            } else if (req.has_param("dropoffLat") && req.has_param("dropoffLon")) {
+                dropoffNode = system.snapToNode(std::stod(req.get_param_value("dropoffLat")),
+                                                std::stod(req.get_param_value("dropoffLon")));
+            }
+
+            TripQuote quote;
+            bool serviceable = system.quoteTrip(pickupNode, dropoffNode, quote);
+
+            json j;
+            j["pickupNode"] = pickupNode;
+            j["dropoffNode"] = dropoffNode;
+            j["serviceable"] = serviceable;
+            j["driverId"] = quote.driverId;
+            j["pickupEta"] = quote.pickupEta;
+            j["distance"] = quote.distance;
+            j["fare"] = quote.fare;
+            j["surgeMultiplier"] = quote.multiplier;
+            res.set_content(j.dump(), "application/json");
+        } catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content("Invalid query parameters", "text/plain");
+        }
         add_cors_headers(res);
     });
 
@@ -75,14 +314,33 @@ int main() {
             int riderId = j.value("riderId", 0);
             int pickupNode = j.value("pickupNode", 1);
             int dropoffNode = j.value("dropoffNode", 4);
+            if (j.contains("pickupLat") && j.contains("pickupLon")) {
+                pickupNode = system.snapToNode(j["pickupLat"].get<double>(), j["pickupLon"].get<double>());
+            }
+            if (j.contains("dropoffLat") && j.contains("dropoffLon")) {
+                dropoffNode = system.snapToNode(j["dropoffLat"].get<double>(), j["dropoffLon"].get<double>());
+            }
 
-            int tripId = system.requestTrip(riderId, pickupNode, dropoffNode);
-            bool dispatched = system.dispatchTrip(tripId);
+            int tripId;
+            if (j.value("pooled", false)) {
+                tripId = system.requestPooledTrip(riderId, pickupNode, dropoffNode, j.value("maxDetourPct", 50));
+            } else {
+                tripId = system.requestTrip(riderId, pickupNode, dropoffNode);
+                if (tripId != -1) system.dispatchTrip(tripId);
+            }
+            Trip trip;
+            bool known = system.getTripSnapshot(tripId, trip);
+            int driverId = known ? trip.getDriverId() : -1;
+            bool dispatched = driverId != -1;
 
+            // No trip was created (trip table full): same status as the batch endpoint
+            if (tripId == -1) res.status = 503;
             json resp;
             resp["tripId"] = tripId;
-            resp["status"] = dispatched ? "dispatched" : "pending";
-            resp["driverId"] = dispatched ? 101 : 0;
+            resp["status"] = tripId == -1 ? "rejected" : (dispatched ? "dispatched" : "pending");
+            resp["driverId"] = dispatched ? driverId : 0;
+            resp["distance"] = known ? trip.getDistance() : 0.0;
+            resp["fare"] = known ? trip.getFare() : 0.0;
 
             res.set_content(resp.dump(), "application/json");
         } catch (const std::exception& e) {
@@ -93,37 +351,307 @@ int main() {
         add_cors_headers(res);
     });
 
+    svr.Post("/api/trip/request/batch", [&](const httplib::Request& req, httplib::Response& res) {
+        try {
+            auto j = json::parse(req.body);
+            const json& list = j.is_array() ? j : j.at("trips");
+
+            // Same fields and defaults as /api/trip/request; raw coordinates
+            // are map-matched in one pass
+            std::vector<TripRequestItem> items;
+            std::vector<int> rawIdx;
+            std::vector<double> lats, lons;
+            items.reserve(list.size());
+            for (const auto& entry : list) {
+                TripRequestItem item;
+                item.riderId = entry.value("riderId", 0);
+                item.pickupId = entry.value("pickupNode", 1);
+                item.dropoffId = entry.value("dropoffNode", 4);
+                item.priority = entry.value("priority", 0);
+                item.pooled = entry.value("pooled", false);
+                item.maxDetourPct = entry.value("maxDetourPct", 50);
+                int idx = static_cast<int>(items.size());
+                if (entry.contains("pickupLat") && entry.contains("pickupLon")) {
+                    rawIdx.push_back(2 * idx);
+                    lats.push_back(entry["pickupLat"].get<double>());
+                    lons.push_back(entry["pickupLon"].get<double>());
+                }
+                if (entry.contains("dropoffLat") && entry.contains("dropoffLon")) {
+                    rawIdx.push_back(2 * idx + 1);
+                    lats.push_back(entry["dropoffLat"].get<double>());
+                    lons.push_back(entry["dropoffLon"].get<double>());
+                }
+                items.push_back(item);
+            }
+
+            if (!rawIdx.empty()) {
+                std::vector<int> matched(rawIdx.size());
+                system.snapBatch(lats.data(), lons.data(), static_cast<int>(rawIdx.size()), matched.data());
+                for (size_t i = 0; i < rawIdx.size(); ++i) {
+                    TripRequestItem& item = items[rawIdx[i] / 2];
+                    (rawIdx[i] % 2 == 0 ? item.pickupId : item.dropoffId) = matched[i];
+                }
+            }
+
+            std::vector<TripRequestResult> results(items.size());
+            int dispatched = system.requestTrips(items.data(), static_cast<int>(items.size()), results.data());
+
+            json out = json::array();
+            for (const TripRequestResult& r : results) {
+                json entry;
+                entry["tripId"] = r.tripId;
+                entry["status"] = r.tripId == -1 ? "rejected" : (r.driverId != -1 ? "dispatched" : "pending");
+                entry["driverId"] = r.driverId != -1 ? r.driverId : 0;
+                entry["distance"] = r.distance;
+                entry["fare"] = r.fare;
+                out.push_back(entry);
+            }
+            json resp;
+            resp["dispatched"] = dispatched;
+            resp["results"] = out;
+            res.set_content(resp.dump(), "application/json");
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing JSON: " << e.what() << std::endl;
+            res.status = 400;
+            res.set_content("Invalid JSON", "text/plain");
+        }
+        add_cors_headers(res);
+    });
+
+    // Live trips filtered by status, driver, rider, pickup zone and request
+    // time (from inclusive, to exclusive, epoch ms), in trip id order. Pass
+    // nextCursor back as `cursor` for the following page.
+    svr.Get("/api/trips", [&](const httplib::Request& req, httplib::Response& res) {
+        const int MAX_LIMIT = 500;
+        add_cors_headers(res);
+        try {
+            TripQuery query = {-1, -1, -1, -1, -1, -1, -1};
+            if (req.has_param("status")) {
+                std::string status = req.get_param_value("status");
+                for (int i = 0; i < NUM_TRIP_STATUSES; ++i) {
+                    if (status == TRIP_STATUS_NAMES[i]) query.status = i;
+                }
+                if (query.status == -1) {
+                    res.status = 400;
+                    res.set_content("Unknown status", "text/plain");
+                    return;
+                }
+            }
+            if (req.has_param("zone")) {
+                query.zoneId = system.findZone(req.get_param_value("zone"));
+                if (query.zoneId == -1) {
+                    res.status = 400;
+                    res.set_content("Unknown zone", "text/plain");
+                    return;
+                }
+            }
+            if (req.has_param("driver")) query.driverId = std::stoi(req.get_param_value("driver"));
+            if (req.has_param("rider")) query.riderId = std::stoi(req.get_param_value("rider"));
+            if (req.has_param("from")) query.fromMs = std::stoll(req.get_param_value("from"));
+            if (req.has_param("to")) query.toMs = std::stoll(req.get_param_value("to"));
+            if (req.has_param("cursor")) query.afterTripId = std::stoi(req.get_param_value("cursor"));
+            int limit = req.has_param("limit") ? std::stoi(req.get_param_value("limit")) : 50;
+            if (limit < 1) limit = 1;
+            if (limit > MAX_LIMIT) limit = MAX_LIMIT;
+
+            std::vector<Trip> page(limit);
+            int nextCursor;
+            int count = system.queryTrips(query, page.data(), limit, nextCursor);
+
+            json j;
+            j["trips"] = json::array();
+            for (int i = 0; i < count; ++i) {
+                const Trip& trip = page[i];
+                j["trips"].push_back({{"tripId", trip.getId()},
+                                      {"riderId", trip.getRiderId()},
+                                      {"driverId", trip.getDriverId()},
+                                      {"status", TRIP_STATUS_NAMES[static_cast<int>(trip.getStatus())]},
+                                      {"pickupNode", trip.getPickupLocationId()},
+                                      {"dropoffNode", trip.getDropoffLocationId()},
+                                      {"pickupZone", system.getZoneName(trip.getPickupZoneId())},
+                                      {"priority", trip.getPriority()},
+                                      {"distance", trip.getDistance()},
+                                      {"fare", trip.getFare()},
+                                      {"requestedAt", trip.getRequestedAt()},
+                                      {"finishedAt", trip.getFinishedAt()}});
+            }
+            j["nextCursor"] = nextCursor != -1 ? json(nextCursor) : json(nullptr);
+            res.set_content(j.dump(), "application/json");
+        } catch (const std::exception& e) {
+            res.status = 400;
+            res.set_content("Invalid query parameters", "text/plain");
+        }
+    });
+
+    svr.Post("/api/drivers/locations", [&](const httplib::Request& req, httplib::Response& res) {
+        try {
+            auto j = json::parse(req.body);
+            const json& items = j.is_array() ? j : j.at("pings");
+
+            // Pings carry either a nodeId or raw lat/lon to be map-matched
+            std::vector<LocationPing> pings;
+            std::vector<int> rawIdx;
+            std::vector<double> lats, lons;
+            pings.reserve(items.size());
+            for (const auto& item : items) {
+                LocationPing ping;
+                ping.driverId = item.at("driverId").get<int>();
+                ping.timestamp = item.at("timestamp").get<long long>();
+                if (item.contains("nodeId")) {
+                    ping.nodeId = item["nodeId"].get<int>();
+                } else {
+                    ping.nodeId = -1;
+                    rawIdx.push_back(static_cast<int>(pings.size()));
+                    lats.push_back(item.at("lat").get<double>());
+                    lons.push_back(item.at("lon").get<double>());
+                }
+                pings.push_back(ping);
+            }
+
+            if (!rawIdx.empty()) {
+                std::vector<int> matched(rawIdx.size());
+                system.snapBatch(lats.data(), lons.data(), static_cast<int>(rawIdx.size()), matched.data());
+                for (size_t i = 0; i < rawIdx.size(); ++i) pings[rawIdx[i]].nodeId = matched[i];
+            }
+
+            int applied = system.applyLocationBatch(pings.data(), static_cast<int>(pings.size()));
+
+            json resp;
+            resp["accepted"] = applied;
+            resp["rejected"] = static_cast<int>(pings.size()) - applied;
+            res.set_content(resp.dump(), "application/json");
+        } catch (const std::exception& e) {
+            std::cerr << "Error parsing JSON: " << e.what() << std::endl;
+            res.status = 400;
+            res.set_content("Invalid JSON", "text/plain");
+        }
+        add_cors_headers(res);
+    });
+
     svr.Get("/api/metrics", [&](const httplib::Request&, httplib::Response& res) {
+        ProcessStats process = sampleProcessStats(dashboardSampler);
+        HistogramSnapshot dispatch;
+        Metrics::snapshot(METRIC_DISPATCH_TRIP, dispatch);
+        int nodes = system.getNodeCount();
+        int edges = system.getEdgeCount();
+
+        // Summary fields consumed by the dashboard
+        char buf[32];
         json j;
-        j["coreEngineLoad"] = 12; // Mock
-        j["memoryAllocation"] = "128 MB";
-        j["dispatchLatency"] = "15ms";
-        j["activeNodes"] = 4; // From system
-        j["edgeDensity"] = "0.75";
+        j["coreEngineLoad"] = static_cast<int>(process.cpuPercent + 0.5);
+        std::snprintf(buf, sizeof(buf), "%.1f MB", process.heapInUseBytes / (1024.0 * 1024.0));
+        j["memoryAllocation"] = buf;
+        std::snprintf(buf, sizeof(buf), "%.2fms", dispatch.quantile(0.5) / 1e6);
+        j["dispatchLatency"] = buf;
+        j["activeNodes"] = nodes;
+        std::snprintf(buf, sizeof(buf), "%.2f", nodes > 1 ? 2.0 * edges / (static_cast<double>(nodes) * (nodes - 1)) : 0.0);
+        j["edgeDensity"] = buf;
         j["status"] = "Operational";
-        
+
+        j["operations"] = {{"findShortestPath", histogram_json(METRIC_FIND_SHORTEST_PATH, 1e-3)},
+                           {"findNearestDriver", histogram_json(METRIC_FIND_NEAREST_DRIVER, 1e-3)},
+                           {"dispatchTrip", histogram_json(METRIC_DISPATCH_TRIP, 1e-3)}};
+        j["nodesSettledPerSearch"] = histogram_json(METRIC_NODES_SETTLED, 1.0);
+        j["routes"] = json::object();
+        int numHistograms = Metrics::getNumHistograms();
+        for (int id = NUM_CORE_METRICS; id < numHistograms; ++id) {
+            std::string name = Metrics::getName(id);
+            if (name.compare(0, 6, "route ") == 0) j["routes"][name.substr(6)] = histogram_json(id, 1e-3);
+        }
+        j["queues"] = {{"pendingTrips", system.getPendingTripCount()},
+                       {"eventBus", system.getEventQueueDepth()},
+                       {"eventsDropped", system.getEventsDropped()}};
+        j["memory"] = {{"heapInUseBytes", process.heapInUseBytes}, {"heapMappedBytes", process.heapMappedBytes}};
+
+        // Per-zone demand over the last five minutes
+        j["zones"] = json::array();
+        int numZones = system.getNumZones();
+        for (int z = 0; z < numZones; ++z) {
+            ZoneWindow w = system.getZoneWindow(z, 5 * 60 * 1000);
+            j["zones"].push_back({{"zone", system.getZoneName(z)},
+                                  {"requests", w.requests},
+                                  {"dispatches", w.dispatches},
+                                  {"cancellations", w.cancellations},
+                                  {"avgWaitMs", w.avgWaitMs}});
+        }
+
         res.set_content(j.dump(), "application/json");
         add_cors_headers(res);
     });
 
+    // Server-sent events: trip and driver transitions as they happen, plus
+    // engine counters every couple of seconds (which also detect closed
+    // connections). A client that falls behind gets a resync event.
+    svr.Get("/api/events", [&](const httplib::Request&, httplib::Response& res) {
+        add_cors_headers(res);
+        int sub = broadcaster.open();
+        if (sub == -1) {
+            res.status = 503;
+            res.set_content("Too many event subscribers", "text/plain");
+            return;
+        }
+        res.set_header("Cache-Control", "no-cache");
+        res.set_chunked_content_provider(
+            "text/event-stream",
+            [&broadcaster, &system, sub, lastMetricsAt = 0LL](size_t, httplib::DataSink& sink) mutable {
+                const int METRICS_INTERVAL_MS = 2000;
+                StateEvent events[256];
+                long long lost = 0;
+                // The first call sends a counter snapshot straight away
+                long long untilMetrics = lastMetricsAt + METRICS_INTERVAL_MS - systemClockMillis();
+                int timeoutMs = untilMetrics > 0 ? static_cast<int>(untilMetrics) : 0;
+                int count = broadcaster.wait(sub, events, 256, lost, timeoutMs);
+
+                std::string out;
+                if (lost > 0) append_sse(out, "resync", {{"reason", "slow_consumer"}, {"dropped", lost}});
+                for (int i = 0; i < count; ++i) append_state_event(out, events[i]);
+                long long now = systemClockMillis();
+                if (now - lastMetricsAt >= METRICS_INTERVAL_MS) {
+                    append_metrics_event(out, system, now);
+                    lastMetricsAt = now;
+                }
+                if (out.empty()) return sink.is_writable();
+                return sink.write(out.data(), out.size());
+            },
+            [&broadcaster, sub](bool) { broadcaster.close(sub); });
+    });
+
+    svr.Get("/metrics", [&](const httplib::Request&, httplib::Response& res) {
+        std::shared_ptr<const std::string> body = exporter.current();
+        res.set_content(*body, "text/plain; version=0.0.4; charset=utf-8");
+    });
+
     svr.Post("/api/undo", [&](const httplib::Request&, httplib::Response& res) {
-        system.undoLastAction();
         json j;
-        j["success"] = true;
+        j["success"] = system.undoLastAction();
         res.set_content(j.dump(), "application/json");
         add_cors_headers(res);
     });
 
-    svr.Get("/api/graph", [&](const httplib::Request&, httplib::Response& res) {
+    svr.Get("/api/rebalance", [&](const httplib::Request&, httplib::Response& res) {
+        RepositionSuggestion suggestions[64];
+        long long generatedAt = 0;
+        int count = system.getRepositionSuggestions(suggestions, 64, &generatedAt);
+
         json j;
-        j["nodes"] = 4;
-        j["edges"] = 4;
-        j["zones"] = {"Downtown", "North Station", "East Mall", "Airport"};
-        
+        j["generatedAt"] = generatedAt;
+        j["suggestions"] = json::array();
+        for (int i = 0; i < count; ++i) {
+            j["suggestions"].push_back({{"driverId", suggestions[i].driverId},
+                                        {"fromZone", system.getZoneName(suggestions[i].fromZone)},
+                                        {"toZone", system.getZoneName(suggestions[i].toZone)},
+                                        {"targetNode", suggestions[i].targetNodeId},
+                                        {"cost", suggestions[i].cost}});
+        }
         res.set_content(j.dump(), "application/json");
         add_cors_headers(res);
     });
 
+    svr.Get("/api/graph", [&](const httplib::Request& req, httplib::Response& res) {
+        send_view(req, res, liveViews.graph(), "g");
+        add_cors_headers(res);
+    });
+
     std::cout << "Starting Ride-Sharing API Server on port 8082..." << std::endl;
     svr.listen("0.0.0.0", 8082);
 
@@ -0,0 +1,194 @@
+#include "Metrics.h"
+#include <atomic>
+#include <malloc.h>
+#include <mutex>
+#include <sys/resource.h>
+#include <thread>
+
+namespace {
+
+struct HistogramShard {
+    std::atomic<unsigned long long> count;
+    std::atomic<unsigned long long> sum;
+    std::atomic<unsigned long long> max;
+    std::atomic<unsigned long long> buckets[HISTOGRAM_BUCKETS];
+};
+
+struct ThreadShard {
+    HistogramShard histograms[Metrics::MAX_HISTOGRAMS];
+    ThreadShard* next;      // all shards, for snapshots
+    ThreadShard* nextFree;  // shards released by exited threads
+};
+
+const char* const CORE_METRIC_NAMES[NUM_CORE_METRICS] = {
+    "find_shortest_path",
+    "find_nearest_driver",
+    "dispatch_trip",
+    "search_nodes_settled",
+};
+
+struct Registry {
+    std::mutex lock;
+    std::string names[Metrics::MAX_HISTOGRAMS];
+    std::atomic<int> numHistograms;
+    ThreadShard* shards;
+    ThreadShard* freeShards;
+
+    Registry() : numHistograms(0), shards(nullptr), freeShards(nullptr) {
+        for (int i = 0; i < NUM_CORE_METRICS; ++i) names[i] = CORE_METRIC_NAMES[i];
+        numHistograms.store(NUM_CORE_METRICS);
+    }
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+ThreadShard* acquireShard() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    if (r.freeShards) {
+        ThreadShard* shard = r.freeShards;
+        r.freeShards = shard->nextFree;
+        return shard;
+    }
+    ThreadShard* shard = new ThreadShard;
+    for (int h = 0; h < Metrics::MAX_HISTOGRAMS; ++h) {
+        HistogramShard& hs = shard->histograms[h];
+        hs.count.store(0, std::memory_order_relaxed);
+        hs.sum.store(0, std::memory_order_relaxed);
+        hs.max.store(0, std::memory_order_relaxed);
+        for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) hs.buckets[b].store(0, std::memory_order_relaxed);
+    }
+    shard->next = r.shards;
+    shard->nextFree = nullptr;
+    r.shards = shard;
+    return shard;
+}
+
+struct LocalShard {
+    ThreadShard* shard;
+
+    LocalShard() : shard(nullptr) {}
+    ~LocalShard() {
+        if (!shard) return;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> guard(r.lock);
+        shard->nextFree = r.freeShards;
+        r.freeShards = shard;
+    }
+};
+
+thread_local LocalShard localShard;
+
+int bucketFor(unsigned long long v) {
+    if (v < static_cast<unsigned long long>(HISTOGRAM_SUB_BUCKETS)) return static_cast<int>(v);
+    int e = 63 - __builtin_clzll(v);
+    int idx = (e - 3) * HISTOGRAM_SUB_BUCKETS + static_cast<int>((v >> (e - 4)) & (HISTOGRAM_SUB_BUCKETS - 1));
+    return idx < HISTOGRAM_BUCKETS ? idx : HISTOGRAM_BUCKETS - 1;
+}
+
+// Midpoint of a bucket's value range
+unsigned long long bucketValue(int idx) {
+    if (idx < HISTOGRAM_SUB_BUCKETS) return idx;
+    int e = idx / HISTOGRAM_SUB_BUCKETS + 3;
+    unsigned long long sub = idx % HISTOGRAM_SUB_BUCKETS;
+    unsigned long long width = 1ULL << (e - 4);
+    return ((HISTOGRAM_SUB_BUCKETS + sub) << (e - 4)) + width / 2;
+}
+
+inline void bump(std::atomic<unsigned long long>& a, unsigned long long by) {
+    // Only the owning thread writes a shard, so no read-modify-write is needed
+    a.store(a.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+}
+
+} // namespace
+
+unsigned long long HistogramSnapshot::quantile(double q) const {
+    if (count == 0) return 0;
+    unsigned long long rank = static_cast<unsigned long long>(q * count);
+    if (rank >= count) rank = count - 1;
+    unsigned long long seen = 0;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+        seen += buckets[b];
+        if (seen > rank) {
+            unsigned long long v = bucketValue(b);
+            return v < max ? v : max;
+        }
+    }
+    return max;
+}
+
+int Metrics::registerHistogram(const std::string& name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    int n = r.numHistograms.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; ++i) {
+        if (r.names[i] == name) return i;
+    }
+    if (n == MAX_HISTOGRAMS) return -1;
+    r.names[n] = name;
+    r.numHistograms.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+int Metrics::getNumHistograms() {
+    return registry().numHistograms.load(std::memory_order_acquire);
+}
+
+std::string Metrics::getName(int id) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    return id >= 0 && id < r.numHistograms.load(std::memory_order_relaxed) ? r.names[id] : "";
+}
+
+void Metrics::record(int id, unsigned long long value) {
+    if (id < 0 || id >= MAX_HISTOGRAMS) return;
+    if (!localShard.shard) localShard.shard = acquireShard();
+    HistogramShard& h = localShard.shard->histograms[id];
+    bump(h.count, 1);
+    bump(h.sum, value);
+    bump(h.buckets[bucketFor(value)], 1);
+    if (value > h.max.load(std::memory_order_relaxed)) h.max.store(value, std::memory_order_relaxed);
+}
+
+void Metrics::snapshot(int id, HistogramSnapshot& out) {
+    out.count = out.sum = out.max = 0;
+    for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) out.buckets[b] = 0;
+    if (id < 0 || id >= MAX_HISTOGRAMS) return;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> guard(r.lock);
+    for (ThreadShard* shard = r.shards; shard; shard = shard->next) {
+        const HistogramShard& h = shard->histograms[id];
+        out.count += h.count.load(std::memory_order_relaxed);
+        out.sum += h.sum.load(std::memory_order_relaxed);
+        unsigned long long m = h.max.load(std::memory_order_relaxed);
+        if (m > out.max) out.max = m;
+        for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) out.buckets[b] += h.buckets[b].load(std::memory_order_relaxed);
+    }
+}
+
+ProcessStats sampleProcessStats(ProcessSampler& sampler) {
+    ProcessStats stats;
+    struct mallinfo2 info = mallinfo2();
+    stats.heapInUseBytes = info.uordblks + info.hblkhd;
+    stats.heapMappedBytes = info.arena + info.hblkhd;
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    long long cpuUs = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL + usage.ru_utime.tv_usec +
+                      usage.ru_stime.tv_usec;
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> guard(sampler.lock);
+    long long wallUs = std::chrono::duration_cast<std::chrono::microseconds>(now - sampler.lastWall).count();
+    unsigned cores = std::thread::hardware_concurrency();
+    stats.cpuPercent = sampler.lastCpuUs > 0 && wallUs > 0
+                           ? 100.0 * (cpuUs - sampler.lastCpuUs) / (static_cast<double>(wallUs) * (cores ? cores : 1))
+                           : 0.0;
+    sampler.lastCpuUs = cpuUs;
+    sampler.lastWall = now;
+    return stats;
+}
@@ -0,0 +1,85 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+// Log-linear (HDR-style) buckets: values below 16 are exact, above that each
+// power of two is split into 16 buckets, so any recorded value is within ~6%
+// of its bucket. Values are nanoseconds for latencies; the top bucket
+// (~2^40) absorbs anything larger.
+const int HISTOGRAM_SUB_BUCKETS = 16;
+const int HISTOGRAM_BUCKETS = (40 - 3) * HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+
+// Histograms registered by the engine itself, in this order, at startup
+enum CoreMetric {
+    METRIC_FIND_SHORTEST_PATH,
+    METRIC_FIND_NEAREST_DRIVER,
+    METRIC_DISPATCH_TRIP,
+    METRIC_NODES_SETTLED,  // nodes settled per graph search (a count, not ns)
+    NUM_CORE_METRICS
+};
+
+struct HistogramSnapshot {
+    unsigned long long count;
+    unsigned long long sum;
+    unsigned long long max;
+    unsigned long long buckets[HISTOGRAM_BUCKETS];
+
+    // Value at quantile q in [0, 1], accurate to the bucket width
+    unsigned long long quantile(double q) const;
+    double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+};
+
+// Process-wide histogram registry. Each thread records into its own shard
+// with plain relaxed stores (no shared cache lines, no locks); snapshots
+// merge every shard. Shards of exited threads are kept, with their counts,
+// and handed to the next new thread.
+class Metrics {
+public:
+    static const int MAX_HISTOGRAMS = 64;
+
+    // Returns the id for `name`, registering it if needed (-1 when full)
+    static int registerHistogram(const std::string& name);
+    static int getNumHistograms();
+    static std::string getName(int id);
+
+    static void record(int id, unsigned long long value);
+    static void snapshot(int id, HistogramSnapshot& out);
+};
+
+// Records the lifetime of the scope, in nanoseconds, into a histogram
+class ScopedTimer {
+private:
+    int id;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit ScopedTimer(int histogramId) : id(histogramId), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        Metrics::record(id, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - start).count());
+    }
+};
+
+struct ProcessStats {
+    unsigned long long heapInUseBytes;   // live malloc allocations
+    unsigned long long heapMappedBytes;  // arena plus mmap'd chunks
+    double cpuPercent;                   // of all cores, since the previous sample
+};
+
+// CPU baseline for sampleProcessStats. Each consumer keeps its own, so
+// cpuPercent covers the interval since that consumer's previous sample.
+struct ProcessSampler {
+    std::mutex lock;
+    long long lastCpuUs;
+    std::chrono::steady_clock::time_point lastWall;
+
+    ProcessSampler() : lastCpuUs(0) {}
+};
+
+// Allocator and CPU usage of this process
+ProcessStats sampleProcessStats(ProcessSampler& sampler);
+
+#endif
@@ -0,0 +1,420 @@
+#include "CityGenerator.h"
+#include "../core/City.h"
+#include "../core/Driver.h"
+#include "../system/RideShareSystem.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Generated cities are laid out in kilometres around this origin
+const double ORIGIN_LAT = 40.70;
+const double ORIGIN_LON = -74.00;
+const double KM_PER_DEG_LAT = 111.0;
+const double KM_PER_DEG_LON = 84.2;  // at the origin's latitude
+
+const double BLOCK_KM = 0.2;
+const double ARTERIAL_SPEEDUP = 2.0;
+const double HIGHWAY_SPEEDUP = 4.0;
+const double WEIGHT_JITTER = 0.15;
+
+// Planar layout: share of cells with a diagonal street and of non-essential
+// streets removed
+const double DIAGONAL_SHARE = 0.3;
+const double DROP_SHARE = 0.25;
+const double POSITION_JITTER = 0.35;
+
+const int MAX_ZONES = 256;
+
+const char* const VEHICLE_NAMES[] = {"Economy", "Comfort", "XL"};
+
+struct Layout {
+    double* x;  // km
+    double* y;
+};
+
+int travelSeconds(double km, double secondsPerKm, SimRng& rng) {
+    double jitter = 1.0 + WEIGHT_JITTER * (2.0 * rng.nextDouble() - 1.0);
+    int w = static_cast<int>(km * secondsPerKm * jitter + 0.5);
+    return w > 0 ? w : 1;
+}
+
+double distanceKm(const Layout& layout, int a, int b) {
+    double dx = layout.x[a] - layout.x[b];
+    double dy = layout.y[a] - layout.y[b];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+int findRoot(int* parent, int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];
+        v = parent[v];
+    }
+    return v;
+}
+
+// Fills a side x side lattice of nodes [first, first + side^2) centred on
+// (cx, cy), assigning zone `zone` or, when zone < 0, a square partition of
+// zonesPerSide^2 zones
+void placeLattice(GeneratedCity& city, Layout& layout, int first, int side, double cx, double cy, double jitter,
+                  int zone, int zonesPerSide, SimRng& rng) {
+    double origin = -0.5 * (side - 1) * BLOCK_KM;
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int idx = first + r * side + c;
+            layout.x[idx] = cx + origin + c * BLOCK_KM + jitter * BLOCK_KM * (rng.nextDouble() - 0.5);
+            layout.y[idx] = cy + origin + r * BLOCK_KM + jitter * BLOCK_KM * (rng.nextDouble() - 0.5);
+            city.zone[idx] = zone >= 0 ? zone : (r * zonesPerSide / side) * zonesPerSide + c * zonesPerSide / side;
+        }
+    }
+}
+
+void connectGrid(GeneratedCity& city, const Layout& layout, int side, int arterialEvery, double secondsPerKm,
+                 SimRng& rng) {
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int idx = r * side + c;
+            if (c + 1 < side) {
+                double speedup = arterialEvery > 0 && r % arterialEvery == 0 ? ARTERIAL_SPEEDUP : 1.0;
+                city.addEdge(idx + 1, idx + 2, travelSeconds(distanceKm(layout, idx, idx + 1), secondsPerKm / speedup, rng));
+            }
+            if (r + 1 < side) {
+                double speedup = arterialEvery > 0 && c % arterialEvery == 0 ? ARTERIAL_SPEEDUP : 1.0;
+                city.addEdge(idx + 1, idx + side + 1,
+                             travelSeconds(distanceKm(layout, idx, idx + side), secondsPerKm / speedup, rng));
+            }
+        }
+    }
+}
+
+// Lattice streets plus one random diagonal in some cells (never both, so the
+// graph stays planar), then a share of streets removed. A random spanning
+// tree (Kruskal over shuffled streets) is always kept, so it stays connected.
+void connectPlanar(GeneratedCity& city, const Layout& layout, int first, int side, double secondsPerKm, SimRng& rng) {
+    int maxCandidates = 3 * side * side;
+    int* a = new int[maxCandidates];
+    int* b = new int[maxCandidates];
+    int count = 0;
+    for (int r = 0; r < side; ++r) {
+        for (int c = 0; c < side; ++c) {
+            int idx = first + r * side + c;
+            if (c + 1 < side) { a[count] = idx; b[count++] = idx + 1; }
+            if (r + 1 < side) { a[count] = idx; b[count++] = idx + side; }
+            if (c + 1 < side && r + 1 < side && rng.chance(DIAGONAL_SHARE)) {
+                if (rng.chance(0.5)) { a[count] = idx; b[count++] = idx + side + 1; }
+                else { a[count] = idx + 1; b[count++] = idx + side; }
+            }
+        }
+    }
+    for (int i = count - 1; i > 0; --i) {
+        int j = rng.nextInt(i + 1);
+        std::swap(a[i], a[j]);
+        std::swap(b[i], b[j]);
+    }
+
+    int n = side * side;
+    int* parent = new int[n];
+    for (int i = 0; i < n; ++i) parent[i] = i;
+    for (int i = 0; i < count; ++i) {
+        int ra = findRoot(parent, a[i] - first);
+        int rb = findRoot(parent, b[i] - first);
+        bool treeEdge = ra != rb;
+        if (treeEdge) parent[ra] = rb;
+        if (treeEdge || !rng.chance(DROP_SHARE)) {
+            city.addEdge(a[i] + 1, b[i] + 1, travelSeconds(distanceKm(layout, a[i], b[i]), secondsPerKm, rng));
+        }
+    }
+    delete[] parent;
+    delete[] a;
+    delete[] b;
+}
+
+// Demand peaks at a few hotspots over a uniform floor
+void assignPopularity(GeneratedCity& city, const Layout& layout, int first, int count, double cx, double cy,
+                      double radiusKm, double weight, SimRng& rng) {
+    const int HOTSPOTS = 3;
+    double hx[HOTSPOTS], hy[HOTSPOTS], hs[HOTSPOTS];
+    hx[0] = cx;
+    hy[0] = cy;
+    hs[0] = radiusKm / 2.0;
+    for (int h = 1; h < HOTSPOTS; ++h) {
+        hx[h] = cx + radiusKm * (rng.nextDouble() - 0.5);
+        hy[h] = cy + radiusKm * (rng.nextDouble() - 0.5);
+        hs[h] = radiusKm / 6.0;
+    }
+    for (int i = first; i < first + count; ++i) {
+        double p = 0.2;
+        for (int h = 0; h < HOTSPOTS; ++h) {
+            double dx = layout.x[i] - hx[h];
+            double dy = layout.y[i] - hy[h];
+            p += std::exp(-(dx * dx + dy * dy) / (2.0 * hs[h] * hs[h]));
+        }
+        city.popularity[i] = weight * p;
+    }
+}
+
+int squareSide(int n) {
+    int side = static_cast<int>(std::sqrt(static_cast<double>(n)));
+    return side > 1 ? side : 2;
+}
+
+void generateLattice(const CityGenConfig& config, GeneratedCity& out, Layout& layout, SimRng& rng) {
+    int side = squareSide(config.numNodes);
+    int zonesPerSide = static_cast<int>(std::sqrt(static_cast<double>(config.numZones)));
+    zonesPerSide = std::max(1, std::min(zonesPerSide, std::min(side, 16)));
+
+    int n = side * side;
+    out.reset(n, zonesPerSide * zonesPerSide, 3 * n, config.numDrivers, config.numRiders);
+    layout.x = new double[n];
+    layout.y = new double[n];
+    for (int z = 0; z < out.numZones; ++z) {
+        out.zoneNames[z] = "zone-" + std::to_string(z / zonesPerSide) + "-" + std::to_string(z % zonesPerSide);
+    }
+
+    double secondsPerKm = config.blockSeconds / BLOCK_KM;
+    bool planar = config.layout == LAYOUT_PLANAR;
+    placeLattice(out, layout, 0, side, 0.0, 0.0, planar ? POSITION_JITTER : 0.0, -1, zonesPerSide, rng);
+    if (planar) connectPlanar(out, layout, 0, side, secondsPerKm, rng);
+    else connectGrid(out, layout, side, config.arterialEvery, secondsPerKm, rng);
+    assignPopularity(out, layout, 0, n, 0.0, 0.0, side * BLOCK_KM / 2.0, 1.0, rng);
+}
+
+// Districts are planar lattices of varying size scattered over a region and
+// joined by a highway spanning tree plus a link to each one's second-nearest
+// neighbour. Highways meet at each district's central node.
+void generateClustered(const CityGenConfig& config, GeneratedCity& out, Layout& layout, SimRng& rng) {
+    int k = std::max(1, std::min(config.numZones, MAX_ZONES));
+    double* share = new double[k];
+    double totalShare = 0.0;
+    for (int i = 0; i < k; ++i) totalShare += share[i] = 0.5 + rng.nextDouble();
+
+    int* sides = new int[k];
+    int* firstNode = new int[k];
+    int n = 0;
+    double meanSideKm = 0.0;
+    for (int i = 0; i < k; ++i) {
+        sides[i] = squareSide(static_cast<int>(config.numNodes * share[i] / totalShare));
+        firstNode[i] = n;
+        n += sides[i] * sides[i];
+        meanSideKm += sides[i] * BLOCK_KM / k;
+    }
+
+    out.reset(n, k, 3 * n + 4 * k, config.numDrivers, config.numRiders);
+    layout.x = new double[n];
+    layout.y = new double[n];
+
+    // Centres on a jittered sqrt(k) x sqrt(k) arrangement, two district
+    // widths apart so districts don't overlap
+    int perRow = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(k))));
+    double pitch = 2.0 * meanSideKm;
+    double* cx = new double[k];
+    double* cy = new double[k];
+    double secondsPerKm = config.blockSeconds / BLOCK_KM;
+    for (int i = 0; i < k; ++i) {
+        cx[i] = (i % perRow) * pitch + 0.5 * meanSideKm * (rng.nextDouble() - 0.5);
+        cy[i] = (i / perRow) * pitch + 0.5 * meanSideKm * (rng.nextDouble() - 0.5);
+        out.zoneNames[i] = "district-" + std::to_string(i);
+        placeLattice(out, layout, firstNode[i], sides[i], cx[i], cy[i], POSITION_JITTER, i, 1, rng);
+        connectPlanar(out, layout, firstNode[i], sides[i], secondsPerKm, rng);
+        assignPopularity(out, layout, firstNode[i], sides[i] * sides[i], cx[i], cy[i], sides[i] * BLOCK_KM / 2.0,
+                         share[i], rng);
+    }
+
+    // Prim's MST over district centres (k is small)
+    auto hub = [&](int d) { return firstNode[d] + (sides[d] / 2) * sides[d] + sides[d] / 2; };
+    auto centreDist = [&](int a, int b) { return std::sqrt((cx[a] - cx[b]) * (cx[a] - cx[b]) + (cy[a] - cy[b]) * (cy[a] - cy[b])); };
+    bool* inTree = new bool[k]();
+    double* best = new double[k];
+    int* bestFrom = new int[k];
+    inTree[0] = true;
+    for (int i = 1; i < k; ++i) {
+        best[i] = centreDist(0, i);
+        bestFrom[i] = 0;
+    }
+    double highwaySecondsPerKm = secondsPerKm / HIGHWAY_SPEEDUP;
+    for (int added = 1; added < k; ++added) {
+        int next = -1;
+        for (int i = 0; i < k; ++i) {
+            if (!inTree[i] && (next == -1 || best[i] < best[next])) next = i;
+        }
+        inTree[next] = true;
+        out.addEdge(hub(next) + 1, hub(bestFrom[next]) + 1,
+                    travelSeconds(distanceKm(layout, hub(next), hub(bestFrom[next])), highwaySecondsPerKm, rng));
+        for (int i = 0; i < k; ++i) {
+            double d = centreDist(next, i);
+            if (!inTree[i] && d < best[i]) {
+                best[i] = d;
+                bestFrom[i] = next;
+            }
+        }
+    }
+    for (int i = 0; k > 2 && i < k; ++i) {
+        int first = -1, second = -1;
+        for (int j = 0; j < k; ++j) {
+            if (j == i) continue;
+            if (first == -1 || centreDist(i, j) < centreDist(i, first)) {
+                second = first;
+                first = j;
+            } else if (second == -1 || centreDist(i, j) < centreDist(i, second)) {
+                second = j;
+            }
+        }
+        if (i < second) {
+            out.addEdge(hub(i) + 1, hub(second) + 1,
+                        travelSeconds(distanceKm(layout, hub(i), hub(second)), highwaySecondsPerKm, rng));
+        }
+    }
+
+    delete[] share;
+    delete[] sides;
+    delete[] firstNode;
+    delete[] cx;
+    delete[] cy;
+    delete[] inTree;
+    delete[] best;
+    delete[] bestFrom;
+}
+
+} // namespace
+
+GeneratedCity::GeneratedCity()
+    : numNodes(0), lat(nullptr), lon(nullptr), zone(nullptr), popularity(nullptr), numZones(0), zoneNames(nullptr),
+      numEdges(0), edgeCapacity(0), edgeFrom(nullptr), edgeTo(nullptr), edgeWeight(nullptr), numDrivers(0),
+      driverLocation(nullptr), driverClass(nullptr), numRiders(0), riderLocation(nullptr) {}
+
+GeneratedCity::~GeneratedCity() {
+    reset(0, 0, 0, 0, 0);
+}
+
+void GeneratedCity::reset(int nodes, int zones, int edges, int drivers, int riders) {
+    delete[] lat;
+    delete[] lon;
+    delete[] zone;
+    delete[] popularity;
+    delete[] zoneNames;
+    delete[] edgeFrom;
+    delete[] edgeTo;
+    delete[] edgeWeight;
+    delete[] driverLocation;
+    delete[] driverClass;
+    delete[] riderLocation;
+
+    numNodes = nodes;
+    numZones = zones;
+    numEdges = 0;
+    edgeCapacity = edges;
+    numDrivers = drivers;
+    numRiders = riders;
+    lat = nodes > 0 ? new double[nodes] : nullptr;
+    lon = nodes > 0 ? new double[nodes] : nullptr;
+    zone = nodes > 0 ? new int[nodes] : nullptr;
+    popularity = nodes > 0 ? new double[nodes] : nullptr;
+    zoneNames = zones > 0 ? new std::string[zones] : nullptr;
+    edgeFrom = edges > 0 ? new int[edges] : nullptr;
+    edgeTo = edges > 0 ? new int[edges] : nullptr;
+    edgeWeight = edges > 0 ? new int[edges] : nullptr;
+    driverLocation = drivers > 0 ? new int[drivers] : nullptr;
+    driverClass = drivers > 0 ? new unsigned char[drivers] : nullptr;
+    riderLocation = riders > 0 ? new int[riders] : nullptr;
+}
+
+void GeneratedCity::addEdge(int fromId, int toId, int weight) {
+    if (numEdges == edgeCapacity) {
+        int newCapacity = edgeCapacity > 0 ? edgeCapacity * 2 : 64;
+        int* from = new int[newCapacity];
+        int* to = new int[newCapacity];
+        int* w = new int[newCapacity];
+        for (int i = 0; i < numEdges; ++i) {
+            from[i] = edgeFrom[i];
+            to[i] = edgeTo[i];
+            w[i] = edgeWeight[i];
+        }
+        delete[] edgeFrom;
+        delete[] edgeTo;
+        delete[] edgeWeight;
+        edgeFrom = from;
+        edgeTo = to;
+        edgeWeight = w;
+        edgeCapacity = newCapacity;
+    }
+    edgeFrom[numEdges] = fromId;
+    edgeTo[numEdges] = toId;
+    edgeWeight[numEdges] = weight;
+    numEdges++;
+}
+
+void GeneratedCity::loadInto(City& city) const {
+    for (int i = 0; i < numNodes; ++i) {
+        city.addNode(i + 1, "N" + std::to_string(i + 1), zoneNames[zone[i]], lat[i], lon[i]);
+    }
+    for (int e = 0; e < numEdges; ++e) city.addEdge(edgeFrom[e], edgeTo[e], edgeWeight[e]);
+}
+
+void GeneratedCity::loadInto(RideShareSystem& system) const {
+    for (int i = 0; i < numNodes; ++i) {
+        system.addNode(i + 1, "N" + std::to_string(i + 1), zoneNames[zone[i]], lat[i], lon[i]);
+    }
+    for (int e = 0; e < numEdges; ++e) system.addEdge(edgeFrom[e], edgeTo[e], edgeWeight[e]);
+    for (int d = 0; d < numDrivers; ++d) {
+        system.addDriver(d + 1, "Driver " + std::to_string(d + 1), driverLocation[d], VEHICLE_NAMES[driverClass[d]],
+                         static_cast<VehicleClass>(driverClass[d]));
+    }
+    for (int r = 0; r < numRiders; ++r) {
+        system.addRider(r + 1, "Rider " + std::to_string(r + 1), riderLocation[r]);
+    }
+}
+
+CityGenConfig CityGenerator::defaultConfig() {
+    CityGenConfig config;
+    config.layout = LAYOUT_GRID;
+    config.numNodes = 10000;
+    config.numZones = 16;
+    config.arterialEvery = 8;
+    config.blockSeconds = 30;
+    config.numDrivers = 500;
+    config.numRiders = 5000;
+    config.seed = 1;
+    return config;
+}
+
+void CityGenerator::generate(const CityGenConfig& config, GeneratedCity& out) {
+    SimRng rng(config.seed);
+    Layout layout = {nullptr, nullptr};
+    if (config.layout == LAYOUT_CLUSTERED) generateClustered(config, out, layout, rng);
+    else generateLattice(config, out, layout, rng);
+
+    for (int i = 0; i < out.numNodes; ++i) {
+        out.lat[i] = ORIGIN_LAT + layout.y[i] / KM_PER_DEG_LAT;
+        out.lon[i] = ORIGIN_LON + layout.x[i] / KM_PER_DEG_LON;
+    }
+    delete[] layout.x;
+    delete[] layout.y;
+
+    // Fleet and riders start where demand is; 70% economy, 20% comfort, 10% XL
+    double* cumulative = new double[out.numNodes];
+    buildPopularityTable(out, cumulative);
+    for (int d = 0; d < out.numDrivers; ++d) {
+        out.driverLocation[d] = samplePopularNode(cumulative, out.numNodes, rng) + 1;
+        double roll = rng.nextDouble();
+        VehicleClass vClass = roll < 0.7 ? VehicleClass::ECONOMY : roll < 0.9 ? VehicleClass::COMFORT : VehicleClass::XL;
+        out.driverClass[d] = static_cast<unsigned char>(vClass);
+    }
+    for (int r = 0; r < out.numRiders; ++r) {
+        out.riderLocation[r] = samplePopularNode(cumulative, out.numNodes, rng) + 1;
+    }
+    delete[] cumulative;
+}
+
+void CityGenerator::buildPopularityTable(const GeneratedCity& city, double* cumulative) {
+    double sum = 0.0;
+    for (int i = 0; i < city.numNodes; ++i) {
+        sum += city.popularity[i];
+        cumulative[i] = sum;
+    }
+}
+
+int CityGenerator::samplePopularNode(const double* cumulative, int numNodes, SimRng& rng) {
+    double target = rng.nextDouble() * cumulative[numNodes - 1];
+    int idx = static_cast<int>(std::upper_bound(cumulative, cumulative + numNodes, target) - cumulative);
+    return idx < numNodes ? idx : numNodes - 1;
+}
@@ -0,0 +1,82 @@
+#ifndef CITY_GENERATOR_H
+#define CITY_GENERATOR_H
+
+#include "SimRng.h"
+#include <string>
+
+class City;
+class RideShareSystem;
+
+enum CityLayout {
+    LAYOUT_GRID,        // square street grid with faster arterials every few blocks
+    LAYOUT_PLANAR,      // jittered lattice with random diagonals and missing streets
+    LAYOUT_CLUSTERED    // dense districts joined by highways
+};
+
+struct CityGenConfig {
+    CityLayout layout;
+    int numNodes;
+    // Grid/planar: rounded down to a square partition. Clustered: districts.
+    int numZones;
+    int arterialEvery;      // grid: every n-th street is an arterial
+    int blockSeconds;       // edge weights are travel seconds; a local block takes about this long
+    int numDrivers;
+    int numRiders;
+    unsigned long long seed;
+};
+
+// A generated city and fleet, held as flat arrays so it can be written to a
+// CityFile or loaded into a City / RideShareSystem. Node, driver and rider
+// ids are 1-based and dense; node i has id i + 1.
+struct GeneratedCity {
+    int numNodes;
+    double* lat;
+    double* lon;
+    int* zone;
+    // Relative share of trip demand (and of the initial fleet) at each node
+    double* popularity;
+
+    int numZones;
+    std::string* zoneNames;
+
+    int numEdges;
+    int edgeCapacity;
+    int* edgeFrom;
+    int* edgeTo;
+    int* edgeWeight;
+
+    int numDrivers;
+    int* driverLocation;
+    unsigned char* driverClass;  // VehicleClass
+
+    int numRiders;
+    int* riderLocation;
+
+    GeneratedCity();
+    ~GeneratedCity();
+    GeneratedCity(const GeneratedCity&) = delete;
+    GeneratedCity& operator=(const GeneratedCity&) = delete;
+
+    // Frees everything and sizes the arrays for a new city
+    void reset(int nodes, int zones, int edgeCapacity, int drivers, int riders);
+    void addEdge(int fromId, int toId, int weight);
+
+    void loadInto(City& city) const;
+    // Adds nodes, edges, drivers and riders; the system must have the capacity
+    void loadInto(RideShareSystem& system) const;
+};
+
+// Deterministic synthetic cities: the same config (including seed) always
+// yields the same graph, zones, popularity and fleet placement.
+class CityGenerator {
+public:
+    static CityGenConfig defaultConfig();
+    static void generate(const CityGenConfig& config, GeneratedCity& out);
+
+    // Picks a node index with probability proportional to its popularity,
+    // using the cumulative table from buildPopularityTable (size numNodes)
+    static void buildPopularityTable(const GeneratedCity& city, double* cumulative);
+    static int samplePopularNode(const double* cumulative, int numNodes, SimRng& rng);
+};
+
+#endif
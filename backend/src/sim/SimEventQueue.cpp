@@ -0,0 +1,44 @@
+#include "SimEventQueue.h"
+
+SimEventQueue::SimEventQueue(int cap) : size(0), capacity(cap > 0 ? cap : 1), nextSeq(0) {
+    heap = new Entry[capacity];
+}
+
+SimEventQueue::~SimEventQueue() {
+    delete[] heap;
+}
+
+void SimEventQueue::push(long long atMs, SimEventType type, int tripId) {
+    if (size == capacity) {
+        Entry* next = new Entry[capacity * 2];
+        for (int i = 0; i < size; ++i) next[i] = heap[i];
+        delete[] heap;
+        heap = next;
+        capacity *= 2;
+    }
+    Entry entry = {{atMs, type, tripId}, nextSeq++};
+    int i = size++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!before(entry, heap[parent])) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = entry;
+}
+
+SimEvent SimEventQueue::pop() {
+    SimEvent top = heap[0].event;
+    Entry last = heap[--size];
+    int i = 0;
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= size) break;
+        if (child + 1 < size && before(heap[child + 1], heap[child])) child++;
+        if (!before(heap[child], last)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    if (size > 0) heap[i] = last;
+    return top;
+}
@@ -0,0 +1,51 @@
+#ifndef SIM_EVENT_QUEUE_H
+#define SIM_EVENT_QUEUE_H
+
+enum SimEventType {
+    SIM_TRIP_REQUEST,    // next arrival from the request stream
+    SIM_PATIENCE,        // unassigned rider gives up
+    SIM_RIDER_CANCEL,    // assigned rider cancels before pickup
+    SIM_PICKUP,          // driver reaches the pickup
+    SIM_DROPOFF,         // driver reaches the dropoff
+    SIM_MAINTENANCE,     // compaction, surge refresh, rebalancing
+    SIM_HOUR_END
+};
+
+struct SimEvent {
+    long long atMs;
+    SimEventType type;
+    int tripId;
+};
+
+// Binary min-heap of pending simulation events. Events at the same time pop
+// in insertion order, so runs are reproducible.
+class SimEventQueue {
+private:
+    struct Entry {
+        SimEvent event;
+        unsigned long long seq;
+    };
+
+    Entry* heap;
+    int size;
+    int capacity;
+    unsigned long long nextSeq;
+
+    static bool before(const Entry& a, const Entry& b) {
+        return a.event.atMs != b.event.atMs ? a.event.atMs < b.event.atMs : a.seq < b.seq;
+    }
+
+public:
+    SimEventQueue(int cap = 1024);
+    ~SimEventQueue();
+    SimEventQueue(const SimEventQueue&) = delete;
+    SimEventQueue& operator=(const SimEventQueue&) = delete;
+
+    void push(long long atMs, SimEventType type, int tripId = -1);
+    SimEvent pop();
+    bool empty() const { return size == 0; }
+    int getSize() const { return size; }
+    long long peekTime() const { return heap[0].event.atMs; }
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SIM_RNG_H
+#define SIM_RNG_H
+
+#include <cmath>
+
+// splitmix64. Generators and the simulator own one each, seeded explicitly,
+// so the same seed reproduces the same city, fleet and request stream on
+// every platform (unlike std::*_distribution, whose output is unspecified).
+class SimRng {
+private:
+    unsigned long long state;
+
+public:
+    explicit SimRng(unsigned long long seed = 1) : state(seed) {}
+
+    unsigned long long next() {
+        unsigned long long z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // Uniform in [0, bound)
+    int nextInt(int bound) { return static_cast<int>(next() % static_cast<unsigned long long>(bound)); }
+    // Uniform in [0, 1)
+    double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    bool chance(double p) { return nextDouble() < p; }
+    // Exponentially distributed with the given mean
+    double nextExponential(double mean) { return -mean * std::log(1.0 - nextDouble()); }
+    // Standard normal (Box-Muller, one value per call)
+    double nextGaussian() {
+        double u = 1.0 - nextDouble();
+        double v = nextDouble();
+        return std::sqrt(-2.0 * std::log(u)) * std::cos(6.283185307179586 * v);
+    }
+};
+
+#endif
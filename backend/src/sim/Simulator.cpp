@@ -0,0 +1,348 @@
+#include "Simulator.h"
+#include "../core/Trip.h"
+#include "../system/RideShareSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+namespace {
+
+// Simulated wall clock; the first simulated hour starts at SIM_EPOCH_MS
+const long long SIM_EPOCH_MS = 1700000000000LL;
+const long long MS_PER_HOUR = 3600LL * 1000;
+long long simulatedNow = SIM_EPOCH_MS;
+
+long long simulatedClock() {
+    return simulatedNow;
+}
+
+long long threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<long long>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+enum SimTripPhase {
+    PHASE_NONE,
+    PHASE_WAITING,
+    PHASE_EN_ROUTE,
+    PHASE_ON_BOARD,
+    PHASE_DONE
+};
+
+long long quantile(long long* sorted, int n, double q) {
+    if (n == 0) return 0;
+    return sorted[static_cast<int>(q * (n - 1) + 0.5)];
+}
+
+} // namespace
+
+SimConfig Simulator::defaultConfig() {
+    SimConfig config;
+    config.city = CityGenerator::defaultConfig();
+    config.city.numDrivers = 1500;
+    config.demand = TripRequestStream::defaultProfile();
+    // Pooled routes are multi-stop; the simulator models single-rider trips
+    config.demand.pooledShare = 0.0;
+    config.hours = 24.0;
+    config.patienceMeanSec = 300.0;
+    config.cancelAfterAssignShare = 0.03;
+    config.maintenanceMs = 60 * 1000;
+    config.tripRetentionMs = 60 * 1000;
+    config.seed = 1;
+    return config;
+}
+
+Simulator::Simulator(const SimConfig& config, FILE* out)
+    : config(config), system(nullptr), stream(nullptr), rng(config.seed ^ 0x51a7u), trips(nullptr), tripCapacity(0),
+      waiting(nullptr), numWaiting(0), waitingCapacity(0), hourIndex(0), out(out) {
+    hour.waitsSec = nullptr;
+    total.waitsSec = nullptr;
+    hour.waitCapacity = total.waitCapacity = 0;
+    resetHour(hour);
+    resetHour(total);
+}
+
+Simulator::~Simulator() {
+    delete stream;
+    delete system;
+    delete[] trips;
+    delete[] waiting;
+    delete[] hour.waitsSec;
+    delete[] total.waitsSec;
+}
+
+void Simulator::resetHour(SimHourStats& stats) {
+    long long* waits = stats.waitsSec;
+    int capacity = stats.waitCapacity;
+    stats = SimHourStats();
+    stats.waitsSec = waits;
+    stats.waitCapacity = capacity;
+}
+
+void Simulator::addWait(SimHourStats& stats, long long waitSec) {
+    if (stats.numWaits == stats.waitCapacity) {
+        int newCapacity = stats.waitCapacity > 0 ? stats.waitCapacity * 2 : 1024;
+        long long* next = new long long[newCapacity];
+        for (int i = 0; i < stats.numWaits; ++i) next[i] = stats.waitsSec[i];
+        delete[] stats.waitsSec;
+        stats.waitsSec = next;
+        stats.waitCapacity = newCapacity;
+    }
+    stats.waitsSec[stats.numWaits++] = waitSec;
+}
+
+Simulator::TripState& Simulator::tripState(int tripId) {
+    if (tripId >= tripCapacity) {
+        int newCapacity = tripCapacity > 0 ? tripCapacity : 1024;
+        while (newCapacity <= tripId) newCapacity *= 2;
+        TripState* next = new TripState[newCapacity];
+        for (int i = 0; i < tripCapacity; ++i) next[i] = trips[i];
+        for (int i = tripCapacity; i < newCapacity; ++i) next[i] = {PHASE_NONE, 0};
+        delete[] trips;
+        trips = next;
+        tripCapacity = newCapacity;
+    }
+    return trips[tripId];
+}
+
+void Simulator::addWaiting(int tripId) {
+    if (numWaiting == waitingCapacity) {
+        int newCapacity = waitingCapacity > 0 ? waitingCapacity * 2 : 256;
+        int* next = new int[newCapacity];
+        for (int i = 0; i < numWaiting; ++i) next[i] = waiting[i];
+        delete[] waiting;
+        waiting = next;
+        waitingCapacity = newCapacity;
+    }
+    waiting[numWaiting++] = tripId;
+}
+
+void Simulator::pumpTimed() {
+    long long cpu = threadCpuNs();
+    system->pumpEvents();
+    hour.dispatchCpuNs += threadCpuNs() - cpu;
+}
+
+void Simulator::onAssigned(int tripId) {
+    Trip trip;
+    if (!system->getTripSnapshot(tripId, trip)) return;
+    TripState& state = tripState(tripId);
+    state.phase = PHASE_EN_ROUTE;
+    hour.dispatched++;
+
+    long long pickupMs = static_cast<long long>(trip.getPickupDistance() > 0 ? trip.getPickupDistance() : 0) * 1000;
+    events.push(simulatedNow + pickupMs, SIM_PICKUP, tripId);
+    if (rng.chance(config.cancelAfterAssignShare)) {
+        events.push(simulatedNow + static_cast<long long>(rng.nextDouble() * pickupMs), SIM_RIDER_CANCEL, tripId);
+    }
+}
+
+// Waiting trips are assigned by the engine itself when a freed driver's
+// AVAILABLE event is pumped; find the ones that were
+void Simulator::collectAssignments() {
+    Trip trip;
+    for (int i = 0; i < numWaiting;) {
+        int tripId = waiting[i];
+        bool assigned = tripState(tripId).phase == PHASE_WAITING && system->getTripSnapshot(tripId, trip) &&
+                        trip.getStatus() == TripStatus::ASSIGNED;
+        if (assigned) onAssigned(tripId);
+        if (assigned || tripState(tripId).phase != PHASE_WAITING) {
+            waiting[i] = waiting[--numWaiting];
+        } else {
+            ++i;
+        }
+    }
+}
+
+void Simulator::scheduleNextRequest() {
+    stream->next(nextRequest);
+    events.push(SIM_EPOCH_MS + nextRequest.atMs, SIM_TRIP_REQUEST);
+}
+
+void Simulator::handleRequest() {
+    hour.requests++;
+    long long cpu = threadCpuNs();
+    int tripId = system->requestTrip(nextRequest.riderId, nextRequest.pickupId, nextRequest.dropoffId,
+                                     nextRequest.priority);
+    bool dispatched = tripId != -1 && system->dispatchTrip(tripId);
+    system->pumpEvents();
+    hour.dispatchCpuNs += threadCpuNs() - cpu;
+
+    if (tripId == -1) {
+        hour.rejected++;
+    } else {
+        TripState& state = tripState(tripId);
+        state.phase = PHASE_WAITING;
+        state.requestedAt = simulatedNow;
+        if (dispatched) {
+            onAssigned(tripId);
+        } else {
+            addWaiting(tripId);
+            events.push(simulatedNow + static_cast<long long>(rng.nextExponential(config.patienceMeanSec) * 1000),
+                        SIM_PATIENCE, tripId);
+        }
+    }
+    scheduleNextRequest();
+}
+
+void Simulator::handleEvent(const SimEvent& event) {
+    switch (event.type) {
+    case SIM_TRIP_REQUEST:
+        handleRequest();
+        break;
+
+    case SIM_PATIENCE: {
+        TripState& state = tripState(event.tripId);
+        if (state.phase != PHASE_WAITING) break;
+        long long cpu = threadCpuNs();
+        system->cancelTrip(event.tripId);
+        hour.dispatchCpuNs += threadCpuNs() - cpu;
+        state.phase = PHASE_DONE;
+        hour.abandoned++;
+        break;
+    }
+
+    case SIM_RIDER_CANCEL: {
+        TripState& state = tripState(event.tripId);
+        if (state.phase != PHASE_EN_ROUTE) break;
+        long long cpu = threadCpuNs();
+        system->cancelTrip(event.tripId);
+        system->pumpEvents();
+        hour.dispatchCpuNs += threadCpuNs() - cpu;
+        state.phase = PHASE_DONE;
+        hour.cancelled++;
+        collectAssignments();
+        break;
+    }
+
+    case SIM_PICKUP: {
+        TripState& state = tripState(event.tripId);
+        if (state.phase != PHASE_EN_ROUTE) break;
+        Trip trip;
+        if (!system->getTripSnapshot(event.tripId, trip)) break;
+        long long cpu = threadCpuNs();
+        system->pickupRider(event.tripId);
+        system->pumpEvents();
+        hour.dispatchCpuNs += threadCpuNs() - cpu;
+        state.phase = PHASE_ON_BOARD;
+        long long waitSec = (simulatedNow - state.requestedAt) / 1000;
+        addWait(hour, waitSec);
+        events.push(simulatedNow + static_cast<long long>(trip.getDistance() * 1000), SIM_DROPOFF, event.tripId);
+        break;
+    }
+
+    case SIM_DROPOFF: {
+        TripState& state = tripState(event.tripId);
+        if (state.phase != PHASE_ON_BOARD) break;
+        long long cpu = threadCpuNs();
+        system->completeTrip(event.tripId);
+        system->pumpEvents();
+        hour.dispatchCpuNs += threadCpuNs() - cpu;
+        state.phase = PHASE_DONE;
+        hour.completed++;
+        collectAssignments();
+        break;
+    }
+
+    case SIM_MAINTENANCE: {
+        long long cpu = threadCpuNs();
+        system->compactTrips();
+        system->refreshSurge();
+        system->rebalance();
+        hour.maintenanceCpuNs += threadCpuNs() - cpu;
+        pumpTimed();
+        collectAssignments();
+        events.push(simulatedNow + config.maintenanceMs, SIM_MAINTENANCE);
+        break;
+    }
+
+    case SIM_HOUR_END:
+        // Reported by run(), which owns the per-hour accounting
+        break;
+    }
+}
+
+void Simulator::accumulate(const SimHourStats& from, SimHourStats& into) {
+    into.requests += from.requests;
+    into.rejected += from.rejected;
+    into.dispatched += from.dispatched;
+    into.completed += from.completed;
+    into.abandoned += from.abandoned;
+    into.cancelled += from.cancelled;
+    into.dispatchCpuNs += from.dispatchCpuNs;
+    into.maintenanceCpuNs += from.maintenanceCpuNs;
+    for (int i = 0; i < from.numWaits; ++i) addWait(into, from.waitsSec[i]);
+}
+
+void Simulator::writeStats(const SimHourStats& stats) {
+    std::sort(stats.waitsSec, stats.waitsSec + stats.numWaits);
+    double waitSum = 0.0;
+    for (int i = 0; i < stats.numWaits; ++i) waitSum += stats.waitsSec[i];
+    long long perRequest = stats.requests > 0 ? stats.requests : 1;
+    std::fprintf(out,
+                 "\"requests\":%lld,\"rejected\":%lld,\"dispatched\":%lld,\"completed\":%lld,"
+                 "\"abandoned\":%lld,\"cancelled\":%lld,\"wait_mean_s\":%.1f,\"wait_p50_s\":%lld,"
+                 "\"wait_p90_s\":%lld,\"wait_p99_s\":%lld,\"dispatch_cpu_ms\":%.3f,"
+                 "\"dispatch_cpu_us_per_request\":%.2f,\"maintenance_cpu_ms\":%.3f",
+                 stats.requests, stats.rejected, stats.dispatched, stats.completed, stats.abandoned, stats.cancelled,
+                 stats.numWaits > 0 ? waitSum / stats.numWaits : 0.0, quantile(stats.waitsSec, stats.numWaits, 0.5),
+                 quantile(stats.waitsSec, stats.numWaits, 0.9), quantile(stats.waitsSec, stats.numWaits, 0.99),
+                 stats.dispatchCpuNs / 1e6, stats.dispatchCpuNs / 1e3 / perRequest, stats.maintenanceCpuNs / 1e6);
+}
+
+void Simulator::reportHour(long long wallNs) {
+    std::fprintf(out, "{\"hour\":%d,", hourIndex);
+    writeStats(hour);
+    std::fprintf(out, ",\"busy_drivers\":%lld,\"available_drivers\":%lld,\"pending_trips\":%d,\"wall_ms\":%.1f}\n",
+                 system->getDriverCount(DriverStatus::BUSY), system->getDriverCount(DriverStatus::AVAILABLE),
+                 system->getPendingTripCount(), wallNs / 1e6);
+    std::fflush(out);
+}
+
+void Simulator::run() {
+    auto started = std::chrono::steady_clock::now();
+    CityGenerator::generate(config.city, city);
+    int tripTableSize = std::max(4096, city.numDrivers * 8);
+    system = new RideShareSystem(city.numNodes, city.numDrivers, city.numRiders, tripTableSize);
+    simulatedNow = SIM_EPOCH_MS;
+    system->setClock(simulatedClock);
+    system->setTripRetention(config.tripRetentionMs);
+    city.loadInto(*system);
+    system->pumpEvents();
+    stream = new TripRequestStream(city, config.demand, config.seed);
+    std::fprintf(stderr, "simulating %.1f h on %d nodes, %d drivers (setup %.0f ms)\n", config.hours, city.numNodes,
+                 city.numDrivers,
+                 std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count());
+
+    long long endMs = SIM_EPOCH_MS + static_cast<long long>(config.hours * MS_PER_HOUR);
+    scheduleNextRequest();
+    events.push(SIM_EPOCH_MS + config.maintenanceMs, SIM_MAINTENANCE);
+    events.push(SIM_EPOCH_MS + MS_PER_HOUR, SIM_HOUR_END);
+
+    auto runStart = std::chrono::steady_clock::now();
+    auto hourStart = runStart;
+    while (!events.empty() && events.peekTime() <= endMs) {
+        SimEvent event = events.pop();
+        simulatedNow = event.atMs;
+        if (event.type == SIM_HOUR_END) {
+            auto now = std::chrono::steady_clock::now();
+            reportHour(std::chrono::duration_cast<std::chrono::nanoseconds>(now - hourStart).count());
+            accumulate(hour, total);
+            resetHour(hour);
+            hourStart = now;
+            hourIndex++;
+            events.push(simulatedNow + MS_PER_HOUR, SIM_HOUR_END);
+            continue;
+        }
+        handleEvent(event);
+    }
+    if (hour.requests > 0 || hour.numWaits > 0) accumulate(hour, total);
+
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+    std::fprintf(out, "{\"summary\":true,\"hours\":%.2f,", config.hours);
+    writeStats(total);
+    std::fprintf(out, ",\"wall_ms\":%.1f,\"speedup\":%.0f}\n", wallMs,
+                 wallMs > 0 ? config.hours * MS_PER_HOUR / wallMs : 0.0);
+    std::fflush(out);
+}
@@ -0,0 +1,102 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "CityGenerator.h"
+#include "SimEventQueue.h"
+#include "TripRequestStream.h"
+#include <cstdio>
+
+class RideShareSystem;
+
+struct SimConfig {
+    CityGenConfig city;
+    DemandProfile demand;
+    double hours;                   // simulated duration
+    double patienceMeanSec;         // unassigned riders cancel after Exp(mean)
+    double cancelAfterAssignShare;  // assigned riders who cancel before pickup
+    long long maintenanceMs;        // compaction / surge / rebalance cadence
+    long long tripRetentionMs;
+    unsigned long long seed;        // request stream and rider behaviour
+};
+
+// Counters for one simulated hour
+struct SimHourStats {
+    long long requests;
+    long long rejected;        // trip table full
+    long long dispatched;
+    long long completed;
+    long long abandoned;       // gave up while unassigned
+    long long cancelled;       // cancelled after assignment
+    long long dispatchCpuNs;   // thread CPU in request/dispatch/complete/cancel and event pumping
+    long long maintenanceCpuNs;
+    long long* waitsSec;       // request -> pickup
+    int numWaits;
+    int waitCapacity;
+};
+
+// Discrete-event simulation of a day (or any span) of operation against the
+// real RideShareSystem. Simulated time comes from the system's injectable
+// clock, so everything (timestamps, surge windows, zone stats, retention)
+// runs on simulated time; travel times are the graph's edge weights, read
+// as seconds. Dispatch runs on the caller's thread via pumpEvents, so its
+// CPU cost is measured directly.
+//
+// The clock hook is a plain function pointer, so only one Simulator may run
+// at a time in a process.
+class Simulator {
+private:
+    struct TripState {
+        unsigned char phase;   // see SimTripPhase in Simulator.cpp
+        long long requestedAt;
+    };
+
+    SimConfig config;
+    GeneratedCity city;
+    RideShareSystem* system;
+    TripRequestStream* stream;
+    SimEventQueue events;
+    SimRng rng;
+    // Requests are drawn one ahead; the queue holds a single SIM_TRIP_REQUEST
+    // for this spec at a time
+    TripRequestSpec nextRequest;
+
+    TripState* trips;          // indexed by trip id
+    int tripCapacity;
+    int* waiting;              // ids of trips not yet assigned
+    int numWaiting;
+    int waitingCapacity;
+
+    SimHourStats hour;
+    SimHourStats total;
+    int hourIndex;
+    FILE* out;
+
+    TripState& tripState(int tripId);
+    void addWaiting(int tripId);
+    void onAssigned(int tripId);
+    void collectAssignments();
+    void pumpTimed();
+
+    void scheduleNextRequest();
+    void handleRequest();
+    void handleEvent(const SimEvent& event);
+    void reportHour(long long wallNs);
+    void resetHour(SimHourStats& stats);
+    void accumulate(const SimHourStats& from, SimHourStats& into);
+    void addWait(SimHourStats& stats, long long waitSec);
+    void writeStats(const SimHourStats& stats);
+
+public:
+    static SimConfig defaultConfig();
+
+    Simulator(const SimConfig& config, FILE* out = stdout);
+    ~Simulator();
+    Simulator(const Simulator&) = delete;
+    Simulator& operator=(const Simulator&) = delete;
+
+    // Generates the city, then runs config.hours of simulated time, printing
+    // one JSON line per simulated hour and a summary line at the end
+    void run();
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include "TripRequestStream.h"
+#include <cmath>
+
+namespace {
+
+const double MS_PER_HOUR = 3600.0 * 1000.0;
+const int MAX_DROPOFF_DRAWS = 8;
+const double KM_PER_DEG_LAT = 111.0;
+const double KM_PER_DEG_LON = 84.2;
+
+// Commuter day: quiet nights, morning and evening peaks, a lunch bump
+const double COMMUTER_DAY[24] = {0.30, 0.20, 0.15, 0.15, 0.20, 0.40, 0.90, 1.70, 2.00, 1.40, 1.00, 1.00,
+                                 1.20, 1.10, 1.00, 1.10, 1.50, 1.90, 2.00, 1.50, 1.10, 0.90, 0.70, 0.50};
+
+} // namespace
+
+DemandProfile TripRequestStream::defaultProfile() {
+    DemandProfile profile;
+    profile.requestsPerHour = 2000.0;
+    for (int h = 0; h < 24; ++h) profile.hourlyShape[h] = COMMUTER_DAY[h];
+    profile.homePickupShare = 0.3;
+    profile.pooledShare = 0.15;
+    profile.priorityShare = 0.05;
+    profile.minTripKm = 1.0;
+    return profile;
+}
+
+TripRequestStream::TripRequestStream(const GeneratedCity& city, const DemandProfile& profile,
+                                     unsigned long long seed)
+    : city(city), profile(profile), rng(seed), cumulative(new double[city.numNodes]), nowMs(0.0) {
+    CityGenerator::buildPopularityTable(city, cumulative);
+    double peak = 0.0;
+    for (int h = 0; h < 24; ++h) peak = profile.hourlyShape[h] > peak ? profile.hourlyShape[h] : peak;
+    peakRatePerMs = profile.requestsPerHour * peak / MS_PER_HOUR;
+}
+
+TripRequestStream::~TripRequestStream() {
+    delete[] cumulative;
+}
+
+void TripRequestStream::next(TripRequestSpec& out) {
+    // Thinning: candidates arrive at the peak rate and are kept with
+    // probability rate(t) / peak
+    if (peakRatePerMs > 0.0) {
+        while (true) {
+            nowMs += rng.nextExponential(1.0 / peakRatePerMs);
+            int hour = static_cast<int>(std::fmod(nowMs / MS_PER_HOUR, 24.0));
+            double rate = profile.requestsPerHour * profile.hourlyShape[hour] / MS_PER_HOUR;
+            if (rng.nextDouble() * peakRatePerMs < rate) break;
+        }
+    }
+    out.atMs = static_cast<long long>(nowMs);
+
+    out.riderId = city.numRiders > 0 ? rng.nextInt(city.numRiders) + 1 : 1;
+    if (city.numRiders > 0 && rng.chance(profile.homePickupShare)) out.pickupId = city.riderLocation[out.riderId - 1];
+    else out.pickupId = CityGenerator::samplePopularNode(cumulative, city.numNodes, rng) + 1;
+
+    // Redraw dropoffs that are a short walk away; give up after a few
+    // draws so tiny cities still produce trips
+    int dropIdx = 0;
+    for (int attempt = 0; attempt < MAX_DROPOFF_DRAWS; ++attempt) {
+        dropIdx = CityGenerator::samplePopularNode(cumulative, city.numNodes, rng);
+        double dy = (city.lat[dropIdx] - city.lat[out.pickupId - 1]) * KM_PER_DEG_LAT;
+        double dx = (city.lon[dropIdx] - city.lon[out.pickupId - 1]) * KM_PER_DEG_LON;
+        if (dropIdx + 1 != out.pickupId && std::sqrt(dx * dx + dy * dy) >= profile.minTripKm) break;
+    }
+    out.dropoffId = dropIdx + 1 != out.pickupId ? dropIdx + 1 : (dropIdx + 1) % city.numNodes + 1;
+    out.priority = rng.chance(profile.priorityShare) ? 1 : 0;
+    out.pooled = rng.chance(profile.pooledShare);
+}
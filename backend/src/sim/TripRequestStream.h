@@ -0,0 +1,48 @@
+#ifndef TRIP_REQUEST_STREAM_H
+#define TRIP_REQUEST_STREAM_H
+
+#include "CityGenerator.h"
+
+struct DemandProfile {
+    double requestsPerHour;      // daily average
+    double hourlyShape[24];      // multiplier per hour of day; averages to ~1
+    double homePickupShare;      // requests picked up at the rider's own location
+    double pooledShare;
+    double priorityShare;        // requests with priority 1
+    double minTripKm;            // dropoffs closer than this (straight line) are redrawn
+};
+
+struct TripRequestSpec {
+    long long atMs;              // since the start of the stream
+    int riderId;
+    int pickupId;
+    int dropoffId;
+    int priority;
+    bool pooled;
+};
+
+// Seeded Poisson stream of trip requests over a GeneratedCity. Arrivals
+// follow the profile's hour-of-day curve (non-homogeneous Poisson by
+// thinning); pickups and dropoffs are drawn by node popularity.
+class TripRequestStream {
+private:
+    const GeneratedCity& city;
+    DemandProfile profile;
+    SimRng rng;
+    double* cumulative;
+    double peakRatePerMs;
+    double nowMs;
+
+public:
+    static DemandProfile defaultProfile();
+
+    TripRequestStream(const GeneratedCity& city, const DemandProfile& profile, unsigned long long seed);
+    ~TripRequestStream();
+    TripRequestStream(const TripRequestStream&) = delete;
+    TripRequestStream& operator=(const TripRequestStream&) = delete;
+
+    // Next request in time order; the stream is unbounded
+    void next(TripRequestSpec& out);
+};
+
+#endif
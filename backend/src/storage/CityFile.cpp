@@ -0,0 +1,161 @@
+#include "CityFile.h"
+#include "../core/Driver.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'R', 'S', 'C', 'G'};
+const int HEADER_SIZE = 8 + 5 * 4;
+const int NODE_SIZE = 8 + 8 + 8 + 4;
+const int EDGE_SIZE = 12;
+const int DRIVER_SIZE = 5;
+const int RIDER_SIZE = 4;
+
+void putU32(unsigned char* p, unsigned v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+void putF64(unsigned char* p, double d) {
+    unsigned long long v;
+    std::memcpy(&v, &d, sizeof(v));
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+unsigned getU32(const unsigned char* p) {
+    unsigned v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<unsigned>(p[i]) << (8 * i);
+    return v;
+}
+
+double getF64(const unsigned char* p) {
+    unsigned long long v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<unsigned long long>(p[i]) << (8 * i);
+    double d;
+    std::memcpy(&d, &v, sizeof(d));
+    return d;
+}
+
+} // namespace
+
+bool CityFile::write(const std::string& path, const GeneratedCity& city) {
+    size_t zoneBytes = 0;
+    for (int z = 0; z < city.numZones; ++z) zoneBytes += 2 + city.zoneNames[z].size();
+    size_t bytes = HEADER_SIZE + zoneBytes + static_cast<size_t>(city.numNodes) * NODE_SIZE +
+                   static_cast<size_t>(city.numEdges) * EDGE_SIZE + static_cast<size_t>(city.numDrivers) * DRIVER_SIZE +
+                   static_cast<size_t>(city.numRiders) * RIDER_SIZE;
+
+    unsigned char* buffer = new unsigned char[bytes];
+    unsigned char* p = buffer;
+    std::memcpy(p, MAGIC, 4);
+    putU32(p + 4, FORMAT_VERSION);
+    putU32(p + 8, static_cast<unsigned>(city.numNodes));
+    putU32(p + 12, static_cast<unsigned>(city.numZones));
+    putU32(p + 16, static_cast<unsigned>(city.numEdges));
+    putU32(p + 20, static_cast<unsigned>(city.numDrivers));
+    putU32(p + 24, static_cast<unsigned>(city.numRiders));
+    p += HEADER_SIZE;
+
+    for (int z = 0; z < city.numZones; ++z) {
+        const std::string& name = city.zoneNames[z];
+        p[0] = static_cast<unsigned char>(name.size());
+        p[1] = static_cast<unsigned char>(name.size() >> 8);
+        std::memcpy(p + 2, name.data(), name.size());
+        p += 2 + name.size();
+    }
+    for (int i = 0; i < city.numNodes; ++i, p += NODE_SIZE) {
+        putF64(p, city.lat[i]);
+        putF64(p + 8, city.lon[i]);
+        putF64(p + 16, city.popularity[i]);
+        putU32(p + 24, static_cast<unsigned>(city.zone[i]));
+    }
+    for (int e = 0; e < city.numEdges; ++e, p += EDGE_SIZE) {
+        putU32(p, static_cast<unsigned>(city.edgeFrom[e]));
+        putU32(p + 4, static_cast<unsigned>(city.edgeTo[e]));
+        putU32(p + 8, static_cast<unsigned>(city.edgeWeight[e]));
+    }
+    for (int d = 0; d < city.numDrivers; ++d, p += DRIVER_SIZE) {
+        putU32(p, static_cast<unsigned>(city.driverLocation[d]));
+        p[4] = city.driverClass[d];
+    }
+    for (int r = 0; r < city.numRiders; ++r, p += RIDER_SIZE) {
+        putU32(p, static_cast<unsigned>(city.riderLocation[r]));
+    }
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    bool ok = f && std::fwrite(buffer, 1, bytes, f) == bytes;
+    if (f) ok = (std::fclose(f) == 0) && ok;
+    delete[] buffer;
+    return ok;
+}
+
+bool CityFile::read(const std::string& path, GeneratedCity& out) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    if (size < HEADER_SIZE) {
+        std::fclose(f);
+        return false;
+    }
+    unsigned char* buffer = new unsigned char[size];
+    bool ok = std::fread(buffer, 1, size, f) == static_cast<size_t>(size);
+    std::fclose(f);
+    if (!ok || std::memcmp(buffer, MAGIC, 4) != 0 || getU32(buffer + 4) != FORMAT_VERSION) {
+        delete[] buffer;
+        return false;
+    }
+
+    int numNodes = static_cast<int>(getU32(buffer + 8));
+    int numZones = static_cast<int>(getU32(buffer + 12));
+    int numEdges = static_cast<int>(getU32(buffer + 16));
+    int numDrivers = static_cast<int>(getU32(buffer + 20));
+    int numRiders = static_cast<int>(getU32(buffer + 24));
+    out.reset(numNodes, numZones, numEdges, numDrivers, numRiders);
+
+    const unsigned char* p = buffer + HEADER_SIZE;
+    const unsigned char* end = buffer + size;
+    for (int z = 0; z < numZones && ok; ++z) {
+        if (end - p < 2) {
+            ok = false;
+            break;
+        }
+        size_t length = p[0] | (static_cast<size_t>(p[1]) << 8);
+        if (static_cast<size_t>(end - p - 2) < length) {
+            ok = false;
+            break;
+        }
+        out.zoneNames[z].assign(reinterpret_cast<const char*>(p + 2), length);
+        p += 2 + length;
+    }
+    size_t remaining = static_cast<size_t>(numNodes) * NODE_SIZE + static_cast<size_t>(numEdges) * EDGE_SIZE +
+                       static_cast<size_t>(numDrivers) * DRIVER_SIZE + static_cast<size_t>(numRiders) * RIDER_SIZE;
+    if (!ok || static_cast<size_t>(end - p) != remaining) {
+        delete[] buffer;
+        out.reset(0, 0, 0, 0, 0);
+        return false;
+    }
+
+    for (int i = 0; i < numNodes; ++i, p += NODE_SIZE) {
+        out.lat[i] = getF64(p);
+        out.lon[i] = getF64(p + 8);
+        out.popularity[i] = getF64(p + 16);
+        out.zone[i] = static_cast<int>(getU32(p + 24));
+        if (out.zone[i] < 0 || out.zone[i] >= numZones) ok = false;
+    }
+    for (int e = 0; e < numEdges; ++e, p += EDGE_SIZE) {
+        out.addEdge(static_cast<int>(getU32(p)), static_cast<int>(getU32(p + 4)), static_cast<int>(getU32(p + 8)));
+    }
+    for (int d = 0; d < numDrivers; ++d, p += DRIVER_SIZE) {
+        out.driverLocation[d] = static_cast<int>(getU32(p));
+        out.driverClass[d] = p[4];
+        if (p[4] > static_cast<unsigned char>(VehicleClass::XL)) ok = false;
+    }
+    for (int r = 0; r < numRiders; ++r, p += RIDER_SIZE) {
+        out.riderLocation[r] = static_cast<int>(getU32(p));
+    }
+    delete[] buffer;
+    if (!ok) out.reset(0, 0, 0, 0, 0);
+    return ok;
+}
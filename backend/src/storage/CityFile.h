@@ -0,0 +1,28 @@
+#ifndef CITY_FILE_H
+#define CITY_FILE_H
+
+#include "../sim/CityGenerator.h"
+#include <string>
+
+// Binary snapshot of a GeneratedCity (graph, zones, popularity and fleet),
+// so load tests and simulations can reuse the exact same city without
+// regenerating it.
+//
+// File layout, little-endian: 8-byte header ("RSCG", u32 version), then
+//   u32 numNodes, u32 numZones, u32 numEdges, u32 numDrivers, u32 numRiders
+//   zones:   u16 length + name bytes
+//   nodes:   f64 lat, f64 lon, f64 popularity, u32 zone
+//   edges:   u32 from, u32 to, u32 weight (node ids)
+//   drivers: u32 location, u8 vehicle class
+//   riders:  u32 location
+class CityFile {
+public:
+    static const unsigned FORMAT_VERSION = 1;
+
+    static bool write(const std::string& path, const GeneratedCity& city);
+    // Replaces the contents of `out`; returns false on I/O error or a
+    // malformed file
+    static bool read(const std::string& path, GeneratedCity& out);
+};
+
+#endif
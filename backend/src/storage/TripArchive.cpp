@@ -0,0 +1,197 @@
+#include "TripArchive.h"
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'R', 'S', 'T', 'A'};
+
+void putU32(unsigned char* p, unsigned v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+void putU64(unsigned char* p, unsigned long long v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+unsigned getU32(const unsigned char* p) {
+    unsigned v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<unsigned>(p[i]) << (8 * i);
+    return v;
+}
+
+unsigned long long getU64(const unsigned char* p) {
+    unsigned long long v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<unsigned long long>(p[i]) << (8 * i);
+    return v;
+}
+
+int recordSize(unsigned version) {
+    return version == 1 ? TripArchive::RECORD_SIZE_V1 : TripArchive::RECORD_SIZE;
+}
+
+bool knownVersion(unsigned version) {
+    return version == 1 || version == TripArchive::FORMAT_VERSION;
+}
+
+void encodeRecord(const ArchivedTrip& r, unsigned version, unsigned char* p) {
+    unsigned long long distanceBits;
+    std::memcpy(&distanceBits, &r.distance, sizeof(distanceBits));
+
+    putU32(p, static_cast<unsigned>(r.id));
+    putU32(p + 4, static_cast<unsigned>(r.riderId));
+    putU32(p + 8, static_cast<unsigned>(r.driverId));
+    putU32(p + 12, static_cast<unsigned>(r.pickupLocationId));
+    putU32(p + 16, static_cast<unsigned>(r.dropoffLocationId));
+    putU32(p + 20, static_cast<unsigned>(r.pickupZoneId));
+    putU32(p + 24, static_cast<unsigned>(r.pickupDistance));
+    p[28] = static_cast<unsigned char>(r.status);
+    putU64(p + 29, distanceBits);
+    putU64(p + 37, static_cast<unsigned long long>(r.requestedAt));
+    putU64(p + 45, static_cast<unsigned long long>(r.finishedAt));
+    if (version >= 2) {
+        unsigned long long fareBits;
+        std::memcpy(&fareBits, &r.fare, sizeof(fareBits));
+        putU64(p + 53, fareBits);
+    }
+}
+
+void decodeRecord(const unsigned char* p, unsigned version, ArchivedTrip& r) {
+    unsigned long long distanceBits = getU64(p + 29);
+
+    r.id = static_cast<int>(getU32(p));
+    r.riderId = static_cast<int>(getU32(p + 4));
+    r.driverId = static_cast<int>(getU32(p + 8));
+    r.pickupLocationId = static_cast<int>(getU32(p + 12));
+    r.dropoffLocationId = static_cast<int>(getU32(p + 16));
+    r.pickupZoneId = static_cast<int>(getU32(p + 20));
+    r.pickupDistance = static_cast<int>(getU32(p + 24));
+    r.status = static_cast<TripStatus>(p[28]);
+    std::memcpy(&r.distance, &distanceBits, sizeof(r.distance));
+    r.requestedAt = static_cast<long long>(getU64(p + 37));
+    r.finishedAt = static_cast<long long>(getU64(p + 45));
+    r.fare = 0.0;
+    if (version >= 2) {
+        unsigned long long fareBits = getU64(p + 53);
+        std::memcpy(&r.fare, &fareBits, sizeof(r.fare));
+    }
+}
+
+// Version of an existing segment file: 0 if it is missing or empty, -1 if it
+// is not a segment file this code understands
+long long segmentVersion(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return 0;
+    unsigned char header[8];
+    size_t n = std::fread(header, 1, sizeof(header), f);
+    std::fclose(f);
+    if (n == 0) return 0;
+    if (n != sizeof(header) || std::memcmp(header, MAGIC, 4) != 0 || !knownVersion(getU32(header + 4))) return -1;
+    return getU32(header + 4);
+}
+
+} // namespace
+
+TripArchive::TripArchive(int cap)
+    : numRecords(0), capacity(cap > 0 ? cap : 1), totalArchived(0), totalFlushed(0) {
+    records = new ArchivedTrip[capacity];
+}
+
+TripArchive::~TripArchive() {
+    delete[] records;
+}
+
+const ArchivedTrip& TripArchive::append(const Trip& trip) {
+    if (numRecords == capacity && !flush()) {
+        // No file to spill into (or the write failed): keep growing in memory
+        ArchivedTrip* next = new ArchivedTrip[capacity * 2];
+        std::memcpy(next, records, sizeof(ArchivedTrip) * numRecords);
+        delete[] records;
+        records = next;
+        capacity *= 2;
+    }
+
+    ArchivedTrip& r = records[numRecords++];
+    r.id = trip.getId();
+    r.riderId = trip.getRiderId();
+    r.driverId = trip.getDriverId();
+    r.pickupLocationId = trip.getPickupLocationId();
+    r.dropoffLocationId = trip.getDropoffLocationId();
+    r.pickupZoneId = trip.getPickupZoneId();
+    r.pickupDistance = trip.getPickupDistance();
+    r.status = trip.getStatus();
+    r.distance = trip.getDistance();
+    r.requestedAt = trip.getRequestedAt();
+    r.finishedAt = trip.getFinishedAt();
+    r.fare = trip.getFare();
+    totalArchived++;
+    return r;
+}
+
+bool TripArchive::flush() {
+    if (filePath.empty()) return false;
+    if (numRecords == 0) return true;
+
+    // Records follow the format of the file they are appended to
+    long long existing = segmentVersion(filePath);
+    if (existing < 0) return false;
+    unsigned version = existing > 0 ? static_cast<unsigned>(existing) : FORMAT_VERSION;
+    int size = recordSize(version);
+
+    FILE* f = std::fopen(filePath.c_str(), "ab");
+    if (!f) return false;
+
+    bool ok = true;
+    if (std::ftell(f) == 0) {
+        unsigned char header[8];
+        std::memcpy(header, MAGIC, 4);
+        putU32(header + 4, version);
+        ok = std::fwrite(header, 1, sizeof(header), f) == sizeof(header);
+    }
+
+    unsigned char* buffer = new unsigned char[static_cast<size_t>(numRecords) * size];
+    for (int i = 0; i < numRecords; ++i) encodeRecord(records[i], version, buffer + static_cast<size_t>(i) * size);
+    size_t bytes = static_cast<size_t>(numRecords) * size;
+    ok = ok && std::fwrite(buffer, 1, bytes, f) == bytes;
+    delete[] buffer;
+
+    ok = (std::fclose(f) == 0) && ok;
+    if (ok) {
+        totalFlushed += numRecords;
+        numRecords = 0;
+    }
+    return ok;
+}
+
+int TripArchive::readFile(const std::string& path, ArchivedTrip*& out) {
+    out = nullptr;
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return -1;
+
+    unsigned char header[8];
+    if (std::fread(header, 1, sizeof(header), f) != sizeof(header) ||
+        std::memcmp(header, MAGIC, 4) != 0 || !knownVersion(getU32(header + 4))) {
+        std::fclose(f);
+        return -1;
+    }
+    unsigned version = getU32(header + 4);
+    int size = recordSize(version);
+
+    std::fseek(f, 0, SEEK_END);
+    long payload = std::ftell(f) - static_cast<long>(sizeof(header));
+    std::fseek(f, sizeof(header), SEEK_SET);
+
+    int count = static_cast<int>(payload / size);
+    out = new ArchivedTrip[count > 0 ? count : 1];
+    unsigned char record[RECORD_SIZE];
+    for (int i = 0; i < count; ++i) {
+        if (std::fread(record, 1, size, f) != static_cast<size_t>(size)) {
+            count = i;
+            break;
+        }
+        decodeRecord(record, version, out[i]);
+    }
+
+    std::fclose(f);
+    return count;
+}
@@ -0,0 +1,63 @@
+#ifndef TRIP_ARCHIVE_H
+#define TRIP_ARCHIVE_H
+
+#include "../core/Trip.h"
+#include <string>
+
+struct ArchivedTrip {
+    int id;
+    int riderId;
+    int driverId;
+    int pickupLocationId;
+    int dropoffLocationId;
+    int pickupZoneId;
+    int pickupDistance;
+    TripStatus status;
+    double distance;
+    long long requestedAt;
+    long long finishedAt;
+    double fare;
+};
+
+// Append-only segment of terminal trips. Records accumulate in memory and are
+// appended to the segment file on flush (or automatically once the in-memory
+// segment is full and a file path is configured).
+//
+// File layout: 8-byte header ("RSTA", u32 version) followed by fixed-size
+// little-endian records of RECORD_SIZE bytes. Version 1 records are
+// RECORD_SIZE_V1 bytes and carry no fare; such files are still read (fare 0)
+// and appended to in their own format.
+class TripArchive {
+private:
+    ArchivedTrip* records;
+    int numRecords;
+    int capacity;
+    long long totalArchived;
+    long long totalFlushed;
+    std::string filePath;
+
+public:
+    static const int RECORD_SIZE = 61;
+    static const int RECORD_SIZE_V1 = 53;
+    static const unsigned FORMAT_VERSION = 2;
+
+    TripArchive(int cap = 4096);
+    ~TripArchive();
+
+    void setFilePath(const std::string& path) { filePath = path; }
+    const std::string& getFilePath() const { return filePath; }
+
+    const ArchivedTrip& append(const Trip& trip);
+    bool flush();
+
+    int size() const { return numRecords; }
+    const ArchivedTrip& get(int i) const { return records[i]; }
+    long long getTotalArchived() const { return totalArchived; }
+    long long getTotalFlushed() const { return totalFlushed; }
+
+    // Reads every record of a segment file into a newly allocated array
+    // (caller frees with delete[]). Returns the record count or -1 on error.
+    static int readFile(const std::string& path, ArchivedTrip*& out);
+};
+
+#endif
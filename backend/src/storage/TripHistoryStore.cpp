@@ -0,0 +1,477 @@
+#include "TripHistoryStore.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'R', 'S', 'T', 'H'};
+const unsigned FORMAT_VERSION = 1;
+const int CHUNK_HEADER_SIZE = 1 + 1 + 8 + 8 + 4;
+
+enum ColumnEncoding {
+    ENC_VARINT = 0,
+    ENC_DELTA = 1,
+    ENC_RLE = 2
+};
+
+unsigned long long zigzag(long long v) {
+    return (static_cast<unsigned long long>(v) << 1) ^ static_cast<unsigned long long>(v >> 63);
+}
+
+long long unzigzag(unsigned long long v) {
+    return static_cast<long long>(v >> 1) ^ -static_cast<long long>(v & 1);
+}
+
+int putVarint(unsigned char* p, unsigned long long v) {
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = static_cast<unsigned char>(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = static_cast<unsigned char>(v);
+    return n;
+}
+
+// Reads one varint from [p, end); false if it runs past end or is over-long
+bool getVarint(const unsigned char*& p, const unsigned char* end, unsigned long long& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char byte = *p++;
+        v |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void putU32(unsigned char* p, unsigned v) {
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+void putI64(unsigned char* p, long long v) {
+    unsigned long long u = static_cast<unsigned long long>(v);
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<unsigned char>(u >> (8 * i));
+}
+
+unsigned getU32(const unsigned char* p) {
+    unsigned v = 0;
+    for (int i = 0; i < 4; ++i) v |= static_cast<unsigned>(p[i]) << (8 * i);
+    return v;
+}
+
+long long getI64(const unsigned char* p) {
+    unsigned long long v = 0;
+    for (int i = 0; i < 8; ++i) v |= static_cast<unsigned long long>(p[i]) << (8 * i);
+    return static_cast<long long>(v);
+}
+
+int encodeVarint(const long long* values, int rows, unsigned char* out) {
+    int n = 0;
+    for (int i = 0; i < rows; ++i) n += putVarint(out + n, zigzag(values[i]));
+    return n;
+}
+
+int encodeDelta(const long long* values, int rows, unsigned char* out) {
+    int n = 0;
+    long long prev = 0;
+    for (int i = 0; i < rows; ++i) {
+        n += putVarint(out + n, zigzag(values[i] - prev));
+        prev = values[i];
+    }
+    return n;
+}
+
+int encodeRle(const long long* values, int rows, unsigned char* out) {
+    int n = 0;
+    int i = 0;
+    while (i < rows) {
+        int run = 1;
+        while (i + run < rows && values[i + run] == values[i]) run++;
+        n += putVarint(out + n, zigzag(values[i]));
+        n += putVarint(out + n, static_cast<unsigned long long>(run));
+        i += run;
+    }
+    return n;
+}
+
+// Decodes rows values from a chunk payload of the given size. Returns false
+// if the payload is truncated or malformed.
+bool decodeChunk(int encoding, long long min, long long max, const unsigned char* p, unsigned bytes, int rows,
+                 long long* out) {
+    if (min == max) {
+        for (int i = 0; i < rows; ++i) out[i] = min;
+        return true;
+    }
+    const unsigned char* end = p + bytes;
+    unsigned long long v;
+    if (encoding == ENC_VARINT) {
+        for (int i = 0; i < rows; ++i) {
+            if (!getVarint(p, end, v)) return false;
+            out[i] = unzigzag(v);
+        }
+    } else if (encoding == ENC_DELTA) {
+        long long prev = 0;
+        for (int i = 0; i < rows; ++i) {
+            if (!getVarint(p, end, v)) return false;
+            prev += unzigzag(v);
+            out[i] = prev;
+        }
+    } else if (encoding == ENC_RLE) {
+        int i = 0;
+        while (i < rows) {
+            unsigned long long run;
+            if (!getVarint(p, end, v) || !getVarint(p, end, run) || run == 0) return false;
+            long long value = unzigzag(v);
+            int stop = run < static_cast<unsigned long long>(rows - i) ? i + static_cast<int>(run) : rows;
+            for (; i < stop; ++i) out[i] = value;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void fillRow(long long* const* columns, int row, const ArchivedTrip& t) {
+    columns[COL_ID][row] = t.id;
+    columns[COL_RIDER][row] = t.riderId;
+    columns[COL_DRIVER][row] = t.driverId;
+    columns[COL_PICKUP][row] = t.pickupLocationId;
+    columns[COL_DROPOFF][row] = t.dropoffLocationId;
+    columns[COL_ZONE][row] = t.pickupZoneId;
+    columns[COL_STATUS][row] = static_cast<long long>(t.status);
+    columns[COL_REQUESTED_AT][row] = t.requestedAt;
+    columns[COL_FINISHED_AT][row] = t.finishedAt;
+    columns[COL_PICKUP_DISTANCE][row] = t.pickupDistance;
+    columns[COL_DISTANCE][row] = std::llround(t.distance * 100.0);
+    columns[COL_FARE][row] = std::llround(t.fare * 100.0);
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Writer
+
+TripHistoryWriter::TripHistoryWriter(int rows)
+    : blockRows(rows > 0 ? rows : 1), numBuffered(0), capacity(blockRows), totalWritten(0) {
+    for (int c = 0; c < NUM_TRIP_COLUMNS; ++c) columns[c] = new long long[capacity];
+}
+
+TripHistoryWriter::~TripHistoryWriter() {
+    for (int c = 0; c < NUM_TRIP_COLUMNS; ++c) delete[] columns[c];
+}
+
+bool TripHistoryWriter::append(const ArchivedTrip& trip) {
+    if (numBuffered == capacity && !flush()) {
+        // No file to spill into (or the write failed): keep growing in memory
+        for (int c = 0; c < NUM_TRIP_COLUMNS; ++c) {
+            long long* next = new long long[capacity * 2];
+            std::memcpy(next, columns[c], sizeof(long long) * numBuffered);
+            delete[] columns[c];
+            columns[c] = next;
+        }
+        capacity *= 2;
+    }
+
+    fillRow(columns, numBuffered++, trip);
+    if (numBuffered == blockRows) return flush();
+    return numBuffered < blockRows;
+}
+
+bool TripHistoryWriter::flush() {
+    if (numBuffered == 0) return true;
+    if (filePath.empty()) return false;
+
+    int rows = numBuffered;
+    size_t maxChunk = static_cast<size_t>(rows) * 20;
+    unsigned char* block = new unsigned char[5 + NUM_TRIP_COLUMNS * (CHUNK_HEADER_SIZE + maxChunk)];
+    unsigned char* candidates[3];
+    for (int e = 0; e < 3; ++e) candidates[e] = new unsigned char[maxChunk];
+
+    size_t n = 0;
+    putU32(block, static_cast<unsigned>(rows));
+    block[4] = static_cast<unsigned char>(NUM_TRIP_COLUMNS);
+    n = 5;
+
+    for (int c = 0; c < NUM_TRIP_COLUMNS; ++c) {
+        const long long* values = columns[c];
+        long long min = values[0], max = values[0];
+        for (int i = 1; i < rows; ++i) {
+            if (values[i] < min) min = values[i];
+            if (values[i] > max) max = values[i];
+        }
+
+        int sizes[3];
+        sizes[ENC_VARINT] = encodeVarint(values, rows, candidates[ENC_VARINT]);
+        sizes[ENC_DELTA] = encodeDelta(values, rows, candidates[ENC_DELTA]);
+        sizes[ENC_RLE] = encodeRle(values, rows, candidates[ENC_RLE]);
+        int best = ENC_VARINT;
+        for (int e = 1; e < 3; ++e) {
+            if (sizes[e] < sizes[best]) best = e;
+        }
+        // Constant chunks are fully described by their stats
+        int bytes = (min == max) ? 0 : sizes[best];
+
+        block[n] = static_cast<unsigned char>(c);
+        block[n + 1] = static_cast<unsigned char>(best);
+        putI64(block + n + 2, min);
+        putI64(block + n + 10, max);
+        putU32(block + n + 18, static_cast<unsigned>(bytes));
+        n += CHUNK_HEADER_SIZE;
+        std::memcpy(block + n, candidates[best], bytes);
+        n += bytes;
+    }
+
+    bool ok = false;
+    FILE* f = std::fopen(filePath.c_str(), "ab");
+    if (f) {
+        ok = true;
+        if (std::ftell(f) == 0) {
+            unsigned char header[8];
+            std::memcpy(header, MAGIC, 4);
+            putU32(header + 4, FORMAT_VERSION);
+            ok = std::fwrite(header, 1, sizeof(header), f) == sizeof(header);
+        }
+        ok = ok && std::fwrite(block, 1, n, f) == n;
+        ok = (std::fclose(f) == 0) && ok;
+    }
+
+    for (int e = 0; e < 3; ++e) delete[] candidates[e];
+    delete[] block;
+
+    if (ok) {
+        totalWritten += rows;
+        numBuffered = 0;
+    }
+    return ok;
+}
+
+long long TripHistoryWriter::importArchive(const std::string& segmentPath) {
+    ArchivedTrip* records = nullptr;
+    int count = TripArchive::readFile(segmentPath, records);
+    if (count < 0) return -1;
+
+    bool ok = true;
+    for (int i = 0; i < count && ok; ++i) ok = append(records[i]);
+    ok = ok && flush();
+    delete[] records;
+    return ok ? count : -1;
+}
+
+// ---------------------------------------------------------------------------
+// Stats
+
+TripHistoryStats::TripHistoryStats()
+    : fromTime(0), numZones(0), numHours(0), tripsPerZoneHour(nullptr), trips(0), completed(0),
+      cancelled(0), pickupDistanceSum(0), pickupDistanceCount(0), blocksScanned(0), blocksSkipped(0) {}
+
+TripHistoryStats::~TripHistoryStats() {
+    delete[] tripsPerZoneHour;
+}
+
+double TripHistoryStats::averagePickupDistance() const {
+    return pickupDistanceCount > 0 ? static_cast<double>(pickupDistanceSum) / pickupDistanceCount : 0.0;
+}
+
+double TripHistoryStats::cancellationRate() const {
+    long long finished = completed + cancelled;
+    return finished > 0 ? static_cast<double>(cancelled) / finished : 0.0;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+
+TripHistoryReader::TripHistoryReader()
+    : fileData(nullptr), fileSize(0), blocks(nullptr), numBlocks(0), numRows(0) {}
+
+TripHistoryReader::~TripHistoryReader() {
+    delete[] fileData;
+    delete[] blocks;
+}
+
+bool TripHistoryReader::open(const std::string& path) {
+    delete[] fileData;
+    delete[] blocks;
+    fileData = nullptr;
+    blocks = nullptr;
+    numBlocks = 0;
+    numRows = 0;
+
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    std::fseek(f, 0, SEEK_END);
+    fileSize = std::ftell(f);
+    std::fseek(f, 0, SEEK_SET);
+    fileData = new unsigned char[fileSize > 0 ? fileSize : 1];
+    bool ok = std::fread(fileData, 1, fileSize, f) == static_cast<size_t>(fileSize);
+    std::fclose(f);
+
+    if (!ok || fileSize < 8 || std::memcmp(fileData, MAGIC, 4) != 0 || getU32(fileData + 4) != FORMAT_VERSION) {
+        return false;
+    }
+
+    // Index pass: record chunk positions and stats for every block
+    int blockCapacity = 16;
+    blocks = new Block[blockCapacity];
+    long pos = 8;
+    while (pos + 5 <= fileSize) {
+        if (numBlocks == blockCapacity) {
+            Block* next = new Block[blockCapacity * 2];
+            std::memcpy(next, blocks, sizeof(Block) * numBlocks);
+            delete[] blocks;
+            blocks = next;
+            blockCapacity *= 2;
+        }
+
+        Block& b = blocks[numBlocks];
+        std::memset(&b, 0, sizeof(Block));
+        unsigned rows = getU32(fileData + pos);
+        int numColumns = fileData[pos + 4];
+        if (rows == 0 || rows > 0x7FFFFFFFu) break;
+        b.rows = static_cast<int>(rows);
+        pos += 5;
+
+        bool truncated = false;
+        for (int c = 0; c < numColumns; ++c) {
+            if (pos + CHUNK_HEADER_SIZE > fileSize) { truncated = true; break; }
+            const unsigned char* h = fileData + pos;
+            unsigned bytes = getU32(h + 18);
+            if (pos + CHUNK_HEADER_SIZE + static_cast<long>(bytes) > fileSize) { truncated = true; break; }
+            if (h[1] > ENC_RLE) { truncated = true; break; }
+            if (h[0] < NUM_TRIP_COLUMNS) {
+                ColumnChunk& chunk = b.columns[h[0]];
+                chunk.encoding = h[1];
+                chunk.min = getI64(h + 2);
+                chunk.max = getI64(h + 10);
+                chunk.bytes = bytes;
+                chunk.data = h + CHUNK_HEADER_SIZE;
+            }
+            pos += CHUNK_HEADER_SIZE + bytes;
+        }
+        // Trip ids within a block are distinct, so the id chunk holds at
+        // least a byte per row; this bounds the row count of a corrupt block
+        const ColumnChunk& ids = b.columns[COL_ID];
+        if (truncated || (b.rows > 1 && ids.bytes < static_cast<unsigned>(b.rows))) break;
+
+        numRows += b.rows;
+        numBlocks++;
+    }
+    return true;
+}
+
+int TripHistoryReader::getNumZones() const {
+    long long maxZone = -1;
+    for (int i = 0; i < numBlocks; ++i) {
+        if (blocks[i].columns[COL_ZONE].max > maxZone) maxZone = blocks[i].columns[COL_ZONE].max;
+    }
+    return static_cast<int>(maxZone + 1);
+}
+
+long long TripHistoryReader::scan(long long fromTime, long long toTime, unsigned columnMask,
+                                  TripBatchVisitor visit, void* ctx, TripHistoryStats* stats) const {
+    int maxRows = 0;
+    for (int i = 0; i < numBlocks; ++i) {
+        if (blocks[i].rows > maxRows) maxRows = blocks[i].rows;
+    }
+    if (maxRows == 0) return 0;
+
+    columnMask |= columnBit(COL_REQUESTED_AT);
+    long long* scratch[NUM_TRIP_COLUMNS];
+    for (int c = 0; c < NUM_TRIP_COLUMNS; ++c) {
+        scratch[c] = (columnMask & (1u << c)) ? new long long[maxRows] : nullptr;
+    }
+
+    long long visited = 0;
+    for (int i = 0; i < numBlocks; ++i) {
+        const Block& b = blocks[i];
+        const ColumnChunk& time = b.columns[COL_REQUESTED_AT];
+        if (time.max < fromTime || time.min >= toTime) {
+            if (stats) stats->blocksSkipped++;
+            continue;
+        }
+        if (stats) stats->blocksScanned++;
+
+        bool decoded = true;
+        for (int c = 0; c < NUM_TRIP_COLUMNS && decoded; ++c) {
+            if (!scratch[c]) continue;
+            const ColumnChunk& chunk = b.columns[c];
+            if (!chunk.data) {
+                for (int r = 0; r < b.rows; ++r) scratch[c][r] = 0;
+                continue;
+            }
+            decoded = decodeChunk(chunk.encoding, chunk.min, chunk.max, chunk.data, chunk.bytes, b.rows, scratch[c]);
+        }
+        if (!decoded) continue;  // corrupt chunk payload
+
+        int rows = b.rows;
+        if (time.min < fromTime || time.max >= toTime) {
+            // Block straddles the range: keep only matching rows
+            const long long* t = scratch[COL_REQUESTED_AT];
+            int kept = 0;
+            for (int r = 0; r < rows; ++r) {
+                if (t[r] < fromTime || t[r] >= toTime) continue;
+                for (int c = 0; c < NUM_TRIP_COLUMNS; ++c) {
+                    if (scratch[c] && c != COL_REQUESTED_AT) scratch[c][kept] = scratch[c][r];
+                }
+                scratch[COL_REQUESTED_AT][kept] = t[r];
+                kept++;
+            }
+            rows = kept;
+        }
+        if (rows == 0) continue;
+
+        TripColumnBatch batch;
+        batch.rows = rows;
+        for (int c = 0; c < NUM_TRIP_COLUMNS; ++c) batch.values[c] = scratch[c];
+        visit(batch, ctx);
+        visited += rows;
+    }
+
+    for (int c = 0; c < NUM_TRIP_COLUMNS; ++c) delete[] scratch[c];
+    return visited;
+}
+
+namespace {
+
+void aggregateBatch(const TripColumnBatch& batch, void* ctx) {
+    TripHistoryStats& s = *static_cast<TripHistoryStats*>(ctx);
+    const long long* time = batch.values[COL_REQUESTED_AT];
+    const long long* zone = batch.values[COL_ZONE];
+    const long long* status = batch.values[COL_STATUS];
+    const long long* pickup = batch.values[COL_PICKUP_DISTANCE];
+    const long long completedCode = static_cast<long long>(TripStatus::COMPLETED);
+    const long long cancelledCode = static_cast<long long>(TripStatus::CANCELLED);
+
+    for (int r = 0; r < batch.rows; ++r) {
+        int hour = static_cast<int>((time[r] - s.fromTime) / 3600000LL);
+        if (zone[r] >= 0 && zone[r] < s.numZones) {
+            s.tripsPerZoneHour[zone[r] * s.numHours + hour]++;
+        }
+        s.completed += status[r] == completedCode;
+        s.cancelled += status[r] == cancelledCode;
+        if (pickup[r] >= 0) {
+            s.pickupDistanceSum += pickup[r];
+            s.pickupDistanceCount++;
+        }
+    }
+    s.trips += batch.rows;
+}
+
+} // namespace
+
+bool TripHistoryReader::aggregate(long long fromTime, long long toTime, TripHistoryStats& out) const {
+    if (toTime <= fromTime) return false;
+
+    delete[] out.tripsPerZoneHour;
+    out.trips = out.completed = out.cancelled = 0;
+    out.pickupDistanceSum = out.pickupDistanceCount = 0;
+    out.blocksScanned = out.blocksSkipped = 0;
+    out.fromTime = fromTime;
+    out.numZones = getNumZones();
+    out.numHours = static_cast<int>((toTime - fromTime + 3599999LL) / 3600000LL);
+    long long cells = static_cast<long long>(out.numZones) * out.numHours;
+    out.tripsPerZoneHour = new long long[cells > 0 ? cells : 1]();
+
+    unsigned mask = columnBit(COL_ZONE) | columnBit(COL_STATUS) | columnBit(COL_PICKUP_DISTANCE);
+    scan(fromTime, toTime, mask, aggregateBatch, &out, &out);
+    return true;
+}
@@ -0,0 +1,140 @@
+#ifndef TRIP_HISTORY_STORE_H
+#define TRIP_HISTORY_STORE_H
+
+#include "TripArchive.h"
+#include <string>
+
+// Append-only columnar file for historical trips.
+//
+// File layout: 8-byte header ("RSTH", u32 version) followed by blocks of up to
+// blockRows trips. Each block stores every column as an independent chunk:
+//   u32 rowCount, u8 numColumns,
+//   per column: u8 columnId, u8 encoding, i64 min, i64 max, u32 bytes, payload
+// Each chunk uses whichever of plain varint, delta varint or run-length
+// encoding is smallest for that block. Min/max stats let scans skip blocks.
+// Readers ignore column ids they do not know, and a column missing from a
+// block (written before it existed) reads as zeros.
+
+enum TripColumn {
+    COL_ID,
+    COL_RIDER,
+    COL_DRIVER,
+    COL_PICKUP,
+    COL_DROPOFF,
+    COL_ZONE,
+    COL_STATUS,
+    COL_REQUESTED_AT,
+    COL_FINISHED_AT,
+    COL_PICKUP_DISTANCE,
+    COL_DISTANCE,       // fixed point, hundredths
+    COL_FARE,           // fixed point, hundredths
+    NUM_TRIP_COLUMNS
+};
+
+inline unsigned columnBit(TripColumn c) { return 1u << c; }
+
+class TripHistoryWriter {
+private:
+    std::string filePath;
+    int blockRows;
+    int numBuffered;
+    int capacity;
+    long long* columns[NUM_TRIP_COLUMNS];
+    long long totalWritten;
+
+public:
+    TripHistoryWriter(int blockRows = 8192);
+    ~TripHistoryWriter();
+
+    void setFilePath(const std::string& path) { filePath = path; }
+    bool isOpen() const { return !filePath.empty(); }
+
+    // Buffers a trip; a block is written once blockRows trips are buffered.
+    // If that write fails the rows stay buffered (the buffer grows) and
+    // false is returned; a later append or flush retries.
+    bool append(const ArchivedTrip& trip);
+    // Writes any partially filled block
+    bool flush();
+    // Appends every record of a TripArchive segment file, e.g. to rebuild
+    // history after a crash lost a partially filled block. Returns the
+    // number of trips imported or -1 on error.
+    long long importArchive(const std::string& segmentPath);
+
+    int getBuffered() const { return numBuffered; }
+    long long getTotalWritten() const { return totalWritten; }
+};
+
+// Decoded column values for the rows of one block that fall inside a scan
+// range. Columns that were not requested are null.
+struct TripColumnBatch {
+    int rows;
+    const long long* values[NUM_TRIP_COLUMNS];
+};
+
+typedef void (*TripBatchVisitor)(const TripColumnBatch& batch, void* ctx);
+
+struct TripHistoryStats {
+    long long fromTime;
+    int numZones;
+    int numHours;
+    long long* tripsPerZoneHour;   // [zone * numHours + hour]
+
+    long long trips;
+    long long completed;
+    long long cancelled;
+    long long pickupDistanceSum;
+    long long pickupDistanceCount;
+    long long blocksScanned;
+    long long blocksSkipped;
+
+    TripHistoryStats();
+    ~TripHistoryStats();
+    TripHistoryStats(const TripHistoryStats&) = delete;
+    TripHistoryStats& operator=(const TripHistoryStats&) = delete;
+
+    long long getTrips(int zone, int hour) const { return tripsPerZoneHour[zone * numHours + hour]; }
+    double averagePickupDistance() const;
+    double cancellationRate() const;
+};
+
+class TripHistoryReader {
+private:
+    struct ColumnChunk {
+        int encoding;
+        long long min;
+        long long max;
+        const unsigned char* data;
+        unsigned bytes;
+    };
+
+    struct Block {
+        int rows;
+        ColumnChunk columns[NUM_TRIP_COLUMNS];
+    };
+
+    unsigned char* fileData;
+    long fileSize;
+    Block* blocks;
+    int numBlocks;
+    long long numRows;
+
+public:
+    TripHistoryReader();
+    ~TripHistoryReader();
+
+    bool open(const std::string& path);
+    int getNumBlocks() const { return numBlocks; }
+    long long getNumRows() const { return numRows; }
+    // Largest zone id stored in the file plus one
+    int getNumZones() const;
+
+    // Visits trips requested in [fromTime, toTime) block by block, decoding
+    // only the columns in columnMask. Returns the number of rows visited.
+    long long scan(long long fromTime, long long toTime, unsigned columnMask,
+                   TripBatchVisitor visit, void* ctx, TripHistoryStats* stats = nullptr) const;
+
+    // Trips per zone per hour, pickup distance and cancellation rate
+    bool aggregate(long long fromTime, long long toTime, TripHistoryStats& out) const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#include "EventBroadcaster.h"
+#include <chrono>
+
+EventBroadcaster::EventBroadcaster(RideShareSystem& system, int queueCapacity)
+    : queueCapacity(queueCapacity > 0 ? queueCapacity : 1), numActive(0), dropped(0), stopping(false) {
+    for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+        subscribers[i].active = false;
+        subscribers[i].ring = nullptr;
+    }
+    system.subscribeEvents(onEvent, this);
+}
+
+EventBroadcaster::~EventBroadcaster() {
+    stop();
+    for (int i = 0; i < MAX_SUBSCRIBERS; ++i) delete[] subscribers[i].ring;
+}
+
+void EventBroadcaster::onEvent(const StateEvent& event, void* ctx) {
+    EventBroadcaster* self = static_cast<EventBroadcaster*>(ctx);
+    if (self->numActive.load(std::memory_order_relaxed) == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(self->mutex);
+        for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+            Subscriber& sub = self->subscribers[i];
+            if (!sub.active) continue;
+            if (sub.size == self->queueCapacity) {
+                // Slow consumer: overwrite its oldest event
+                sub.head = (sub.head + 1) % self->queueCapacity;
+                sub.size--;
+                sub.dropped++;
+                self->dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            sub.ring[(sub.head + sub.size) % self->queueCapacity] = event;
+            sub.size++;
+        }
+    }
+    self->cv.notify_all();
+}
+
+int EventBroadcaster::open() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int i = 0; i < MAX_SUBSCRIBERS; ++i) {
+        Subscriber& sub = subscribers[i];
+        if (sub.active) continue;
+        if (!sub.ring) sub.ring = new StateEvent[queueCapacity];
+        sub.active = true;
+        sub.head = 0;
+        sub.size = 0;
+        sub.dropped = 0;
+        numActive.fetch_add(1, std::memory_order_relaxed);
+        return i;
+    }
+    return -1;
+}
+
+void EventBroadcaster::close(int id) {
+    if (id < 0 || id >= MAX_SUBSCRIBERS) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!subscribers[id].active) return;
+    subscribers[id].active = false;
+    numActive.fetch_sub(1, std::memory_order_relaxed);
+}
+
+int EventBroadcaster::wait(int id, StateEvent* out, int maxEvents, long long& lostEvents, int timeoutMs) {
+    lostEvents = 0;
+    if (id < 0 || id >= MAX_SUBSCRIBERS) return 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    Subscriber& sub = subscribers[id];
+    cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return stopping || !sub.active || sub.size > 0; });
+    if (!sub.active) return 0;
+
+    int count = sub.size < maxEvents ? sub.size : maxEvents;
+    for (int i = 0; i < count; ++i) out[i] = sub.ring[(sub.head + i) % queueCapacity];
+    sub.head = (sub.head + count) % queueCapacity;
+    sub.size -= count;
+    lostEvents = sub.dropped;
+    sub.dropped = 0;
+    return count;
+}
+
+void EventBroadcaster::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+}
@@ -0,0 +1,60 @@
+#ifndef EVENT_BROADCASTER_H
+#define EVENT_BROADCASTER_H
+
+#include "RideShareSystem.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+// Fans the system's state events out to streaming clients. Each subscriber
+// has its own bounded queue: one that falls behind loses its oldest events
+// instead of slowing the event loop, and is told how many it lost so it can
+// resync. Must be created before the system's event loop starts and outlive
+// it (the bus has no unsubscribe).
+class EventBroadcaster {
+public:
+    static const int MAX_SUBSCRIBERS = 32;
+
+private:
+    struct Subscriber {
+        bool active;
+        StateEvent* ring;
+        int head;  // oldest queued event
+        int size;
+        long long dropped;  // since the subscriber last read
+    };
+
+    int queueCapacity;
+    Subscriber subscribers[MAX_SUBSCRIBERS];
+    std::atomic<int> numActive;
+    std::atomic<long long> dropped;
+    bool stopping;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    static void onEvent(const StateEvent& event, void* ctx);
+
+public:
+    EventBroadcaster(RideShareSystem& system, int queueCapacity = 1024);
+    ~EventBroadcaster();
+    EventBroadcaster(const EventBroadcaster&) = delete;
+    EventBroadcaster& operator=(const EventBroadcaster&) = delete;
+
+    // Returns a subscriber id, or -1 when every slot is taken
+    int open();
+    void close(int id);
+
+    // Waits up to timeoutMs for events, then moves up to maxEvents of them
+    // into out. lostEvents receives the number dropped for this subscriber
+    // since its previous wait. Returns the number of events copied.
+    int wait(int id, StateEvent* out, int maxEvents, long long& lostEvents, int timeoutMs);
+
+    // Wakes every waiter; later waits return immediately
+    void stop();
+
+    int getSubscriberCount() const { return numActive.load(std::memory_order_relaxed); }
+    long long getDropped() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include "LiveViewCache.h"
+#include <cstdio>
+
+namespace {
+
+const char* const DRIVER_STATUS_LABELS[NUM_DRIVER_STATUSES] = {"available", "busy", "offline"};
+const char* const VEHICLE_CLASS_LABELS[] = {"economy", "comfort", "xl"};
+
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (char c : value) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (u < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", u);
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+void appendInt(std::string& out, long long value) {
+    char buf[24];
+    std::snprintf(buf, sizeof(buf), "%lld", value);
+    out += buf;
+}
+
+void renderDriver(const DriverView& view, std::string& out) {
+    out.clear();
+    out += "{\"id\":";
+    appendInt(out, view.id);
+    out += ",\"name\":";
+    appendJsonString(out, view.name);
+    out += ",\"status\":\"";
+    out += DRIVER_STATUS_LABELS[static_cast<int>(view.status)];
+    out += "\",\"location\":";
+    appendJsonString(out, view.nodeName);
+    out += ",\"zone\":";
+    appendJsonString(out, view.zone);
+    out += ",\"nodeId\":";
+    appendInt(out, view.nodeId);
+    out += ",\"vehicleClass\":\"";
+    out += VEHICLE_CLASS_LABELS[static_cast<int>(view.vehicleClass)];
+    out += "\"}";
+}
+
+// Nodes, then each undirected edge once (edges are stored in both directions)
+void renderCity(const City& city, void* ctx) {
+    std::string& out = *static_cast<std::string*>(ctx);
+    char buf[96];
+    out += ",\"nodes\":";
+    appendInt(out, city.getNumNodes());
+    out += ",\"edges\":";
+    appendInt(out, city.getNumEdges());
+    // "zones" predates zone support and lists node names
+    out += ",\"zones\":[";
+    for (int i = 0; i < city.getNumNodes(); ++i) {
+        if (i > 0) out += ',';
+        appendJsonString(out, city.getNodeAt(i).name);
+    }
+    out += "],\"zoneNames\":[";
+    for (int z = 0; z < city.getNumZones(); ++z) {
+        if (z > 0) out += ',';
+        appendJsonString(out, city.getZoneName(z));
+    }
+    out += "],\"nodeList\":[";
+    for (int i = 0; i < city.getNumNodes(); ++i) {
+        const Node& node = city.getNodeAt(i);
+        if (i > 0) out += ',';
+        out += "{\"id\":";
+        appendInt(out, node.id);
+        out += ",\"name\":";
+        appendJsonString(out, node.name);
+        out += ",\"zone\":";
+        appendJsonString(out, node.zone);
+        std::snprintf(buf, sizeof(buf), ",\"lat\":%.6f,\"lon\":%.6f}", node.lat, node.lon);
+        out += buf;
+    }
+    out += "],\"edgeList\":[";
+    bool first = true;
+    for (int i = 0; i < city.getNumNodes(); ++i) {
+        const Node& node = city.getNodeAt(i);
+        for (const Edge* e = node.head; e; e = e->next) {
+            if (e->to <= node.id) continue;
+            std::snprintf(buf, sizeof(buf), "%s{\"from\":%d,\"to\":%d,\"weight\":%d}", first ? "" : ",", node.id,
+                          e->to, e->weight);
+            out += buf;
+            first = false;
+        }
+    }
+    out += ']';
+}
+
+} // namespace
+
+LiveViewCache::LiveViewCache(RideShareSystem& system) : system(system), numDriverRows(0) {
+    driverFragments = new std::string[system.getDriverCapacity()];
+    changed = new DriverView[system.getDriverCapacity()];
+}
+
+LiveViewCache::~LiveViewCache() {
+    delete[] changed;
+    delete[] driverFragments;
+}
+
+std::shared_ptr<const RenderedView> LiveViewCache::drivers() {
+    unsigned long long current = system.getDriverVersion();
+    std::shared_ptr<const RenderedView> view = std::atomic_load(&driversView);
+    if (view && view->version >= current) return view;
+
+    std::lock_guard<std::mutex> lock(driversMutex);
+    view = std::atomic_load(&driversView);
+    if (view && view->version >= current) return view;
+    renderDrivers();
+    return std::atomic_load(&driversView);
+}
+
+void LiveViewCache::renderDrivers() {
+    std::shared_ptr<const RenderedView> previous = std::atomic_load(&driversView);
+    unsigned long long since = previous ? previous->version : 0;
+    unsigned long long version;
+    int count = system.getDriversChangedSince(since, changed, version);
+    for (int i = 0; i < count; ++i) {
+        renderDriver(changed[i], driverFragments[changed[i].row]);
+        if (changed[i].row >= numDriverRows) numDriverRows = changed[i].row + 1;
+    }
+
+    size_t size = 64;
+    for (int row = 0; row < numDriverRows; ++row) size += driverFragments[row].size() + 1;
+    std::shared_ptr<RenderedView> next = std::make_shared<RenderedView>();
+    next->version = version;
+    next->body.reserve(size);
+    next->body += "{\"version\":";
+    appendInt(next->body, static_cast<long long>(version));
+    next->body += ",\"drivers\":[";
+    for (int row = 0; row < numDriverRows; ++row) {
+        if (row > 0) next->body += ',';
+        next->body += driverFragments[row];
+    }
+    next->body += "]}";
+    std::shared_ptr<const RenderedView> published = next;
+    std::atomic_store(&driversView, published);
+}
+
+std::shared_ptr<const RenderedView> LiveViewCache::graph() {
+    unsigned long long current = system.getCityVersion();
+    std::shared_ptr<const RenderedView> view = std::atomic_load(&graphView);
+    if (view && view->version >= current) return view;
+
+    std::lock_guard<std::mutex> lock(graphMutex);
+    view = std::atomic_load(&graphView);
+    if (view && view->version >= current) return view;
+    renderGraph();
+    return std::atomic_load(&graphView);
+}
+
+void LiveViewCache::renderGraph() {
+    std::string body;
+    unsigned long long version;
+    system.readCity(renderCity, &body, version);
+
+    std::shared_ptr<RenderedView> next = std::make_shared<RenderedView>();
+    next->version = version;
+    next->body += "{\"version\":";
+    appendInt(next->body, static_cast<long long>(version));
+    next->body += body;
+    next->body += '}';
+    std::shared_ptr<const RenderedView> published = next;
+    std::atomic_store(&graphView, published);
+}
@@ -0,0 +1,47 @@
+#ifndef LIVE_VIEW_CACHE_H
+#define LIVE_VIEW_CACHE_H
+
+#include "RideShareSystem.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+// A rendered JSON body and the source version it reflects
+struct RenderedView {
+    std::string body;
+    unsigned long long version;
+};
+
+// Serves /api/drivers and /api/graph bodies from immutable pre-rendered
+// buffers. A request whose version matches the last render only copies the
+// buffer pointer. Otherwise one caller re-renders while the others wait for
+// it: drivers incrementally (only rows changed since the last render are
+// re-serialized, then the per-row fragments are joined), the graph in full.
+class LiveViewCache {
+private:
+    RideShareSystem& system;
+
+    // Latest renders, swapped atomically; the mutexes only serialize renders
+    std::shared_ptr<const RenderedView> driversView;
+    std::shared_ptr<const RenderedView> graphView;
+    std::mutex driversMutex;
+    std::mutex graphMutex;
+
+    std::string* driverFragments;  // one JSON object per driver row
+    int numDriverRows;
+    DriverView* changed;
+
+    void renderDrivers();
+    void renderGraph();
+
+public:
+    explicit LiveViewCache(RideShareSystem& system);
+    ~LiveViewCache();
+    LiveViewCache(const LiveViewCache&) = delete;
+    LiveViewCache& operator=(const LiveViewCache&) = delete;
+
+    std::shared_ptr<const RenderedView> drivers();
+    std::shared_ptr<const RenderedView> graph();
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include "MetricsExporter.h"
+#include "../metrics/Metrics.h"
+#include <cstdio>
+
+namespace {
+
+const char* const TRIP_STATUS_LABELS[NUM_TRIP_STATUSES] = {"requested", "assigned", "ongoing", "completed",
+                                                           "cancelled"};
+const char* const DRIVER_STATUS_LABELS[NUM_DRIVER_STATUSES] = {"available", "busy", "offline"};
+const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+void appendHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+// `labels` is either empty or `key="value",` (trailing comma included)
+void appendSample(std::string& out, const char* name, const std::string& labels, double value) {
+    char buf[64];
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out.append(labels, 0, labels.size() - 1);
+        out += '}';
+    }
+    std::snprintf(buf, sizeof(buf), " %.9g\n", value);
+    out += buf;
+}
+
+void appendSummary(std::string& out, const char* name, const std::string& labels, int histogramId, double scale) {
+    HistogramSnapshot snap;
+    Metrics::snapshot(histogramId, snap);
+    char quantile[32];
+    for (double q : QUANTILES) {
+        std::snprintf(quantile, sizeof(quantile), "quantile=\"%g\",", q);
+        appendSample(out, name, labels + quantile, snap.quantile(q) * scale);
+    }
+    std::string base(name);
+    appendSample(out, (base + "_sum").c_str(), labels, snap.sum * scale);
+    appendSample(out, (base + "_count").c_str(), labels, static_cast<double>(snap.count));
+}
+
+std::string escapeLabel(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') escaped += '\\';
+        if (c == '\n') {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(RideShareSystem& system, int intervalMs)
+    : system(system), intervalMs(intervalMs), rendered(std::make_shared<const std::string>()), stopping(false) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::start() {
+    if (renderer.joinable()) return;
+    renderNow();
+    stopping = false;
+    renderer = std::thread(&MetricsExporter::run, this);
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopCv.notify_all();
+    if (renderer.joinable()) renderer.join();
+}
+
+void MetricsExporter::run() {
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopCv.wait_for(lock, std::chrono::milliseconds(intervalMs), [this] { return stopping; })) {
+        lock.unlock();
+        renderNow();
+        lock.lock();
+    }
+}
+
+void MetricsExporter::renderNow() {
+    std::string out;
+    out.reserve(8192);
+
+    appendHeader(out, "rideshare_dispatch_latency_seconds", "summary", "Latency of dispatching one trip.");
+    appendSummary(out, "rideshare_dispatch_latency_seconds", "", METRIC_DISPATCH_TRIP, 1e-9);
+    appendHeader(out, "rideshare_find_nearest_driver_seconds", "summary", "Latency of the nearest-driver search.");
+    appendSummary(out, "rideshare_find_nearest_driver_seconds", "", METRIC_FIND_NEAREST_DRIVER, 1e-9);
+    appendHeader(out, "rideshare_find_shortest_path_seconds", "summary", "Latency of point-to-point routing.");
+    appendSummary(out, "rideshare_find_shortest_path_seconds", "", METRIC_FIND_SHORTEST_PATH, 1e-9);
+    appendHeader(out, "rideshare_search_nodes_settled", "summary", "Nodes settled per graph search.");
+    appendSummary(out, "rideshare_search_nodes_settled", "", METRIC_NODES_SETTLED, 1.0);
+
+    appendHeader(out, "rideshare_http_request_duration_seconds", "summary", "HTTP handler latency by route.");
+    int numHistograms = Metrics::getNumHistograms();
+    for (int id = NUM_CORE_METRICS; id < numHistograms; ++id) {
+        std::string name = Metrics::getName(id);
+        if (name.compare(0, 6, "route ") != 0) continue;
+        appendSummary(out, "rideshare_http_request_duration_seconds", "route=\"" + escapeLabel(name.substr(6)) + "\",",
+                      id, 1e-9);
+    }
+
+    appendHeader(out, "rideshare_trips", "gauge", "Trips held in memory by status.");
+    for (int s = 0; s < NUM_TRIP_STATUSES; ++s) {
+        appendSample(out, "rideshare_trips", std::string("status=\"") + TRIP_STATUS_LABELS[s] + "\",",
+                     static_cast<double>(system.getTripCount(static_cast<TripStatus>(s))));
+    }
+    appendHeader(out, "rideshare_trips_archived_total", "counter", "Trips moved to the on-disk archive.");
+    appendSample(out, "rideshare_trips_archived_total", "", static_cast<double>(system.getArchivedTripCount()));
+
+    appendHeader(out, "rideshare_drivers", "gauge", "Drivers by status.");
+    for (int s = 0; s < NUM_DRIVER_STATUSES; ++s) {
+        appendSample(out, "rideshare_drivers", std::string("status=\"") + DRIVER_STATUS_LABELS[s] + "\",",
+                     static_cast<double>(system.getDriverCount(static_cast<DriverStatus>(s))));
+    }
+
+    long long hits = system.getDistanceCacheHits();
+    long long misses = system.getDistanceCacheMisses();
+    appendHeader(out, "rideshare_distance_cache_hits_total", "counter", "Routing distance cache hits.");
+    appendSample(out, "rideshare_distance_cache_hits_total", "", static_cast<double>(hits));
+    appendHeader(out, "rideshare_distance_cache_misses_total", "counter", "Routing distance cache misses.");
+    appendSample(out, "rideshare_distance_cache_misses_total", "", static_cast<double>(misses));
+    appendHeader(out, "rideshare_distance_cache_hit_ratio", "gauge", "Lifetime routing distance cache hit ratio.");
+    appendSample(out, "rideshare_distance_cache_hit_ratio", "",
+                 hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0);
+
+    appendHeader(out, "rideshare_event_queue_depth", "gauge", "Driver events waiting to be consumed.");
+    appendSample(out, "rideshare_event_queue_depth", "", static_cast<double>(system.getEventQueueDepth()));
+    appendHeader(out, "rideshare_events_dropped_total", "counter", "Driver events dropped on overflow.");
+    appendSample(out, "rideshare_events_dropped_total", "", static_cast<double>(system.getEventsDropped()));
+
+    ProcessStats process = sampleProcessStats(processSampler);
+    appendHeader(out, "rideshare_process_cpu_percent", "gauge", "CPU use across all cores since the last render.");
+    appendSample(out, "rideshare_process_cpu_percent", "", process.cpuPercent);
+    appendHeader(out, "rideshare_heap_in_use_bytes", "gauge", "Bytes in live heap allocations.");
+    appendSample(out, "rideshare_heap_in_use_bytes", "", static_cast<double>(process.heapInUseBytes));
+
+    std::atomic_store(&rendered, std::shared_ptr<const std::string>(std::make_shared<std::string>(std::move(out))));
+}
@@ -0,0 +1,43 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include "RideShareSystem.h"
+#include "../metrics/Metrics.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Renders Prometheus text exposition format on a background thread and
+// publishes it as an immutable buffer. A scrape only copies the latest
+// buffer's pointer, so it never waits on the renderer or on system locks.
+class MetricsExporter {
+private:
+    RideShareSystem& system;
+    int intervalMs;
+    std::shared_ptr<const std::string> rendered;
+    ProcessSampler processSampler;
+
+    std::thread renderer;
+    std::mutex stopMutex;
+    std::condition_variable stopCv;
+    bool stopping;
+
+    void run();
+
+public:
+    MetricsExporter(RideShareSystem& system, int intervalMs = 1000);
+    ~MetricsExporter();
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void start();
+    void stop();
+    // Builds a fresh exposition and publishes it
+    void renderNow();
+
+    std::shared_ptr<const std::string> current() const { return std::atomic_load(&rendered); }
+};
+
+#endif
@@ -1,13 +1,46 @@
 #include "RideShareSystem.h"
+#include "../metrics/Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
 #include <iostream>
 
-RideShareSystem::RideShareSystem() : numDrivers(0), driverCapacity(100), numRiders(0), riderCapacity(100), numTrips(0), tripCapacity(100) {
+long long systemClockMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+RideShareSystem::RideShareSystem(int nodeCapacity, int driverCapacity, int riderCapacity, int tripCapacity)
+    : city(nodeCapacity), numDrivers(0), driverCapacity(driverCapacity), driverTable(driverCapacity), numRiders(0),
+      riderCapacity(riderCapacity), numTrips(0), tripCapacity(tripCapacity), nextTripId(1), maxPickupDistance(-1),
+      zonePickupLimits(nullptr), numZonePickupLimits(0), tripRetentionMs(5 * 60 * 1000), clock(systemClockMillis),
+      mapMatcher(nullptr), retiredMatchers(nullptr), numRetiredMatchers(0), archivedTrips(0), driverVersion(0),
+      cityVersion(0), driverRowVersions(nullptr), batchMoveSlots(nullptr), pricing(zoneStats),
+      zoneCostsStale(true), demandWindowMs(10 * 60 * 1000), maxRepositionsPerRun(20),
+      suggestions(nullptr), numSuggestions(0), rebalancedAt(0), dispatchPool(nullptr), dispatchThreads(0) {
+    for (int i = 0; i < NUM_TRIP_STATUSES; ++i) tripStatusCounts[i].store(0);
+    for (int i = 0; i < NUM_DRIVER_STATUSES; ++i) driverStatusCounts[i].store(0);
     drivers = new Driver*[driverCapacity];
     riders = new Rider*[riderCapacity];
     trips = new Trip*[tripCapacity];
+    driverRowVersions = new unsigned long long[driverCapacity]();
+    batchMoveSlots = new int[driverCapacity]();
+    eventBus.subscribe(onDriverEvent, this);
 }
 
 RideShareSystem::~RideShareSystem() {
+    eventBus.stop();
+    delete dispatchPool;
+    delete[] suggestions;
+    delete mapMatcher.load();
+    for (int i = 0; i < numRetiredMatchers; ++i) delete retiredMatchers[i];
+    delete[] retiredMatchers;
+    delete[] zonePickupLimits;
+    delete[] driverRowVersions;
+    delete[] batchMoveSlots;
+    // Trips compacted since the last flush would otherwise be lost
+    archive.flush();
+    history.flush();
     for (int i = 0; i < numDrivers; ++i) delete drivers[i];
     delete[] drivers;
     for (int i = 0; i < numRiders; ++i) delete riders[i];
@@ -16,104 +49,652 @@ RideShareSystem::~RideShareSystem() {
     delete[] trips;
 }
 
-void RideShareSystem::addNode(int id, std::string name, std::string zone) {
-    city.addNode(id, name, zone);
+void RideShareSystem::addNode(int id, std::string name, std::string zone, double lat, double lon) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    city.addNode(id, name, zone, lat, lon);
+    zoneStats.reserveZones(city.getNumZones());
+    zoneCostsStale = true;
+    cityVersion.fetch_add(1, std::memory_order_release);
 }
 
 void RideShareSystem::addEdge(int from, int to, int weight) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
     city.addEdge(from, to, weight);
+    distanceCache.invalidate();
+    zoneCostsStale = true;
+    cityVersion.fetch_add(1, std::memory_order_release);
 }
 
-void RideShareSystem::addDriver(int id, std::string name, int locId, std::string vehicle) {
+void RideShareSystem::addDriver(int id, std::string name, int locId, std::string vehicle, VehicleClass vClass) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
     if (numDrivers < driverCapacity) {
-        drivers[numDrivers++] = new Driver(id, name, locId, vehicle);
+        drivers[numDrivers++] = new Driver(id, name, locId, vehicle, vClass);
+        driverTable.addDriver(id, locId, DriverStatus::AVAILABLE, vClass);
+        driverStatusCounts[static_cast<int>(DriverStatus::AVAILABLE)]++;
+        pricing.driverArrived(city.getZoneId(locId), clock());
+        touchDriverLocked(numDrivers - 1);
+    }
+}
+
+void RideShareSystem::touchDriverLocked(int row) {
+    driverRowVersions[row] = driverVersion.load(std::memory_order_relaxed) + 1;
+    driverVersion.store(driverRowVersions[row], std::memory_order_release);
+}
+
+void RideShareSystem::setDriverStatus(int row, DriverStatus s) {
+    DriverStatus old = driverTable.getStatus(row);
+    drivers[row]->setStatus(s);
+    driverTable.setStatus(row, s);
+    if (old != s) {
+        driverStatusCounts[static_cast<int>(old)]--;
+        driverStatusCounts[static_cast<int>(s)]++;
+        int zone = city.getZoneId(driverTable.getLocation(row));
+        if (old == DriverStatus::AVAILABLE) pricing.driverLeft(zone, clock());
+        if (s == DriverStatus::AVAILABLE) pricing.driverArrived(zone, clock());
+        StateEvent event = {EventType::DRIVER_STATUS, driverTable.getId(row), static_cast<int>(old),
+                            static_cast<int>(s), driverTable.getLocation(row), clock(), -1};
+        eventBus.publish(event);
+        touchDriverLocked(row);
+    }
+}
+
+void RideShareSystem::setDriverLocation(int row, int locId, bool publish) {
+    int old = driverTable.getLocation(row);
+    drivers[row]->setLocation(locId);
+    driverTable.setLocation(row, locId);
+    if (old != locId) {
+        int oldZone = city.getZoneId(old);
+        int newZone = city.getZoneId(locId);
+        if (driverTable.getStatus(row) == DriverStatus::AVAILABLE && oldZone != newZone) {
+            pricing.driverLeft(oldZone, clock());
+            pricing.driverArrived(newZone, clock());
+        }
+        if (publish) {
+            StateEvent event = {EventType::DRIVER_LOCATION, driverTable.getId(row), old, locId, locId, clock(), -1};
+            eventBus.publish(event);
+        }
+        // Riders already aboard count this leg against their ride limit
+        if (drivers[row]->getNumStops() > 0) {
+            int leg = distanceCache.get(city, old, locId);
+            if (leg != DistanceCache::UNREACHABLE) drivers[row]->addRidden(leg);
+        }
+        touchDriverLocked(row);
+    }
+}
+
+void RideShareSystem::onDriverEvent(const StateEvent& event, void* ctx) {
+    bool freed = event.type == EventType::DRIVER_STATUS &&
+                 event.newState == static_cast<int>(DriverStatus::AVAILABLE);
+    if (!freed && event.type != EventType::EVENTS_DROPPED) return;
+
+    RideShareSystem* self = static_cast<RideShareSystem*>(ctx);
+    std::lock_guard<std::shared_mutex> lock(self->stateMutex);
+    if (freed) {
+        self->retryPendingTrips();
+    } else {
+        // Lost events may have freed any number of drivers: sweep everything
+        self->dispatchPendingLocked();
     }
 }
 
 void RideShareSystem::addRider(int id, std::string name, int locId) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
     if (numRiders < riderCapacity) {
         riders[numRiders++] = new Rider(id, name, locId);
     }
 }
 
-int RideShareSystem::requestTrip(int riderId, int pickupId, int dropoffId) {
-    if (numTrips < tripCapacity) {
-        int tripId = numTrips + 1;
-        trips[numTrips++] = new Trip(tripId, riderId, pickupId, dropoffId);
-        return tripId;
+Trip* RideShareSystem::findTrip(int tripId) {
+    int lo = 0, hi = numTrips;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (trips[mid]->getId() < tripId) lo = mid + 1;
+        else hi = mid;
     }
-    return -1;
+    return lo < numTrips && trips[lo]->getId() == tripId ? trips[lo] : nullptr;
 }
 
-bool RideShareSystem::dispatchTrip(int tripId) {
-    Trip* trip = nullptr;
+int RideShareSystem::firstTripRequestedAt(long long ms) const {
+    int lo = 0, hi = numTrips;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (trips[mid]->getRequestedAt() < ms) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+Trip* RideShareSystem::createTripLocked(int riderId, int pickupId, int dropoffId, int priority) {
+    if (numTrips >= tripCapacity) return nullptr;
+    Trip* trip = new Trip(nextTripId++, riderId, pickupId, dropoffId);
+    trip->setRequestedAt(clock());
+    trip->setPickupZoneId(city.getZoneId(pickupId));
+    trip->setPriority(priority);
+    priceTripLocked(trip);
+    trips[numTrips++] = trip;
+    tripStatusCounts[static_cast<int>(TripStatus::REQUESTED)]++;
+    tripsByStatus.insert(static_cast<int>(TripStatus::REQUESTED), trip->getId());
+    tripsByRider.insert(riderId, trip->getId());
+    tripsByZone.insert(trip->getPickupZoneId(), trip->getId());
+    zoneStats.recordRequest(trip->getPickupZoneId(), trip->getRequestedAt());
+    pricing.requestOpened(trip->getPickupZoneId(), trip->getRequestedAt());
+    publishTripEvent(trip, -1);
+    return trip;
+}
+
+void RideShareSystem::setTripStatus(Trip* trip, TripStatus s) {
+    TripStatus old = trip->getStatus();
+    tripStatusCounts[static_cast<int>(old)]--;
+    tripStatusCounts[static_cast<int>(s)]++;
+    trip->setStatus(s);
+    if (old != s) {
+        tripsByStatus.remove(static_cast<int>(old), trip->getId());
+        tripsByStatus.insert(static_cast<int>(s), trip->getId());
+        publishTripEvent(trip, static_cast<int>(old));
+    }
+}
+
+void RideShareSystem::setTripDriver(Trip* trip, int driverId) {
+    if (trip->getDriverId() != -1) tripsByDriver.remove(trip->getDriverId(), trip->getId());
+    trip->setDriverId(driverId);
+    if (driverId != -1) tripsByDriver.insert(driverId, trip->getId());
+}
+
+void RideShareSystem::rebuildTripIndexesLocked() {
+    tripsByStatus.clear();
+    tripsByDriver.clear();
+    tripsByRider.clear();
+    tripsByZone.clear();
     for (int i = 0; i < numTrips; ++i) {
-        if (trips[i]->getId() == tripId) {
-            trip = trips[i];
-            break;
+        const Trip* trip = trips[i];
+        tripsByStatus.insert(static_cast<int>(trip->getStatus()), trip->getId());
+        if (trip->getDriverId() != -1) tripsByDriver.insert(trip->getDriverId(), trip->getId());
+        tripsByRider.insert(trip->getRiderId(), trip->getId());
+        tripsByZone.insert(trip->getPickupZoneId(), trip->getId());
+    }
+}
+
+void RideShareSystem::publishTripEvent(const Trip* trip, int oldStatus) {
+    StateEvent event = {EventType::TRIP_STATUS, trip->getDriverId(), oldStatus, static_cast<int>(trip->getStatus()),
+                        trip->getPickupLocationId(), clock(), trip->getId()};
+    eventBus.publish(event);
+}
+
+int RideShareSystem::requestTrip(int riderId, int pickupId, int dropoffId, int priority) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    Trip* trip = createTripLocked(riderId, pickupId, dropoffId, priority);
+    return trip ? trip->getId() : -1;
+}
+
+int RideShareSystem::requestPooledTrip(int riderId, int pickupId, int dropoffId, int maxDetourPct) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    Trip* trip = createTripLocked(riderId, pickupId, dropoffId, 0);
+    if (!trip) return -1;
+    requestPooledLocked(trip, maxDetourPct);
+    return trip->getId();
+}
+
+bool RideShareSystem::requestPooledLocked(Trip* trip, int maxDetourPct) {
+    // Without a direct route there is no ride limit to pool under; it waits as a solo trip
+    int direct = distanceCache.get(city, trip->getPickupLocationId(), trip->getDropoffLocationId());
+    if (direct != DistanceCache::UNREACHABLE) trip->setPooled(direct + direct * maxDetourPct / 100);
+    return dispatchTripLocked(trip);
+}
+
+namespace {
+
+// All dropoffs requested from one pickup, priced with a single search
+struct PrefetchTask {
+    const City* city;
+    DistanceCache* cache;
+    int fromId;
+    const int* targets;
+    int count;
+};
+
+void runPrefetchTask(void* arg) {
+    PrefetchTask* task = static_cast<PrefetchTask*>(arg);
+    task->cache->prefetch(*task->city, task->fromId, task->targets, task->count);
+}
+
+} // namespace
+
+void RideShareSystem::prefetchTripDistancesLocked(const TripRequestItem* items, int count) {
+    int* order = new int[count];
+    for (int i = 0; i < count; ++i) order[i] = i;
+    std::sort(order, order + count, [&](int a, int b) {
+        return items[a].pickupId != items[b].pickupId ? items[a].pickupId < items[b].pickupId : a < b;
+    });
+
+    int* targets = new int[count];
+    PrefetchTask* tasks = new PrefetchTask[count];
+    int numTasks = 0;
+    for (int i = 0; i < count;) {
+        int begin = i;
+        int fromId = items[order[i]].pickupId;
+        for (; i < count && items[order[i]].pickupId == fromId; ++i) targets[i] = items[order[i]].dropoffId;
+        if (city.hasNode(fromId)) {
+            tasks[numTasks++] = PrefetchTask{&city, &distanceCache, fromId, targets + begin, i - begin};
+        }
+    }
+
+    // Searches only read the city; stateMutex keeps writers out
+    if (numTasks == 1) {
+        runPrefetchTask(&tasks[0]);
+    } else if (numTasks > 1) {
+        if (!dispatchPool) dispatchPool = new WorkStealingPool(dispatchThreads);
+        for (int t = 0; t < numTasks; ++t) dispatchPool->submit(runPrefetchTask, &tasks[t]);
+        dispatchPool->waitIdle();
+    }
+
+    delete[] tasks;
+    delete[] targets;
+    delete[] order;
+}
+
+int RideShareSystem::requestTrips(const TripRequestItem* items, int count, TripRequestResult* results) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    prefetchTripDistancesLocked(items, count);
+    Trip** created = new Trip*[count];
+    Trip** solo = new Trip*[count];
+    int numSolo = 0;
+    for (int i = 0; i < count; ++i) {
+        const TripRequestItem& item = items[i];
+        created[i] = createTripLocked(item.riderId, item.pickupId, item.dropoffId, item.priority);
+        if (created[i] && !item.pooled) solo[numSolo++] = created[i];
+    }
+
+    int dispatched = numSolo > 0 ? dispatchBatchLocked(solo, numSolo) : 0;
+    for (int i = 0; i < count; ++i) {
+        if (created[i] && items[i].pooled && requestPooledLocked(created[i], items[i].maxDetourPct)) dispatched++;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        const Trip* trip = created[i];
+        results[i].tripId = trip ? trip->getId() : -1;
+        results[i].driverId = trip ? trip->getDriverId() : -1;
+        results[i].distance = trip ? trip->getDistance() : 0.0;
+        results[i].fare = trip ? trip->getFare() : 0.0;
+    }
+    delete[] solo;
+    delete[] created;
+    return dispatched;
+}
+
+namespace {
+
+// Idle drivers considered for a pooled request, in addition to every
+// driver already running a pooled route
+const int POOL_IDLE_CANDIDATES = 8;
+
+} // namespace
+
+bool RideShareSystem::dispatchPooledLocked(Trip* trip, int maxRide) {
+    int pickupId = trip->getPickupLocationId();
+    int dropoffId = trip->getDropoffLocationId();
+    int maxPickup = pickupLimitFor(trip->getPickupZoneId());
+
+    // Candidates: nearby idle drivers plus drivers with room on a pooled route
+    int* rows = new int[driverTable.size() + POOL_IDLE_CANDIDATES];
+    int numRows = 0;
+    DriverMatch idle[POOL_IDLE_CANDIDATES];
+    int numIdle = DispatchEngine::findKNearestDrivers(city, pickupId, driverTable, POOL_IDLE_CANDIDATES, idle,
+                                                      maxPickup);
+    for (int c = 0; c < numIdle; ++c) rows[numRows++] = driverTable.findRow(idle[c].driverId);
+    // Compacted in place: the write index never passes the read index
+    int busyStart = numRows;
+    int numBusy = driverTable.filterCandidates(DriverStatus::BUSY, ALL_VEHICLE_CLASSES, rows + busyStart);
+    for (int c = 0; c < numBusy; ++c) {
+        int row = rows[busyStart + c];
+        int stops = drivers[row]->getNumStops();
+        if (stops > 0 && stops + 2 <= Driver::MAX_ROUTE_STOPS) rows[numRows++] = row;
+    }
+
+    // Two searches (from the pickup and the dropoff) cover every distance the
+    // insertion heuristic needs except legs of existing routes
+    int* targets = new int[numRows * (Driver::MAX_ROUTE_STOPS + 1) + 1];
+    int numTargets = 0;
+    for (int c = 0; c < numRows; ++c) {
+        const Driver* driver = drivers[rows[c]];
+        targets[numTargets++] = driver->getCurrentLocationId();
+        for (int k = 0; k < driver->getNumStops(); ++k) targets[numTargets++] = driver->getRoute()[k].nodeId;
+    }
+    distanceCache.prefetch(city, pickupId, targets, numTargets);
+    distanceCache.prefetch(city, dropoffId, targets, numTargets);
+
+    int bestRow = -1;
+    PoolInsertion best = {};
+    for (int c = 0; c < numRows; ++c) {
+        const Driver* driver = drivers[rows[c]];
+        PoolInsertion option;
+        if (!PoolingEngine::findBestInsertion(city, distanceCache, driver->getCurrentLocationId(), driver->getRoute(),
+                                              driver->getNumStops(), driver->getSeatCapacity(), pickupId, dropoffId,
+                                              maxRide, maxPickup, option)) {
+            continue;
+        }
+        if (bestRow == -1 || option.addedCost < best.addedCost ||
+            (option.addedCost == best.addedCost && option.pickupEta < best.pickupEta)) {
+            bestRow = rows[c];
+            best = option;
         }
     }
+    delete[] targets;
+    delete[] rows;
+    if (bestRow == -1) return false;
+
+    Driver* driver = drivers[bestRow];
+    RouteStop route[Driver::MAX_ROUTE_STOPS];
+    int numStops = PoolingEngine::applyInsertion(driver->getRoute(), driver->getNumStops(), best, trip->getId(),
+                                                 pickupId, dropoffId, maxRide, route);
+    driver->setRoute(route, numStops);
+
+    rollbackManager.recordAction(trip->getId(), driver->getId(), TripStatus::REQUESTED, TripStatus::ASSIGNED);
+    setTripDriver(trip, driver->getId());
+    setTripStatus(trip, TripStatus::ASSIGNED);
+    trip->setPickupDistance(best.pickupEta);
+    setDriverStatus(bestRow, DriverStatus::BUSY);
+    pendingTrips.remove(trip->getId());
+    long long now = clock();
+    zoneStats.recordDispatch(trip->getPickupZoneId(), now, now - trip->getRequestedAt());
+    pricing.requestClosed(trip->getPickupZoneId(), now);
+    return true;
+}
+
+void RideShareSystem::releaseDriverLocked(int row, int tripId) {
+    drivers[row]->removeTripStops(tripId);
+    if (drivers[row]->getNumStops() == 0) setDriverStatus(row, DriverStatus::AVAILABLE);
+}
+
+void RideShareSystem::priceTripLocked(Trip* trip) {
+    int distance = distanceCache.get(city, trip->getPickupLocationId(), trip->getDropoffLocationId());
+    if (distance == DistanceCache::UNREACHABLE) return;
+    trip->setDistance(distance);
+    trip->setFare(pricing.quote(trip->getPickupZoneId(), distance).fare);
+}
+
+bool RideShareSystem::dispatchTrip(int tripId) {
+    ScopedTimer timer(METRIC_DISPATCH_TRIP);
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    Trip* trip = findTrip(tripId);
 
     if (!trip || trip->getStatus() != TripStatus::REQUESTED) return false;
+    return dispatchTripLocked(trip);
+}
+
+void RideShareSystem::assignDriverLocked(Trip* trip, int row, int pickupDistance) {
+    int driverId = driverTable.getId(row);
+    rollbackManager.recordAction(trip->getId(), driverId, TripStatus::REQUESTED, TripStatus::ASSIGNED);
+    setTripDriver(trip, driverId);
+    setTripStatus(trip, TripStatus::ASSIGNED);
+    trip->setPickupDistance(pickupDistance);
+    setDriverStatus(row, DriverStatus::BUSY);
+    pendingTrips.remove(trip->getId());
+    long long now = clock();
+    zoneStats.recordDispatch(trip->getPickupZoneId(), now, now - trip->getRequestedAt());
+    pricing.requestClosed(trip->getPickupZoneId(), now);
+}
 
-    int driverId = DispatchEngine::findNearestDriver(city, *trip, drivers, numDrivers);
+bool RideShareSystem::dispatchTripLocked(Trip* trip) {
+    if (trip->isPooled()) {
+        if (dispatchPooledLocked(trip, trip->getMaxRide())) return true;
+        pendingTrips.push(trip->getId(), trip->getRequestedAt(), trip->getPriority());
+        return false;
+    }
+
+    int pickupDistance = -1;
+    int driverId = DispatchEngine::findNearestDriver(city, *trip, driverTable, ALL_VEHICLE_CLASSES, &pickupDistance,
+                                                     pickupLimitFor(trip->getPickupZoneId()));
     if (driverId != -1) {
-        Driver* driver = nullptr;
-        for (int i = 0; i < numDrivers; ++i) {
-            if (drivers[i]->getId() == driverId) {
-                driver = drivers[i];
-                break;
+        int row = driverTable.findRow(driverId);
+        if (row != -1) {
+            assignDriverLocked(trip, row, pickupDistance);
+            return true;
+        }
+    }
+
+    // No driver right now: wait until one becomes available
+    pendingTrips.push(trip->getId(), trip->getRequestedAt(), trip->getPriority());
+    return false;
+}
+
+int RideShareSystem::retryPendingTrips() {
+    int attempts = pendingTrips.getSize();
+    if (attempts == 0) return 0;
+
+    int* unserved = new int[attempts];
+    int numUnserved = 0;
+    int dispatched = 0;
+
+    while (attempts-- > 0 && dispatched == 0 && !pendingTrips.empty()) {
+        int tripId = pendingTrips.pop();
+        Trip* trip = findTrip(tripId);
+        if (!trip || trip->getStatus() != TripStatus::REQUESTED) continue;
+
+        if (dispatchTripLocked(trip)) {
+            dispatched++;
+        } else {
+            // dispatchTripLocked re-queued it; hold it back so the loop moves on
+            pendingTrips.remove(tripId);
+            unserved[numUnserved++] = tripId;
+        }
+    }
+
+    for (int i = 0; i < numUnserved; ++i) {
+        Trip* trip = findTrip(unserved[i]);
+        pendingTrips.push(trip->getId(), trip->getRequestedAt(), trip->getPriority());
+    }
+    delete[] unserved;
+    return dispatched;
+}
+
+namespace {
+
+// Candidates kept per trip in a batch; if all of them are claimed by trips
+// ahead in the queue, the trip falls back to a fresh search
+const int BATCH_CANDIDATES = 8;
+// Trips per pool task; large zones are split so idle workers can steal
+const int BATCH_CHUNK = 32;
+
+struct CandidateTask {
+    const City* city;
+    const DriverTable* table;
+    Trip* const* batch;
+    const int* positions;  // batch positions handled by this task
+    int count;
+    const int* limits;
+    DriverMatch* candidates;  // BATCH_CANDIDATES slots per batch position
+    int* numCandidates;
+};
+
+void runCandidateTask(void* arg) {
+    CandidateTask* task = static_cast<CandidateTask*>(arg);
+    for (int i = 0; i < task->count; ++i) {
+        int pos = task->positions[i];
+        int prev = i > 0 ? task->positions[i - 1] : -1;
+        if (prev != -1 && task->batch[prev]->getPickupLocationId() == task->batch[pos]->getPickupLocationId() &&
+            task->limits[prev] == task->limits[pos]) {
+            // Same search as the previous trip: reuse its candidates
+            task->numCandidates[pos] = task->numCandidates[prev];
+            for (int c = 0; c < task->numCandidates[prev]; ++c) {
+                task->candidates[pos * BATCH_CANDIDATES + c] = task->candidates[prev * BATCH_CANDIDATES + c];
             }
+            continue;
         }
+        task->numCandidates[pos] = DispatchEngine::findKNearestDrivers(
+            *task->city, task->batch[pos]->getPickupLocationId(), *task->table, BATCH_CANDIDATES,
+            task->candidates + pos * BATCH_CANDIDATES, task->limits[pos]);
+    }
+}
 
-        if (driver) {
-            rollbackManager.recordAction(tripId, driverId, TripStatus::REQUESTED, TripStatus::ASSIGNED);
-            trip->setDriverId(driverId);
-            trip->setStatus(TripStatus::ASSIGNED);
-            driver->setStatus(DriverStatus::BUSY);
-            return true;
+long long queueKey(const Trip* trip) {
+    return trip->getRequestedAt() - trip->getPriority() * PendingTripQueue::PRIORITY_BOOST_MS;
+}
+
+} // namespace
+
+int RideShareSystem::dispatchPendingTrips() {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    return dispatchPendingLocked();
+}
+
+int RideShareSystem::dispatchPendingLocked() {
+    int size = pendingTrips.getSize();
+    if (size == 0) return 0;
+
+    // Drain the queue in commit order; ties on the key are broken by trip id.
+    // Pooled trips keep their ride limit and are inserted one at a time after
+    // the solo batch.
+    Trip** batch = new Trip*[size];
+    Trip** pooled = new Trip*[size];
+    int count = 0;
+    int numPooled = 0;
+    while (!pendingTrips.empty()) {
+        Trip* trip = findTrip(pendingTrips.pop());
+        if (!trip || trip->getStatus() != TripStatus::REQUESTED) continue;
+        if (trip->isPooled()) {
+            pooled[numPooled++] = trip;
+            continue;
         }
+        int j = count++;
+        while (j > 0 && queueKey(batch[j - 1]) == queueKey(trip) && batch[j - 1]->getId() > trip->getId()) {
+            batch[j] = batch[j - 1];
+            j--;
+        }
+        batch[j] = trip;
     }
-    return false;
+
+    int dispatched = count > 0 ? dispatchBatchLocked(batch, count) : 0;
+    for (int i = 0; i < numPooled; ++i) {
+        if (dispatchTripLocked(pooled[i])) dispatched++;
+    }
+    delete[] pooled;
+    delete[] batch;
+    return dispatched;
 }
 
-bool RideShareSystem::completeTrip(int tripId) {
-    Trip* trip = nullptr;
-    for (int i = 0; i < numTrips; ++i) {
-        if (trips[i]->getId() == tripId) {
-            trip = trips[i];
-            break;
+int RideShareSystem::dispatchBatchLocked(Trip** batch, int count) {
+    // Group batch positions by pickup zone (zone -1 gets the last bucket)
+    int numZones = city.getNumZones();
+    int* zoneStart = new int[numZones + 2]();
+    int* limits = new int[count];
+    for (int i = 0; i < count; ++i) {
+        int zone = batch[i]->getPickupZoneId();
+        int bucket = (zone >= 0 && zone < numZones) ? zone : numZones;
+        zoneStart[bucket + 1]++;
+        limits[i] = pickupLimitFor(zone);
+    }
+    for (int z = 0; z <= numZones; ++z) zoneStart[z + 1] += zoneStart[z];
+    int* positions = new int[count];
+    int* fill = new int[numZones + 1];
+    for (int z = 0; z <= numZones; ++z) fill[z] = zoneStart[z];
+    for (int i = 0; i < count; ++i) {
+        int zone = batch[i]->getPickupZoneId();
+        int bucket = (zone >= 0 && zone < numZones) ? zone : numZones;
+        positions[fill[bucket]++] = i;
+    }
+    // Within a zone, identical pickups end up adjacent so they share a search
+    for (int z = 0; z <= numZones; ++z) {
+        std::sort(positions + zoneStart[z], positions + zoneStart[z + 1], [&](int a, int b) {
+            int pa = batch[a]->getPickupLocationId(), pb = batch[b]->getPickupLocationId();
+            return pa != pb ? pa < pb : (limits[a] != limits[b] ? limits[a] < limits[b] : a < b);
+        });
+    }
+
+    int maxTasks = 0;
+    for (int z = 0; z <= numZones; ++z) {
+        maxTasks += (zoneStart[z + 1] - zoneStart[z] + BATCH_CHUNK - 1) / BATCH_CHUNK;
+    }
+    CandidateTask* tasks = new CandidateTask[maxTasks];
+    DriverMatch* candidates = new DriverMatch[count * BATCH_CANDIDATES];
+    int* numCandidates = new int[count];
+    int numTasks = 0;
+    for (int z = 0; z <= numZones; ++z) {
+        for (int begin = zoneStart[z]; begin < zoneStart[z + 1]; begin += BATCH_CHUNK) {
+            int end = begin + BATCH_CHUNK < zoneStart[z + 1] ? begin + BATCH_CHUNK : zoneStart[z + 1];
+            tasks[numTasks++] = CandidateTask{&city, &driverTable, batch, positions + begin, end - begin,
+                                              limits, candidates, numCandidates};
         }
     }
 
-    if (!trip || trip->getStatus() != TripStatus::ASSIGNED) return false;
+    // Searches only read the city and driver table; stateMutex keeps writers out
+    if (numTasks == 1) {
+        runCandidateTask(&tasks[0]);
+    } else {
+        if (!dispatchPool) dispatchPool = new WorkStealingPool(dispatchThreads);
+        for (int t = 0; t < numTasks; ++t) dispatchPool->submit(runCandidateTask, &tasks[t]);
+        dispatchPool->waitIdle();
+    }
 
-    Driver* driver = nullptr;
-    for (int i = 0; i < numDrivers; ++i) {
-        if (drivers[i]->getId() == trip->getDriverId()) {
-            driver = drivers[i];
-            break;
+    // Commit sequentially in queue order: the first candidate still free wins
+    int dispatched = 0;
+    for (int i = 0; i < count; ++i) {
+        Trip* trip = batch[i];
+        const DriverMatch* mine = candidates + i * BATCH_CANDIDATES;
+        bool assigned = false;
+        for (int c = 0; c < numCandidates[i] && !assigned; ++c) {
+            int row = driverTable.findRow(mine[c].driverId);
+            if (row != -1 && driverTable.getStatus(row) == DriverStatus::AVAILABLE) {
+                assignDriverLocked(trip, row, mine[c].distance);
+                assigned = true;
+            }
+        }
+        if (assigned) {
+            dispatched++;
+        } else if (numCandidates[i] == BATCH_CANDIDATES) {
+            // Every candidate went to an earlier trip; there may be more further out
+            if (dispatchTripLocked(trip)) dispatched++;
+        } else {
+            // The search already saw every reachable driver
+            pendingTrips.push(trip->getId(), trip->getRequestedAt(), trip->getPriority());
         }
     }
 
-    if (driver) {
-        rollbackManager.recordAction(tripId, driver->getId(), TripStatus::ASSIGNED, TripStatus::COMPLETED);
-        trip->setStatus(TripStatus::COMPLETED);
-        driver->setStatus(DriverStatus::AVAILABLE);
-        driver->setLocation(trip->getDropoffLocationId());
+    delete[] numCandidates;
+    delete[] candidates;
+    delete[] tasks;
+    delete[] fill;
+    delete[] positions;
+    delete[] limits;
+    delete[] zoneStart;
+    return dispatched;
+}
+
+bool RideShareSystem::pickupRider(int tripId) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    Trip* trip = findTrip(tripId);
+
+    if (!trip || trip->getStatus() != TripStatus::ASSIGNED) return false;
+
+    int row = driverTable.findRow(trip->getDriverId());
+    if (row == -1) return false;
+    setDriverLocation(row, trip->getPickupLocationId());
+    drivers[row]->boardTrip(tripId);
+    setTripStatus(trip, TripStatus::ONGOING);
+    return true;
+}
+
+bool RideShareSystem::completeTrip(int tripId) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    Trip* trip = findTrip(tripId);
+
+    if (!trip || (trip->getStatus() != TripStatus::ASSIGNED && trip->getStatus() != TripStatus::ONGOING)) return false;
+
+    int row = driverTable.findRow(trip->getDriverId());
+    if (row != -1) {
+        rollbackManager.recordAction(tripId, trip->getDriverId(), trip->getStatus(), TripStatus::COMPLETED);
+        setTripStatus(trip, TripStatus::COMPLETED);
+        trip->setFinishedAt(clock());
+        // Move first so the AVAILABLE event reports the drop-off node
+        setDriverLocation(row, trip->getDropoffLocationId());
+        releaseDriverLocked(row, tripId);
         return true;
     }
     return false;
 }
 
 bool RideShareSystem::cancelTrip(int tripId) {
-    Trip* trip = nullptr;
-    for (int i = 0; i < numTrips; ++i) {
-        if (trips[i]->getId() == tripId) {
-            trip = trips[i];
-            break;
-        }
-    }
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    Trip* trip = findTrip(tripId);
 
     if (!trip || (trip->getStatus() != TripStatus::REQUESTED && trip->getStatus() != TripStatus::ASSIGNED)) return false;
 
@@ -121,42 +702,39 @@ bool RideShareSystem::cancelTrip(int tripId) {
     int driverId = trip->getDriverId();
 
     rollbackManager.recordAction(tripId, driverId, oldStatus, TripStatus::CANCELLED);
-    trip->setStatus(TripStatus::CANCELLED);
+    setTripStatus(trip, TripStatus::CANCELLED);
+    trip->setFinishedAt(clock());
+    pendingTrips.remove(tripId);
+    zoneStats.recordCancellation(trip->getPickupZoneId(), trip->getFinishedAt());
+    if (oldStatus == TripStatus::REQUESTED) pricing.requestClosed(trip->getPickupZoneId(), trip->getFinishedAt());
     
     if (driverId != -1) {
-        for (int i = 0; i < numDrivers; ++i) {
-            if (drivers[i]->getId() == driverId) {
-                drivers[i]->setStatus(DriverStatus::AVAILABLE);
-                break;
-            }
-        }
+        int row = driverTable.findRow(driverId);
+        if (row != -1) releaseDriverLocked(row, tripId);
     }
     return true;
 }
 
 bool RideShareSystem::undoLastAction() {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
     int tripId, driverId;
     TripStatus oldStatus, newStatus;
     if (rollbackManager.rollback(tripId, driverId, oldStatus, newStatus)) {
-        Trip* trip = nullptr;
-        for (int i = 0; i < numTrips; ++i) {
-            if (trips[i]->getId() == tripId) {
-                trip = trips[i];
-                break;
-            }
-        }
+        Trip* trip = findTrip(tripId);
 
         if (trip) {
-            trip->setStatus(oldStatus);
+            setTripStatus(trip, oldStatus);
+            if (oldStatus == TripStatus::REQUESTED) pricing.requestOpened(trip->getPickupZoneId(), clock());
             if (newStatus == TripStatus::ASSIGNED && oldStatus == TripStatus::REQUESTED) {
                 // Undo dispatch
-                for (int i = 0; i < numDrivers; ++i) {
-                    if (drivers[i]->getId() == driverId) {
-                        drivers[i]->setStatus(DriverStatus::AVAILABLE);
-                        break;
-                    }
-                }
-                trip->setDriverId(-1);
+                int row = driverTable.findRow(driverId);
+                if (row != -1) releaseDriverLocked(row, tripId);
+                setTripDriver(trip, -1);
+                trip->setPickupDistance(-1);
+            }
+            // Back in the queue so a freed driver can pick it up again
+            if (oldStatus == TripStatus::REQUESTED) {
+                pendingTrips.push(trip->getId(), trip->getRequestedAt(), trip->getPriority());
             }
             // Add more undo logic as needed
             return true;
@@ -165,7 +743,429 @@ bool RideShareSystem::undoLastAction() {
     return false;
 }
 
+void RideShareSystem::setMaxPickupDistance(int distance) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    maxPickupDistance = distance;
+}
+
+bool RideShareSystem::setZoneMaxPickupDistance(const std::string& zone, int distance) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    int zoneId = city.findZone(zone);
+    if (zoneId == -1) return false;
+
+    if (zoneId >= numZonePickupLimits) {
+        int newSize = city.getNumZones();
+        int* grown = new int[newSize];
+        for (int i = 0; i < newSize; ++i) grown[i] = i < numZonePickupLimits ? zonePickupLimits[i] : -1;
+        delete[] zonePickupLimits;
+        zonePickupLimits = grown;
+        numZonePickupLimits = newSize;
+    }
+    zonePickupLimits[zoneId] = distance;
+    return true;
+}
+
+int RideShareSystem::pickupLimitFor(int zoneId) const {
+    if (zoneId >= 0 && zoneId < numZonePickupLimits && zonePickupLimits[zoneId] >= 0) {
+        return zonePickupLimits[zoneId];
+    }
+    return maxPickupDistance;
+}
+
+bool RideShareSystem::quoteTrip(int pickupId, int dropoffId, TripQuote& out) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    out = TripQuote{-1, -1, -1, 0.0, 1.0};
+    if (!city.hasNode(pickupId) || !city.hasNode(dropoffId)) return false;
+
+    int zone = city.getZoneId(pickupId);
+    DriverMatch nearest;
+    if (DispatchEngine::findKNearestDrivers(city, pickupId, driverTable, 1, &nearest, pickupLimitFor(zone)) == 1) {
+        out.driverId = nearest.driverId;
+        out.pickupEta = nearest.distance;
+    }
+
+    out.distance = distanceCache.get(city, pickupId, dropoffId);
+    if (out.distance == DistanceCache::UNREACHABLE) return false;
+    FareQuote fare = pricing.quote(zone, out.distance);
+    out.fare = fare.fare;
+    out.multiplier = fare.multiplier;
+    return true;
+}
+
+int RideShareSystem::findNearestDrivers(int pickupId, int k, DriverMatch* out) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return DispatchEngine::findKNearestDrivers(city, pickupId, driverTable, k, out);
+}
+
+void RideShareSystem::buildSpatialIndex() {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    MapMatcher* next = new MapMatcher();
+    next->build(city);
+
+    MapMatcher* old = mapMatcher.exchange(next, std::memory_order_acq_rel);
+    if (old) {
+        MapMatcher** grown = new MapMatcher*[numRetiredMatchers + 1];
+        for (int i = 0; i < numRetiredMatchers; ++i) grown[i] = retiredMatchers[i];
+        grown[numRetiredMatchers++] = old;
+        delete[] retiredMatchers;
+        retiredMatchers = grown;
+    }
+}
+
+int RideShareSystem::snapToNode(double lat, double lon) const {
+    const MapMatcher* matcher = mapMatcher.load(std::memory_order_acquire);
+    return matcher ? matcher->nearestNode(lat, lon) : -1;
+}
+
+void RideShareSystem::snapBatch(const double* lats, const double* lons, int count, int* outNodeIds) const {
+    const MapMatcher* matcher = mapMatcher.load(std::memory_order_acquire);
+    if (matcher) {
+        matcher->matchBatch(lats, lons, count, outNodeIds);
+    } else {
+        for (int i = 0; i < count; ++i) outNodeIds[i] = -1;
+    }
+}
+
+int RideShareSystem::applyLocationBatch(const LocationPing* pings, int count) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    // One DRIVER_LOCATION event per moved driver, from its position before
+    // the batch to its final one, rather than one per ping
+    int* movedRows = new int[count > 0 ? count : 1];
+    int* movedFrom = new int[count > 0 ? count : 1];
+    int numMoved = 0;
+    int applied = 0;
+    for (int i = 0; i < count; ++i) {
+        const LocationPing& ping = pings[i];
+        int row = driverTable.findRow(ping.driverId);
+        if (row == -1 || !city.hasNode(ping.nodeId)) continue;
+        if (ping.timestamp <= driverTable.getLastPingAt(row)) continue;
+
+        if (batchMoveSlots[row] == 0) {
+            movedRows[numMoved] = row;
+            movedFrom[numMoved] = driverTable.getLocation(row);
+            batchMoveSlots[row] = ++numMoved;
+        }
+        driverTable.setLastPingAt(row, ping.timestamp);
+        setDriverLocation(row, ping.nodeId, false);
+        applied++;
+    }
+
+    long long now = clock();
+    for (int i = 0; i < numMoved; ++i) {
+        int row = movedRows[i];
+        batchMoveSlots[row] = 0;
+        int locId = driverTable.getLocation(row);
+        if (locId == movedFrom[i]) continue;
+        StateEvent event = {EventType::DRIVER_LOCATION, driverTable.getId(row), movedFrom[i], locId, locId, now, -1};
+        eventBus.publish(event);
+    }
+    delete[] movedRows;
+    delete[] movedFrom;
+    return applied;
+}
+
+void RideShareSystem::setArchivePath(const std::string& path) {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    archive.setFilePath(path);
+}
+
+void RideShareSystem::setHistoryPath(const std::string& path) {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    history.setFilePath(path);
+}
+
+int RideShareSystem::compactTrips() {
+    std::unique_lock<std::shared_mutex> lock(stateMutex);
+
+    long long cutoff = clock() - tripRetentionMs;
+    int kept = 0;
+    int archived = 0;
+    for (int i = 0; i < numTrips; ++i) {
+        if (trips[i]->isTerminal() && trips[i]->getFinishedAt() <= cutoff) archived++;
+    }
+    if (archived == 0) return 0;
+
+    // Detach the trips under the state lock; they are written out (and the
+    // archive may spill to disk) after it is released
+    Trip** removed = new Trip*[archived];
+    int numRemoved = 0;
+    for (int i = 0; i < numTrips; ++i) {
+        Trip* trip = trips[i];
+        if (trip->isTerminal() && trip->getFinishedAt() <= cutoff) {
+            tripStatusCounts[static_cast<int>(trip->getStatus())]--;
+            removed[numRemoved++] = trip;
+        } else {
+            trips[kept++] = trip;
+        }
+    }
+    numTrips = kept;
+    archivedTrips += archived;
+    rebuildTripIndexesLocked();
+    // Their undo entries could no longer be applied
+    rollbackManager.discard(isArchivedAction, this);
+
+    // Taken before the state lock is released so concurrent compactions
+    // append in trip order
+    std::lock_guard<std::mutex> archiveLock(archiveMutex);
+    lock.unlock();
+    for (int i = 0; i < numRemoved; ++i) {
+        const ArchivedTrip& record = archive.append(*removed[i]);
+        if (history.isOpen()) history.append(record);
+        delete removed[i];
+    }
+    delete[] removed;
+    return archived;
+}
+
+bool RideShareSystem::isArchivedAction(const Action& action, void* ctx) {
+    return static_cast<RideShareSystem*>(ctx)->findTrip(action.tripId) == nullptr;
+}
+
+bool RideShareSystem::flushArchive() {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    return archive.flush();
+}
+
+bool RideShareSystem::flushHistory() {
+    std::lock_guard<std::mutex> lock(archiveMutex);
+    return history.flush();
+}
+
+int RideShareSystem::rebalance() {
+    // Runs are serialized by rebalanceMutex, so the zone costs can be rebuilt
+    // and the plan computed under the shared lock; only publishing the
+    // suggestions takes it exclusively
+    std::lock_guard<std::mutex> runLock(rebalanceMutex);
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    if (zoneCostsStale) {
+        rebalancer.buildZoneCosts(city);
+        zoneCostsStale = false;
+    }
+    int numZones = rebalancer.getNumZones();
+
+    // Supply: idle drivers by the zone they are standing in
+    int* idleRows = new int[driverTable.size()];
+    int numIdle = driverTable.filterCandidates(DriverStatus::AVAILABLE, ALL_VEHICLE_CLASSES, idleRows);
+    int* idleZone = new int[numIdle];
+    int* supply = new int[numZones]();
+    for (int i = 0; i < numIdle; ++i) {
+        idleZone[i] = city.getZoneId(driverTable.getLocation(idleRows[i]));
+        if (idleZone[i] >= 0 && idleZone[i] < numZones) supply[idleZone[i]]++;
+    }
+
+    // Demand forecast: requests per pickup zone over the recent window
+    double* demand = new double[numZones];
+    long long now = clock();
+    for (int z = 0; z < numZones; ++z) {
+        demand[z] = static_cast<double>(zoneStats.getCount(z, ZC_REQUESTS, now, demandWindowMs));
+    }
+
+    ZoneMove* moves = new ZoneMove[numZones * numZones + 1];
+    int numMoves = rebalancer.plan(supply, demand, maxRepositionsPerRun, moves, numZones * numZones + 1);
+
+    // Turn zone flows into concrete drivers: those closest to the target zone
+    RepositionSuggestion* planned = new RepositionSuggestion[maxRepositionsPerRun > 0 ? maxRepositionsPerRun : 1];
+    int numPlanned = 0;
+    int* targets = new int[numIdle + 1];
+    for (int m = 0; m < numMoves; ++m) {
+        int targetNode = rebalancer.getRepresentative(moves[m].toZone);
+        int numTargets = 0;
+        for (int i = 0; i < numIdle; ++i) {
+            if (idleZone[i] == moves[m].fromZone) targets[numTargets++] = driverTable.getLocation(idleRows[i]);
+        }
+        distanceCache.prefetch(city, targetNode, targets, numTargets);
+
+        for (int n = 0; n < moves[m].drivers && numPlanned < maxRepositionsPerRun; ++n) {
+            int pick = -1, pickCost = 0;
+            for (int i = 0; i < numIdle; ++i) {
+                if (idleZone[i] != moves[m].fromZone) continue;
+                int cost = distanceCache.get(city, driverTable.getLocation(idleRows[i]), targetNode);
+                if (cost == DistanceCache::UNREACHABLE) continue;
+                if (pick == -1 || cost < pickCost) {
+                    pick = i;
+                    pickCost = cost;
+                }
+            }
+            if (pick == -1) break;
+            idleZone[pick] = -1;  // one suggestion per driver
+            planned[numPlanned++] = RepositionSuggestion{driverTable.getId(idleRows[pick]), moves[m].fromZone,
+                                                         moves[m].toZone, targetNode, pickCost};
+        }
+    }
+    lock.unlock();
+
+    delete[] targets;
+    delete[] moves;
+    delete[] demand;
+    delete[] supply;
+    delete[] idleZone;
+    delete[] idleRows;
+
+    std::lock_guard<std::shared_mutex> writeLock(stateMutex);
+    delete[] suggestions;
+    suggestions = planned;
+    numSuggestions = numPlanned;
+    rebalancedAt = now;
+    return numPlanned;
+}
+
+int RideShareSystem::getRepositionSuggestions(RepositionSuggestion* out, int maxOut, long long* generatedAt) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    int count = numSuggestions < maxOut ? numSuggestions : maxOut;
+    for (int i = 0; i < count; ++i) out[i] = suggestions[i];
+    if (generatedAt) *generatedAt = rebalancedAt;
+    return count;
+}
+
+int RideShareSystem::getNumZones() {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return city.getNumZones();
+}
+
+int RideShareSystem::getNodeCount() {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return city.getNumNodes();
+}
+
+int RideShareSystem::getEdgeCount() {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return city.getNumEdges();
+}
+
+std::string RideShareSystem::getZoneName(int zoneId) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return zoneId >= 0 && zoneId < city.getNumZones() ? city.getZoneName(zoneId) : "";
+}
+
+int RideShareSystem::getDriversChangedSince(unsigned long long since, DriverView* out, unsigned long long& version) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    version = driverVersion.load(std::memory_order_relaxed);
+    int count = 0;
+    for (int row = 0; row < numDrivers; ++row) {
+        if (driverRowVersions[row] <= since) continue;
+        const Driver* driver = drivers[row];
+        DriverView& view = out[count++];
+        view.row = row;
+        view.id = driver->getId();
+        view.name = driver->getName();
+        view.status = driver->getStatus();
+        view.vehicleClass = driver->getVehicleClass();
+        view.nodeId = driver->getCurrentLocationId();
+        int nodeIdx = city.getNodeIndex(view.nodeId);
+        view.nodeName = nodeIdx != -1 ? city.getNodeAt(nodeIdx).name : "";
+        int zone = city.getZoneId(view.nodeId);
+        view.zone = zone != -1 ? city.getZoneName(zone) : "";
+    }
+    return count;
+}
+
+void RideShareSystem::readCity(CityReader reader, void* ctx, unsigned long long& version) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    version = cityVersion.load(std::memory_order_relaxed);
+    reader(city, ctx);
+}
+
+bool RideShareSystem::getTripSnapshot(int tripId, Trip& out) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    Trip* trip = findTrip(tripId);
+    if (!trip) return false;
+    out = *trip;
+    return true;
+}
+
+int RideShareSystem::queryTrips(const TripQuery& query, Trip* out, int maxOut, int& nextCursor) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    nextCursor = -1;
+    if (maxOut <= 0) return 0;
+
+    // Id window: after the cursor and inside the time range, which maps to
+    // ids because request times grow with trip ids
+    int lowId = query.afterTripId >= 0 ? query.afterTripId + 1 : INT_MIN;
+    int highId = INT_MAX;  // exclusive
+    if (query.fromMs >= 0) {
+        int pos = firstTripRequestedAt(query.fromMs);
+        if (pos == numTrips) return 0;
+        if (trips[pos]->getId() > lowId) lowId = trips[pos]->getId();
+    }
+    if (query.toMs >= 0) {
+        int pos = firstTripRequestedAt(query.toMs);
+        if (pos < numTrips) highId = trips[pos]->getId();
+    }
+
+    // Scan the smallest index that applies, or the whole trip table
+    const TripIdIndex* indexes[4] = {&tripsByStatus, &tripsByDriver, &tripsByRider, &tripsByZone};
+    int keys[4] = {query.status, query.driverId, query.riderId, query.zoneId};
+    const int* ids = nullptr;
+    int size = -1;
+    for (int k = 0; k < 4; ++k) {
+        if (keys[k] == -1) continue;
+        int n;
+        const int* list = indexes[k]->get(keys[k], n);
+        if (size == -1 || n < size) {
+            ids = list;
+            size = n;
+        }
+    }
+    bool useTable = size == -1;
+    int end = useTable ? numTrips : size;
+    int lo = 0, hi = end;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if ((useTable ? trips[mid]->getId() : ids[mid]) < lowId) lo = mid + 1;
+        else hi = mid;
+    }
+
+    // Scans one match past a full page, so the cursor is only returned when
+    // another page really exists
+    int count = 0;
+    for (int i = lo; i < end; ++i) {
+        int id = useTable ? trips[i]->getId() : ids[i];
+        if (id >= highId) break;
+        const Trip* trip = useTable ? trips[i] : findTrip(id);
+        if (!trip) continue;
+        if (query.status != -1 && static_cast<int>(trip->getStatus()) != query.status) continue;
+        if (query.driverId != -1 && trip->getDriverId() != query.driverId) continue;
+        if (query.riderId != -1 && trip->getRiderId() != query.riderId) continue;
+        if (query.zoneId != -1 && trip->getPickupZoneId() != query.zoneId) continue;
+        if (query.fromMs >= 0 && trip->getRequestedAt() < query.fromMs) continue;
+        if (query.toMs >= 0 && trip->getRequestedAt() >= query.toMs) continue;
+        if (count == maxOut) {
+            nextCursor = out[count - 1].getId();
+            break;
+        }
+        out[count++] = *trip;
+    }
+    return count;
+}
+
+int RideShareSystem::findZone(const std::string& zone) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return city.findZone(zone);
+}
+
+void RideShareSystem::setFareSchedule(const FareSchedule& schedule) {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    pricing.setSchedule(schedule);
+    pricing.refresh(city.getNumZones(), clock());
+}
+
+void RideShareSystem::refreshSurge() {
+    std::lock_guard<std::shared_mutex> lock(stateMutex);
+    pricing.refresh(city.getNumZones(), clock());
+}
+
+int RideShareSystem::getActiveTripCount() {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return numTrips;
+}
+
+int RideShareSystem::getPendingTripCount() {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
+    return pendingTrips.getSize();
+}
+
 void RideShareSystem::displayStatus() {
+    std::shared_lock<std::shared_mutex> lock(stateMutex);
     std::cout << "\n--- System Status ---\n";
     std::cout << "Drivers: " << numDrivers << ", Riders: " << numRiders << ", Trips: " << numTrips << "\n";
     for (int i = 0; i < numTrips; ++i) {
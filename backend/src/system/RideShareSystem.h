@@ -6,7 +6,98 @@
 #include "../core/Rider.h"
 #include "../core/Trip.h"
 #include "../engine/DispatchEngine.h"
+#include "../engine/DistanceCache.h"
+#include "../engine/DriverTable.h"
+#include "../engine/EventBus.h"
+#include "../engine/MapMatcher.h"
+#include "../engine/PendingTripQueue.h"
+#include "../engine/PoolingEngine.h"
+#include "../engine/PricingEngine.h"
+#include "../engine/RebalancingEngine.h"
 #include "../engine/RollbackManager.h"
+#include "../engine/TripIdIndex.h"
+#include "../engine/WorkStealingPool.h"
+#include "../engine/ZoneStats.h"
+#include "../storage/TripArchive.h"
+#include "../storage/TripHistoryStore.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+// Returns the current time in milliseconds; replaceable for simulation
+typedef long long (*ClockFn)();
+
+long long systemClockMillis();
+
+// One position report from a driver's device
+struct LocationPing {
+    int driverId;
+    int nodeId;
+    long long timestamp;
+};
+
+// Price and ETA for a prospective trip; nothing is reserved
+struct TripQuote {
+    int driverId;      // nearest available driver, -1 if none in range
+    int pickupEta;     // that driver's travel cost to the pickup, -1 if none
+    int distance;      // pickup -> dropoff travel cost, -1 if unreachable
+    double fare;
+    double multiplier;
+};
+
+// One entry of a batched trip request
+struct TripRequestItem {
+    int riderId;
+    int pickupId;
+    int dropoffId;
+    int priority;
+    bool pooled;
+    int maxDetourPct;  // pooled requests only
+};
+
+// Outcome of one batched request
+struct TripRequestResult {
+    int tripId;    // -1 if the trip table was full
+    int driverId;  // -1 if the trip is waiting in the pending queue
+    double distance;
+    double fare;
+};
+
+// Filters for queryTrips; -1 leaves a field unconstrained. Times bound
+// requestedAt: fromMs inclusive, toMs exclusive.
+struct TripQuery {
+    int status;  // a TripStatus value
+    int driverId;
+    int riderId;
+    int zoneId;  // pickup zone
+    long long fromMs;
+    long long toMs;
+    int afterTripId;  // cursor returned with the previous page
+};
+
+// Copy of one driver's public state, for read-only APIs
+struct DriverView {
+    int row;  // stable position in the driver table
+    int id;
+    std::string name;
+    DriverStatus status;
+    VehicleClass vehicleClass;
+    int nodeId;
+    std::string nodeName;
+    std::string zone;
+};
+
+// Reads the city under the state lock; must not call back into the system
+typedef void (*CityReader)(const City& city, void* ctx);
+
+// Advice to move an idle driver toward a zone with more expected demand
+struct RepositionSuggestion {
+    int driverId;
+    int fromZone;
+    int toZone;
+    int targetNodeId;  // the destination zone's representative node
+    int cost;          // travel cost from the driver to targetNodeId
+};
 
 class RideShareSystem {
 private:
@@ -14,31 +105,268 @@ private:
     Driver** drivers;
     int numDrivers;
     int driverCapacity;
+    DriverTable driverTable;
     
     Rider** riders;
     int numRiders;
     int riderCapacity;
     
+    // Live trips in id order (ids are assigned increasingly and compaction
+    // keeps the order), so lookups by id and by request time are binary searches
     Trip** trips;
     int numTrips;
     int tripCapacity;
+    int nextTripId;
+
+    // Live trip ids per status, driver, rider and pickup zone for queryTrips;
+    // rebuilt whenever compaction archives trips
+    TripIdIndex tripsByStatus;
+    TripIdIndex tripsByDriver;
+    TripIdIndex tripsByRider;
+    TripIdIndex tripsByZone;
     
     RollbackManager rollbackManager;
+    PendingTripQueue pendingTrips;
+
+    // Dispatch ignores drivers farther than this from the pickup (-1 = no
+    // limit). Per-zone limits override it; -1 there means "use the global".
+    int maxPickupDistance;
+    int* zonePickupLimits;
+    int numZonePickupLimits;
+    int pickupLimitFor(int zoneId) const;
+
+    // Terminal trips older than tripRetentionMs are moved out of `trips`
+    TripArchive archive;
+    TripHistoryWriter history;
+    long long tripRetentionMs;
+    ClockFn clock;
+
+    // Mutations take it exclusively; lookups that only read state (quotes,
+    // nearest drivers, snapshots) share it
+    std::shared_mutex stateMutex;
+    std::mutex archiveMutex;
+
+    // Driver state changes are published here; dispatch subscribes to
+    // AVAILABLE transitions to serve pending trips
+    EventBus eventBus;
+    static void onDriverEvent(const StateEvent& event, void* ctx);
+
+    // Published once built; replaced indexes are kept alive until destruction
+    // so lock-free readers never see a freed matcher
+    std::atomic<MapMatcher*> mapMatcher;
+    MapMatcher** retiredMatchers;
+    int numRetiredMatchers;
+
+    // Live trips / drivers per status, kept current by the setters below so
+    // exporters can read them without the state lock
+    std::atomic<long long> tripStatusCounts[NUM_TRIP_STATUSES];
+    std::atomic<long long> driverStatusCounts[NUM_DRIVER_STATUSES];
+    std::atomic<long long> archivedTrips;
+
+    // Bumped on every driver (or city) change so cached views can tell when
+    // to re-render. Each driver row records the version of its last change.
+    std::atomic<unsigned long long> driverVersion;
+    std::atomic<unsigned long long> cityVersion;
+    unsigned long long* driverRowVersions;
+    void touchDriverLocked(int row);
+
+    // Per driver row: 1 + its index among the drivers moved by the location
+    // batch being applied, or 0
+    int* batchMoveSlots;
+
+    // Keep Driver objects and the dispatch table in sync
+    void setDriverStatus(int row, DriverStatus s);
+    // publish = false skips the DRIVER_LOCATION event; the caller reports the move
+    void setDriverLocation(int row, int locId, bool publish = true);
+
+    // Pairwise node distances for pricing and pooled route planning;
+    // invalidated when edges are added. Safe to fill under a shared lock.
+    DistanceCache distanceCache;
+
+    // Requests, dispatches, cancellations and waits per pickup zone over a
+    // sliding window; updated in O(1) and readable without stateMutex
+    ZoneStats zoneStats;
+    // Surge multipliers; fed by driver status/location and trip transitions
+    PricingEngine pricing;
+
+    // Zone travel costs are rebuilt on the first rebalance after the city
+    // changes; the latest plan is kept for readers. rebalanceMutex
+    // serializes runs, which plan under the shared state lock.
+    RebalancingEngine rebalancer;
+    bool zoneCostsStale;
+    std::mutex rebalanceMutex;
+    long long demandWindowMs;
+    int maxRepositionsPerRun;
+    RepositionSuggestion* suggestions;
+    int numSuggestions;
+    long long rebalancedAt;
+
+    // Batch dispatch searches run here, one task per slice of a pickup zone.
+    // Created on first use so callers that never batch don't start threads.
+    WorkStealingPool* dispatchPool;
+    int dispatchThreads;
+
+    Trip* findTrip(int tripId);
+    Trip* createTripLocked(int riderId, int pickupId, int dropoffId, int priority);
+    void setTripStatus(Trip* trip, TripStatus s);
+    void setTripDriver(Trip* trip, int driverId);
+    void rebuildTripIndexesLocked();
+    // ActionFilter matching undo entries whose trip has been archived
+    static bool isArchivedAction(const Action& action, void* ctx);
+    // Position of the first live trip requested at or after ms
+    int firstTripRequestedAt(long long ms) const;
+    void publishTripEvent(const Trip* trip, int oldStatus);
+    // Sets the routed distance and the fare quoted at request time
+    void priceTripLocked(Trip* trip);
+    void assignDriverLocked(Trip* trip, int row, int pickupDistance);
+    // Pooled trips go through dispatchPooledLocked with their stored ride
+    // limit; either way an unserved trip is queued
+    bool dispatchTripLocked(Trip* trip);
+    bool dispatchPooledLocked(Trip* trip, int maxRide);
+    // Marks a new trip pooled and dispatches it; queues it if no route fits
+    bool requestPooledLocked(Trip* trip, int maxDetourPct);
+    // Frees the driver once the trip's stops were its last ones
+    void releaseDriverLocked(int row, int tripId);
+    // Dispatches the longest-waiting pending trip that can be served
+    int retryPendingTrips();
+    int dispatchPendingLocked();
+    // Searches candidates for a batch of requested solo trips in parallel and
+    // assigns them in batch order; unserved trips are queued
+    int dispatchBatchLocked(Trip** batch, int count);
+    // Warms the distance cache for a batch's trips: one search per pickup
+    void prefetchTripDistancesLocked(const TripRequestItem* items, int count);
 
 public:
-    RideShareSystem();
+    // Capacities bound the city graph and the driver/rider/trip tables; the
+    // defaults suit the demo city, generated cities pass their own
+    RideShareSystem(int nodeCapacity = 100, int driverCapacity = 100, int riderCapacity = 100, int tripCapacity = 100);
     ~RideShareSystem();
 
-    void addNode(int id, std::string name, std::string zone);
+    void addNode(int id, std::string name, std::string zone, double lat = 0.0, double lon = 0.0);
     void addEdge(int from, int to, int weight);
-    void addDriver(int id, std::string name, int locId, std::string vehicle);
+    void addDriver(int id, std::string name, int locId, std::string vehicle, VehicleClass vClass = VehicleClass::ECONOMY);
     void addRider(int id, std::string name, int locId);
     
-    int requestTrip(int riderId, int pickupId, int dropoffId);
+    int requestTrip(int riderId, int pickupId, int dropoffId, int priority = 0);
+    // Requests and immediately dispatches a shared ride. The trip is inserted
+    // into the route of an idle or already-pooling driver wherever it adds the
+    // least distance, as long as no rider's in-vehicle distance exceeds their
+    // direct distance by more than maxDetourPct percent. If no route fits,
+    // the trip waits in the pending queue and every retry is pooled under the
+    // same limit.
+    int requestPooledTrip(int riderId, int pickupId, int dropoffId, int maxDetourPct = 50);
     bool dispatchTrip(int tripId);
+    // Creates and dispatches a batch of requests under one lock acquisition.
+    // Solo trips share one candidate search per distinct pickup and are
+    // assigned in request order; pooled trips are then inserted one at a
+    // time. Unserved trips wait in the pending queue. Writes one result per
+    // item and returns the number of trips dispatched.
+    int requestTrips(const TripRequestItem* items, int count, TripRequestResult* results);
+    // Driver reached the pickup: moves it there, takes the pickup stop off a
+    // pooled route and marks the trip ONGOING. Not undoable.
+    bool pickupRider(int tripId);
     bool completeTrip(int tripId);
     bool cancelTrip(int tripId);
     bool undoLastAction();
+
+    // Retries every pending trip in one pass. Candidate searches for each
+    // pickup zone run in parallel; drivers are then assigned sequentially in
+    // queue order (longest wait first, then trip id), so the outcome does not
+    // depend on thread timing. Returns the number of trips dispatched.
+    int dispatchPendingTrips();
+    int getNumZones();
+    int getNodeCount();
+    int getEdgeCount();
+    long long getTripCount(TripStatus s) const { return tripStatusCounts[static_cast<int>(s)].load(std::memory_order_relaxed); }
+    long long getDriverCount(DriverStatus s) const { return driverStatusCounts[static_cast<int>(s)].load(std::memory_order_relaxed); }
+    long long getArchivedTripCount() const { return archivedTrips.load(std::memory_order_relaxed); }
+    long long getDistanceCacheHits() const { return distanceCache.getHits(); }
+    long long getDistanceCacheMisses() const { return distanceCache.getMisses(); }
+    long long getEventQueueDepth() const { return eventBus.getDepth(); }
+    long long getEventsDropped() const { return eventBus.getDropped(); }
+    double getSurgeMultiplier(int zoneId) const { return pricing.getMultiplier(zoneId); }
+    void setFareSchedule(const FareSchedule& schedule);
+    // Re-evaluates every zone's multiplier so old requests age out
+    void refreshSurge();
+    // Sliding-window counters for a zone (window capped at the stats window)
+    ZoneWindow getZoneWindow(int zoneId, long long windowMs) const { return zoneStats.getWindow(zoneId, clock(), windowMs); }
+    long long getStatsWindowMs() const { return zoneStats.getWindowMs(); }
+
+    // Recomputes reposition suggestions: idle drivers per zone against the
+    // requests seen in the demand window, balanced by a min-cost flow over
+    // zone travel costs. Returns the number of suggestions.
+    int rebalance();
+    // Copies the latest suggestions; returns how many were written
+    int getRepositionSuggestions(RepositionSuggestion* out, int maxOut, long long* generatedAt = nullptr);
+    std::string getZoneName(int zoneId);
+
+    int getDriverCapacity() const { return driverCapacity; }
+    unsigned long long getDriverVersion() const { return driverVersion.load(std::memory_order_acquire); }
+    unsigned long long getCityVersion() const { return cityVersion.load(std::memory_order_acquire); }
+    // Copies drivers changed after version `since` (0 = every driver) into
+    // out, which must hold getDriverCapacity() entries. version receives the
+    // version the copy reflects. Returns the number copied.
+    int getDriversChangedSince(unsigned long long since, DriverView* out, unsigned long long& version);
+    // Runs reader against the city under a shared lock; version receives the
+    // city version it saw
+    void readCity(CityReader reader, void* ctx, unsigned long long& version);
+    // Capped at getStatsWindowMs()
+    void setDemandWindow(long long ms) { demandWindowMs = ms; }
+    void setMaxRepositionsPerRun(int moves) { maxRepositionsPerRun = moves; }
+
+    // Worker count for dispatchPendingTrips (<= 0 = hardware concurrency);
+    // takes effect before the first batch
+    void setDispatchThreads(int threads) { dispatchThreads = threads; }
+
+    // Read-only: takes the state lock shared, so quotes run concurrently with
+    // each other. Returns false if either node is unknown or unreachable.
+    bool quoteTrip(int pickupId, int dropoffId, TripQuote& out);
+
+    // Up to k available drivers nearest to pickupId, closest first
+    int findNearestDrivers(int pickupId, int k, DriverMatch* out);
+
+    // Builds the coordinate -> node index; call after the city is loaded
+    void buildSpatialIndex();
+    // Nearest node for raw coordinates (-1 before buildSpatialIndex). Lock-free.
+    int snapToNode(double lat, double lon) const;
+    void snapBatch(const double* lats, const double* lons, int count, int* outNodeIds) const;
+
+    // Applies a batch of position reports under a single lock acquisition.
+    // Pings for unknown drivers or nodes, and pings older than the last one
+    // applied for that driver, are skipped. Returns the number applied.
+    int applyLocationBatch(const LocationPing* pings, int count);
+
+    // Consume driver events on a background thread, or drain them on the
+    // caller's thread with pumpEvents() (e.g. in a single-threaded simulation)
+    void startEventLoop() { eventBus.start(); }
+    void stopEventLoop() { eventBus.stop(); }
+    int pumpEvents() { return eventBus.poll(); }
+    bool subscribeEvents(EventHandler handler, void* ctx) { return eventBus.subscribe(handler, ctx); }
+
+    void setClock(ClockFn fn) { clock = fn; }
+    void setMaxPickupDistance(int distance);
+    bool setZoneMaxPickupDistance(const std::string& zone, int distance);
+    void setTripRetention(long long ms) { tripRetentionMs = ms; }
+    void setArchivePath(const std::string& path);
+    // Archived trips are also appended to this columnar history file
+    void setHistoryPath(const std::string& path);
+
+    // Moves terminal trips older than the retention window into the archive.
+    // Returns the number of trips archived.
+    int compactTrips();
+    bool flushArchive();
+    bool flushHistory();
+    // Copy of a live (not yet archived) trip; false if not found
+    bool getTripSnapshot(int tripId, Trip& out);
+    // Copies up to maxOut live trips matching the query, in trip id order.
+    // The smallest matching index drives the scan, so a page costs time
+    // proportional to its size when one field is filtered. nextCursor
+    // receives the afterTripId for the next page, or -1 after the last one.
+    int queryTrips(const TripQuery& query, Trip* out, int maxOut, int& nextCursor);
+    // Zone id for a zone name, -1 if unknown
+    int findZone(const std::string& zone);
+    int getActiveTripCount();
+    int getPendingTripCount();
     
     void displayStatus();
 };
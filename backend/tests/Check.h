@@ -0,0 +1,30 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+// Minimal assertions for the test binaries: a failed CHECK reports its
+// location and the test keeps running; main() returns testFailures() so
+// `make test` stops at the first failing binary.
+inline int& testFailureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                                  \
+    do {                                                                             \
+        if (!(cond)) {                                                               \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            testFailureCount()++;                                                    \
+        }                                                                            \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) CHECK((actual) == (expected))
+
+inline int testFailures(const char* name) {
+    int failures = testFailureCount();
+    std::printf("%s: %s\n", name, failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,281 @@
+#include "Check.h"
+#include "../src/engine/PendingTripQueue.h"
+#include "../src/engine/PoolingEngine.h"
+#include "../src/system/RideShareSystem.h"
+
+namespace {
+
+void testPopOrder() {
+    PendingTripQueue queue(2);  // forces growth
+    CHECK(queue.empty());
+    CHECK_EQ(queue.pop(), -1);
+
+    CHECK(queue.push(1, 5000));
+    CHECK(queue.push(2, 1000));
+    CHECK(queue.push(3, 3000));
+    CHECK(!queue.push(2, 0));  // already queued
+    CHECK_EQ(queue.getSize(), 3);
+
+    // Longest waiting first
+    CHECK_EQ(queue.top(), 2);
+    CHECK_EQ(queue.pop(), 2);
+    CHECK_EQ(queue.pop(), 3);
+    CHECK_EQ(queue.pop(), 1);
+    CHECK(queue.empty());
+}
+
+void testPriority() {
+    PendingTripQueue queue;
+    long long boost = PendingTripQueue::PRIORITY_BOOST_MS;
+    queue.push(1, 10 * boost);
+    queue.push(2, 11 * boost, 2);  // requested later, but two levels up
+    queue.push(3, 10 * boost + 1, 1);
+    CHECK_EQ(queue.pop(), 2);
+    CHECK_EQ(queue.pop(), 3);
+    CHECK_EQ(queue.pop(), 1);
+}
+
+// Changing a queued trip's priority is a remove and a re-push
+void testUpdate() {
+    PendingTripQueue queue;
+    for (int id = 1; id <= 5; ++id) queue.push(id, id * 1000LL);
+    CHECK(queue.remove(5));
+    CHECK(queue.push(5, 5000, 1));
+    CHECK_EQ(queue.getSize(), 5);
+    CHECK_EQ(queue.pop(), 5);
+    CHECK_EQ(queue.pop(), 1);
+
+    CHECK(queue.remove(2));
+    CHECK(queue.push(2, 2000, -1));
+    CHECK_EQ(queue.pop(), 3);
+    CHECK_EQ(queue.pop(), 4);
+    CHECK_EQ(queue.pop(), 2);
+    CHECK(queue.empty());
+}
+
+void testRemove() {
+    PendingTripQueue queue;
+    for (int id = 1; id <= 100; ++id) queue.push(id, (id * 37) % 101);
+    for (int id = 2; id <= 100; id += 2) CHECK(queue.remove(id));
+    CHECK(!queue.remove(2));
+    CHECK(!queue.remove(1000));
+    CHECK_EQ(queue.getSize(), 50);
+    CHECK(!queue.contains(4));
+    CHECK(queue.contains(5));
+
+    // Remaining odd ids still come out in key order
+    long long lastKey = -1;
+    int popped = 0;
+    while (!queue.empty()) {
+        int id = queue.pop();
+        long long key = (id * 37) % 101;
+        CHECK(id % 2 == 1);
+        CHECK(key > lastKey);
+        lastKey = key;
+        popped++;
+    }
+    CHECK_EQ(popped, 50);
+
+    // Removed ids can be queued again
+    CHECK(queue.push(2, 0));
+    CHECK_EQ(queue.pop(), 2);
+}
+
+// Nodes 1..5 on a line, 10 apart
+void buildLine(City& city) {
+    const char* names[] = {"N1", "N2", "N3", "N4", "N5"};
+    for (int id = 1; id <= 5; ++id) city.addNode(id, names[id - 1], "Zone A");
+    for (int id = 1; id < 5; ++id) city.addEdge(id, id + 1, 10);
+}
+
+RouteStop pickupStop(int tripId, int nodeId) { return RouteStop{tripId, nodeId, true, -1, 0}; }
+RouteStop dropoffStop(int tripId, int nodeId, int maxRide, int ridden = 0) {
+    return RouteStop{tripId, nodeId, false, maxRide, ridden};
+}
+
+// A trip lying along the existing route costs no detour
+void testInsertionOnRoute() {
+    City city;
+    buildLine(city);
+    DistanceCache cache(1024);
+    RouteStop route[] = {pickupStop(1, 2), dropoffStop(1, 5, 30)};
+
+    PoolInsertion best;
+    CHECK(PoolingEngine::findBestInsertion(city, cache, 1, route, 2, 4, 3, 4, 10, -1, best));
+    CHECK_EQ(best.pickupPos, 1);
+    CHECK_EQ(best.dropoffPos, 2);
+    CHECK_EQ(best.addedCost, 0);
+    CHECK_EQ(best.pickupEta, 20);
+    CHECK_EQ(best.rideLength, 10);
+
+    RouteStop out[Driver::MAX_ROUTE_STOPS];
+    CHECK_EQ(PoolingEngine::applyInsertion(route, 2, best, 2, 3, 4, 10, out), 4);
+    int expectedNodes[] = {2, 3, 4, 5};
+    int expectedTrips[] = {1, 2, 2, 1};
+    for (int k = 0; k < 4; ++k) {
+        CHECK_EQ(out[k].nodeId, expectedNodes[k]);
+        CHECK_EQ(out[k].tripId, expectedTrips[k]);
+    }
+}
+
+// An existing rider without slack pushes the new trip behind their dropoff,
+// and a new rider's own limit rejects a long detour
+void testDetourLimits() {
+    City city;
+    buildLine(city);
+    DistanceCache cache(1024);
+    RouteStop route[] = {pickupStop(1, 2), dropoffStop(1, 3, 10)};
+
+    PoolInsertion best;
+    CHECK(PoolingEngine::findBestInsertion(city, cache, 1, route, 2, 4, 4, 5, 10, -1, best));
+    CHECK_EQ(best.pickupPos, 2);
+    CHECK_EQ(best.addedCost, 20);
+
+    // 5 -> 1 needs 40 in the vehicle
+    CHECK(!PoolingEngine::findBestInsertion(city, cache, 1, route, 2, 4, 5, 1, 39, -1, best));
+    CHECK(PoolingEngine::findBestInsertion(city, cache, 1, route, 2, 4, 5, 1, 40, -1, best));
+    // ... and the pickup limit applies to the route distance to the pickup
+    CHECK(!PoolingEngine::findBestInsertion(city, cache, 1, route, 2, 4, 5, 1, 40, 39, best));
+}
+
+// Seats: a full vehicle picks up only after a dropoff
+void testCapacity() {
+    City city;
+    buildLine(city);
+    DistanceCache cache(1024);
+    RouteStop route[] = {dropoffStop(1, 5, -1)};  // rider already aboard
+
+    PoolInsertion best;
+    CHECK(PoolingEngine::findBestInsertion(city, cache, 1, route, 1, 2, 2, 3, -1, -1, best));
+    CHECK_EQ(best.pickupPos, 0);
+    CHECK_EQ(best.pickupEta, 10);
+
+    CHECK(PoolingEngine::findBestInsertion(city, cache, 1, route, 1, 1, 2, 3, -1, -1, best));
+    CHECK_EQ(best.pickupPos, 1);
+    CHECK_EQ(best.pickupEta, 70);
+
+    // Two aboard, one seat each: nothing fits before the first dropoff
+    RouteStop full[] = {dropoffStop(1, 3, -1), dropoffStop(2, 5, -1)};
+    CHECK(PoolingEngine::findBestInsertion(city, cache, 1, full, 2, 2, 2, 3, -1, -1, best));
+    CHECK_EQ(best.pickupPos, 1);
+
+    // The route itself is bounded
+    RouteStop longRoute[Driver::MAX_ROUTE_STOPS];
+    for (int k = 0; k < Driver::MAX_ROUTE_STOPS - 1; ++k) longRoute[k] = dropoffStop(k + 1, 5, -1);
+    CHECK(!PoolingEngine::findBestInsertion(city, cache, 1, longRoute, Driver::MAX_ROUTE_STOPS - 1, 8, 2, 3, -1, -1,
+                                            best));
+}
+
+// A rider already aboard counts the distance ridden so far
+void testRiddenDistance() {
+    City city;
+    buildLine(city);
+    DistanceCache cache(1024);
+    PoolInsertion best;
+
+    // Driver at 2 heading to 3; the new trip 1 -> 2 is behind them
+    RouteStop fresh[] = {dropoffStop(1, 3, 35, 0)};
+    CHECK(PoolingEngine::findBestInsertion(city, cache, 2, fresh, 1, 4, 1, 2, -1, -1, best));
+    CHECK_EQ(best.pickupPos, 0);  // detour first: rider 1 rides 30
+    CHECK_EQ(best.addedCost, 20);
+
+    RouteStop ridden[] = {dropoffStop(1, 3, 35, 10)};
+    CHECK(PoolingEngine::findBestInsertion(city, cache, 2, ridden, 1, 4, 1, 2, -1, -1, best));
+    CHECK_EQ(best.pickupPos, 1);  // 10 + 30 would exceed 35
+    CHECK_EQ(best.addedCost, 30);
+}
+
+// A pooled trip that had to wait is retried as a pooled insertion, so a
+// later pooled request can still share its driver
+void checkPooledRetry(bool sweep) {
+    RideShareSystem system;
+    const char* names[] = {"N1", "N2", "N3", "N4", "N5"};
+    for (int id = 1; id <= 5; ++id) system.addNode(id, names[id - 1], "Zone A");
+    for (int id = 1; id < 5; ++id) system.addEdge(id, id + 1, 10);
+    system.addDriver(7, "Driver", 1, "Sedan");
+    for (int r = 1; r <= 3; ++r) system.addRider(r, "Rider", 1);
+
+    int solo = system.requestTrip(1, 1, 2);
+    CHECK(system.dispatchTrip(solo));
+    int waiting = system.requestPooledTrip(2, 2, 4, 50);
+    Trip trip;
+    CHECK(system.getTripSnapshot(waiting, trip));
+    CHECK(trip.isPooled());
+    CHECK_EQ(trip.getMaxRide(), 30);
+    CHECK_EQ(trip.getDriverId(), -1);
+    CHECK_EQ(system.getPendingTripCount(), 1);
+
+    CHECK(system.completeTrip(solo));
+    if (sweep) {
+        CHECK_EQ(system.dispatchPendingTrips(), 1);
+    } else {
+        system.pumpEvents();  // the freed driver retries the queue
+    }
+    CHECK(system.getTripSnapshot(waiting, trip));
+    CHECK_EQ(trip.getDriverId(), 7);
+    CHECK_EQ(system.getPendingTripCount(), 0);
+
+    int shared = system.requestPooledTrip(3, 3, 4, 50);
+    CHECK(system.getTripSnapshot(shared, trip));
+    CHECK_EQ(trip.getDriverId(), 7);
+}
+
+void testPooledRetry() {
+    checkPooledRetry(false);
+    checkPooledRetry(true);
+}
+
+// Picking a pooled rider up starts their ridden distance, which later
+// insertions into the same route have to respect
+void testPickupTracksRidden() {
+    RideShareSystem system;
+    const char* names[] = {"N1", "N2", "N3", "N4", "N5"};
+    for (int id = 1; id <= 5; ++id) system.addNode(id, names[id - 1], "Zone A");
+    for (int id = 1; id < 5; ++id) system.addEdge(id, id + 1, 10);
+    system.addDriver(7, "Driver", 1, "Sedan");
+    system.addRider(1, "Rider", 1);
+    system.addRider(2, "Rider", 1);
+
+    int first = system.requestPooledTrip(1, 1, 3, 50);  // may ride 30
+    CHECK(!system.pickupRider(first + 1));
+    CHECK(system.pickupRider(first));
+    Trip trip;
+    CHECK(system.getTripSnapshot(first, trip));
+    CHECK(trip.getStatus() == TripStatus::ONGOING);
+    CHECK_EQ(system.getTripCount(TripStatus::ONGOING), 1);
+    CHECK(!system.pickupRider(first));
+    CHECK(!system.cancelTrip(first));
+
+    // Rider 1 has ridden 10, so going back for 1 -> 2 first would make it 40
+    LocationPing ping = {7, 2, 1};
+    CHECK_EQ(system.applyLocationBatch(&ping, 1), 1);
+    int second = system.requestPooledTrip(2, 1, 2, 50);
+    CHECK(system.getTripSnapshot(second, trip));
+    CHECK_EQ(trip.getDriverId(), 7);
+    CHECK_EQ(trip.getPickupDistance(), 30);  // via the dropoff at 3
+
+    // Completing the ongoing trip keeps the driver busy with the second
+    CHECK(system.completeTrip(first));
+    CHECK(system.getTripSnapshot(first, trip));
+    CHECK(trip.getStatus() == TripStatus::COMPLETED);
+    CHECK_EQ(system.getDriverCount(DriverStatus::BUSY), 1);
+    CHECK(system.pickupRider(second));
+    CHECK(system.completeTrip(second));
+    CHECK_EQ(system.getDriverCount(DriverStatus::AVAILABLE), 1);
+}
+
+} // namespace
+
+int main() {
+    testPopOrder();
+    testPriority();
+    testUpdate();
+    testRemove();
+    testInsertionOnRoute();
+    testDetourLimits();
+    testCapacity();
+    testRiddenDistance();
+    testPickupTracksRidden();
+    testPooledRetry();
+    return testFailures("test_dispatch");
+}
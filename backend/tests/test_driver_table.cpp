@@ -0,0 +1,82 @@
+#include "Check.h"
+#include "../src/engine/DriverTable.h"
+
+namespace {
+
+const DriverTable::FilterPath PATHS[] = {DriverTable::FilterPath::AUTO, DriverTable::FilterPath::SCALAR,
+                                         DriverTable::FilterPath::SSE2, DriverTable::FilterPath::AVX2};
+
+// Rows in order whose status and class match, read one field at a time
+int expectedRows(const DriverTable& table, DriverStatus status, unsigned classMask, int* out) {
+    int count = 0;
+    for (int row = 0; row < table.size(); ++row) {
+        if (table.getStatus(row) == status && (classMask & vehicleClassBit(table.getVehicleClass(row)))) {
+            out[count++] = row;
+        }
+    }
+    return count;
+}
+
+// Mixed statuses and classes from a fixed LCG, so every vector lane and the
+// scalar tail see both matches and misses
+void fill(DriverTable& table, int rows) {
+    unsigned seed = 12345u + static_cast<unsigned>(rows);
+    for (int i = 0; i < rows; ++i) {
+        seed = seed * 1103515245u + 12345u;
+        DriverStatus status = static_cast<DriverStatus>((seed >> 16) % NUM_DRIVER_STATUSES);
+        VehicleClass vClass = static_cast<VehicleClass>((seed >> 20) % 3);
+        CHECK_EQ(table.addDriver(1000 + i, i, status, vClass), i);
+    }
+}
+
+void checkSize(int rows) {
+    DriverTable table(4);  // grows past the initial capacity
+    fill(table, rows);
+    int* expected = new int[rows + 1];
+    int* actual = new int[rows + 1];
+    unsigned masks[] = {1u, 2u, 4u, 3u, 5u, 6u, 7u, ALL_VEHICLE_CLASSES, 0u};
+    for (int s = 0; s < NUM_DRIVER_STATUSES; ++s) {
+        DriverStatus status = static_cast<DriverStatus>(s);
+        for (unsigned mask : masks) {
+            int want = expectedRows(table, status, mask, expected);
+            for (DriverTable::FilterPath path : PATHS) {
+                int got = table.filterCandidates(status, mask, actual, path);
+                CHECK_EQ(got, want);
+                for (int k = 0; k < got && k < want; ++k) CHECK_EQ(actual[k], expected[k]);
+            }
+        }
+    }
+    delete[] actual;
+    delete[] expected;
+}
+
+void testSizes() {
+    // Around the 16- and 32-byte vector widths, plus larger odd sizes
+    int sizes[] = {0, 1, 7, 15, 16, 17, 31, 32, 33, 47, 63, 64, 65, 100, 257, 1001};
+    for (int rows : sizes) checkSize(rows);
+}
+
+// Status changes are seen by every path
+void testStatusUpdates() {
+    DriverTable table;
+    fill(table, 70);
+    for (int row = 0; row < 70; ++row) table.setStatus(row, DriverStatus::OFFLINE);
+    table.setStatus(0, DriverStatus::AVAILABLE);
+    table.setStatus(33, DriverStatus::AVAILABLE);
+    table.setStatus(69, DriverStatus::AVAILABLE);
+    int out[70];
+    for (DriverTable::FilterPath path : PATHS) {
+        CHECK_EQ(table.filterCandidates(DriverStatus::AVAILABLE, ALL_VEHICLE_CLASSES, out, path), 3);
+        CHECK_EQ(out[0], 0);
+        CHECK_EQ(out[1], 33);
+        CHECK_EQ(out[2], 69);
+    }
+}
+
+} // namespace
+
+int main() {
+    testSizes();
+    testStatusUpdates();
+    return testFailures("test_driver_table");
+}
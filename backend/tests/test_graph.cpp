@@ -0,0 +1,192 @@
+#include "Check.h"
+#include "../src/core/City.h"
+#include "../src/engine/DispatchEngine.h"
+
+namespace {
+
+//   8 --4-- 1 --4-- 2 --3-- 3 --2-- 5 --5-- 6
+//           |               |
+//           +------10------ 4      7 (isolated)
+// 4 hangs off 3 by 1, so 1 -> 4 is 8 through 2 and 3
+void buildCity(City& city) {
+    for (int id = 1; id <= 8; ++id) city.addNode(id, "N" + std::to_string(id), id <= 4 ? "Zone A" : "Zone B");
+    city.addEdge(1, 2, 4);
+    city.addEdge(2, 3, 3);
+    city.addEdge(1, 4, 10);
+    city.addEdge(4, 3, 1);
+    city.addEdge(3, 5, 2);
+    city.addEdge(5, 6, 5);
+    city.addEdge(1, 8, 4);
+}
+
+void testShortestPath() {
+    City city;
+    buildCity(city);
+    int path[8];
+    int pathLength;
+
+    CHECK_EQ(city.findShortestPath(1, 3, path, pathLength), 7);
+    CHECK_EQ(pathLength, 3);
+    CHECK_EQ(path[0], 1);
+    CHECK_EQ(path[1], 2);
+    CHECK_EQ(path[2], 3);
+
+    // The direct edge is longer than the way round
+    CHECK_EQ(city.findShortestPath(1, 4, path, pathLength), 8);
+    CHECK_EQ(pathLength, 4);
+    CHECK_EQ(path[3], 4);
+
+    CHECK_EQ(city.findShortestPath(6, 8, path, pathLength), 18);
+    CHECK_EQ(path[0], 6);
+    CHECK_EQ(path[pathLength - 1], 8);
+
+    CHECK_EQ(city.findShortestPath(2, 2, path, pathLength), 0);
+    CHECK_EQ(pathLength, 1);
+
+    // Unreachable and unknown nodes
+    CHECK_EQ(city.findShortestPath(1, 7, path, pathLength), -1);
+    CHECK_EQ(pathLength, 0);
+    CHECK_EQ(city.findShortestPath(99, 1, path, pathLength), -1);
+    CHECK_EQ(pathLength, 0);
+}
+
+struct Settled {
+    int count;
+    int dists[8];
+    int stopAfter;  // -1 = never stop
+};
+
+bool recordSettled(int nodeIdx, int dist, void* ctx) {
+    Settled& s = *static_cast<Settled*>(ctx);
+    (void)nodeIdx;
+    s.dists[s.count] = dist;
+    s.count++;
+    return s.stopAfter != -1 && s.count >= s.stopAfter;
+}
+
+Settled search(const City& city, int startId, int maxDist, int stopAfter, int& settled) {
+    Settled s;
+    s.count = 0;
+    s.stopAfter = stopAfter;
+    settled = city.searchFrom(startId, maxDist, recordSettled, &s);
+    return s;
+}
+
+void testBoundedSearch() {
+    City city;
+    buildCity(city);
+    int settled;
+
+    // Unbounded: everything reachable, in nondecreasing distance
+    Settled all = search(city, 1, -1, -1, settled);
+    CHECK_EQ(settled, 7);
+    CHECK_EQ(all.count, 7);
+    for (int i = 1; i < all.count; ++i) CHECK(all.dists[i - 1] <= all.dists[i]);
+    CHECK_EQ(all.dists[0], 0);
+    CHECK_EQ(all.dists[6], 14);
+
+    // The bound is inclusive
+    Settled within7 = search(city, 1, 7, -1, settled);
+    CHECK_EQ(settled, 4);  // 1, 2, 8, 3
+    CHECK_EQ(within7.dists[3], 7);
+    search(city, 1, 8, -1, settled);
+    CHECK_EQ(settled, 5);
+    search(city, 1, 0, -1, settled);
+    CHECK_EQ(settled, 1);
+
+    // The visitor can stop early
+    Settled early = search(city, 1, -1, 2, settled);
+    CHECK_EQ(settled, 2);
+    CHECK_EQ(early.count, 2);
+
+    search(city, 7, -1, -1, settled);
+    CHECK_EQ(settled, 1);
+    search(city, 99, -1, -1, settled);
+    CHECK_EQ(settled, 0);
+}
+
+// Available drivers: 108 at 1, 102 and 103 at 2, 109 at 8 (all three 4 away
+// from 1), 101 at 3, 104 at 6 and 105 on the isolated node 7. 106 and 107
+// are nearby but not available.
+void buildDrivers(DriverTable& table) {
+    table.addDriver(101, 3, DriverStatus::AVAILABLE, VehicleClass::ECONOMY);
+    table.addDriver(102, 2, DriverStatus::AVAILABLE, VehicleClass::ECONOMY);
+    table.addDriver(103, 2, DriverStatus::AVAILABLE, VehicleClass::XL);
+    table.addDriver(104, 6, DriverStatus::AVAILABLE, VehicleClass::ECONOMY);
+    table.addDriver(105, 7, DriverStatus::AVAILABLE, VehicleClass::ECONOMY);
+    table.addDriver(106, 4, DriverStatus::BUSY, VehicleClass::ECONOMY);
+    table.addDriver(107, 5, DriverStatus::OFFLINE, VehicleClass::ECONOMY);
+    table.addDriver(108, 1, DriverStatus::AVAILABLE, VehicleClass::COMFORT);
+    table.addDriver(109, 8, DriverStatus::AVAILABLE, VehicleClass::ECONOMY);
+}
+
+bool isTiedAt4(int driverId) { return driverId == 102 || driverId == 103 || driverId == 109; }
+
+void checkSorted(const DriverMatch* out, int count) {
+    for (int i = 1; i < count; ++i) CHECK(out[i - 1].distance <= out[i].distance);
+}
+
+void testNearestDrivers() {
+    City city;
+    buildCity(city);
+    DriverTable table;
+    buildDrivers(table);
+    DriverMatch out[16];
+
+    // k larger than the available drivers: every reachable one, nearest first
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 1, table, 16, out), 6);
+    checkSorted(out, 6);
+    int expectedDist[] = {0, 4, 4, 4, 7, 14};
+    for (int i = 0; i < 6; ++i) CHECK_EQ(out[i].distance, expectedDist[i]);
+    CHECK_EQ(out[0].driverId, 108);
+    for (int i = 1; i <= 3; ++i) CHECK(isTiedAt4(out[i].driverId));
+    CHECK(out[1].driverId != out[2].driverId && out[2].driverId != out[3].driverId &&
+          out[1].driverId != out[3].driverId);
+    CHECK_EQ(out[4].driverId, 101);
+    CHECK_EQ(out[5].driverId, 104);
+
+    // k cuts through the tie: whichever are returned are tied drivers
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 1, table, 2, out), 2);
+    CHECK_EQ(out[0].driverId, 108);
+    CHECK(isTiedAt4(out[1].driverId));
+    CHECK_EQ(out[1].distance, 4);
+
+    // Bounded search
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 1, table, 16, out, 7), 5);
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 1, table, 16, out, 3), 1);
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 3, table, 16, out, 0), 1);
+    CHECK_EQ(out[0].driverId, 101);
+
+    // Class filter drops 108 and 103
+    unsigned economy = vehicleClassBit(VehicleClass::ECONOMY);
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 1, table, 16, out, -1, economy), 4);
+    CHECK(out[0].driverId == 102 || out[0].driverId == 109);
+    CHECK_EQ(out[0].distance, 4);
+
+    // The isolated node only sees its own driver; unknown pickups see none
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 7, table, 16, out), 1);
+    CHECK_EQ(out[0].driverId, 105);
+    CHECK_EQ(out[0].distance, 0);
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 99, table, 16, out), 0);
+    CHECK_EQ(DispatchEngine::findKNearestDrivers(city, 1, table, 0, out), 0);
+
+    // Single-nearest wrapper agrees
+    Trip trip(1, 1, 6, 1);
+    int distance;
+    CHECK_EQ(DispatchEngine::findNearestDriver(city, trip, table, ALL_VEHICLE_CLASSES, &distance), 104);
+    CHECK_EQ(distance, 0);
+    Trip stranded(2, 1, 7, 1);
+    CHECK_EQ(DispatchEngine::findNearestDriver(city, stranded, table, economy, &distance, -1), 105);
+    table.setStatus(table.findRow(105), DriverStatus::BUSY);
+    CHECK_EQ(DispatchEngine::findNearestDriver(city, stranded, table, ALL_VEHICLE_CLASSES, &distance), -1);
+    CHECK_EQ(distance, -1);
+}
+
+} // namespace
+
+int main() {
+    testShortestPath();
+    testBoundedSearch();
+    testNearestDrivers();
+    return testFailures("test_graph");
+}
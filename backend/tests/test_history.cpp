@@ -0,0 +1,292 @@
+#include "Check.h"
+#include "../src/storage/TripHistoryStore.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+const int MAX_ROWS = 64;
+
+struct Collected {
+    int rows;
+    long long id[MAX_ROWS];
+    long long rider[MAX_ROWS];
+    long long status[MAX_ROWS];
+    long long requestedAt[MAX_ROWS];
+    long long distance[MAX_ROWS];
+    long long fare[MAX_ROWS];
+};
+
+void collect(const TripColumnBatch& batch, void* ctx) {
+    Collected& c = *static_cast<Collected*>(ctx);
+    for (int r = 0; r < batch.rows && c.rows < MAX_ROWS; ++r, ++c.rows) {
+        c.id[c.rows] = batch.values[COL_ID][r];
+        c.rider[c.rows] = batch.values[COL_RIDER][r];
+        c.status[c.rows] = batch.values[COL_STATUS][r];
+        c.requestedAt[c.rows] = batch.values[COL_REQUESTED_AT][r];
+        c.distance[c.rows] = batch.values[COL_DISTANCE][r];
+        c.fare[c.rows] = batch.values[COL_FARE][r];
+    }
+}
+
+ArchivedTrip makeTrip(int id) {
+    ArchivedTrip t;
+    std::memset(&t, 0, sizeof(t));
+    t.id = id;
+    t.riderId = 100 + id % 3;
+    t.driverId = 7;
+    t.pickupLocationId = 1;
+    t.dropoffLocationId = 2 + id;
+    t.pickupZoneId = id % 2;
+    t.pickupDistance = id * 5;
+    t.status = id % 4 == 0 ? TripStatus::CANCELLED : TripStatus::COMPLETED;
+    t.distance = id * 1.25;
+    t.requestedAt = 1000000 + id * 1000LL;
+    t.finishedAt = t.requestedAt + 60000;
+    t.fare = id % 4 == 0 ? 0.0 : 5.0 + id * 0.75;
+    return t;
+}
+
+unsigned allColumns() {
+    return columnBit(COL_ID) | columnBit(COL_RIDER) | columnBit(COL_STATUS) | columnBit(COL_DISTANCE) |
+           columnBit(COL_FARE);
+}
+
+void checkRows(const Collected& c, int first, int count) {
+    CHECK_EQ(c.rows, count);
+    for (int i = 0; i < c.rows && i < count; ++i) {
+        ArchivedTrip t = makeTrip(first + i);
+        CHECK_EQ(c.id[i], t.id);
+        CHECK_EQ(c.rider[i], t.riderId);
+        CHECK_EQ(c.status[i], static_cast<long long>(t.status));
+        CHECK_EQ(c.requestedAt[i], t.requestedAt);
+        CHECK_EQ(c.distance[i], static_cast<long long>(t.distance * 100 + 0.5));
+        CHECK_EQ(c.fare[i], static_cast<long long>(t.fare * 100 + 0.5));
+    }
+}
+
+long long fileSize(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return -1;
+    std::fseek(f, 0, SEEK_END);
+    long long size = std::ftell(f);
+    std::fclose(f);
+    return size;
+}
+
+// Rewrites the first `keep` bytes of src to dst, optionally flipping the
+// byte at `flipAt` to 0xFF
+void copyPrefix(const std::string& src, const std::string& dst, long long keep, long long flipAt) {
+    FILE* in = std::fopen(src.c_str(), "rb");
+    FILE* out = std::fopen(dst.c_str(), "wb");
+    for (long long i = 0; i < keep; ++i) {
+        int ch = std::fgetc(in);
+        std::fputc(i == flipAt ? 0xFF : ch, out);
+    }
+    std::fclose(in);
+    std::fclose(out);
+}
+
+void testRoundTripAfterFailedFlush(const std::string& path) {
+    std::remove(path.c_str());
+    TripHistoryWriter writer(4);
+
+    // No file yet: the block cannot be written, so rows stay buffered
+    bool ok = true;
+    for (int id = 1; id <= 6; ++id) ok = writer.append(makeTrip(id)) && ok;
+    CHECK(!ok);
+    CHECK_EQ(writer.getBuffered(), 6);
+    CHECK(!writer.flush());
+    CHECK_EQ(writer.getTotalWritten(), 0);
+
+    // An unwritable path fails the same way
+    writer.setFilePath("/nonexistent-dir/history.bin");
+    CHECK(!writer.append(makeTrip(7)));
+    CHECK_EQ(writer.getBuffered(), 7);
+
+    // Once writable, the backlog goes out and the last block is partial
+    writer.setFilePath(path);
+    for (int id = 8; id <= 10; ++id) writer.append(makeTrip(id));
+    CHECK(writer.flush());
+    CHECK_EQ(writer.getBuffered(), 0);
+    CHECK_EQ(writer.getTotalWritten(), 10);
+
+    TripHistoryReader reader;
+    CHECK(reader.open(path));
+    CHECK_EQ(reader.getNumRows(), 10);
+    CHECK_EQ(reader.getNumBlocks(), 2);
+
+    Collected all;
+    all.rows = 0;
+    CHECK_EQ(reader.scan(0, 1LL << 62, allColumns(), collect, &all, nullptr), 10);
+    checkRows(all, 1, 10);
+
+    // Time range inside the data: [trip 3, trip 9)
+    Collected range;
+    range.rows = 0;
+    reader.scan(makeTrip(3).requestedAt, makeTrip(9).requestedAt, allColumns(), collect, &range, nullptr);
+    checkRows(range, 3, 6);
+}
+
+void testPartialBlocks(const std::string& path) {
+    std::remove(path.c_str());
+    TripHistoryWriter writer(8);
+    writer.setFilePath(path);
+    for (int id = 1; id <= 19; ++id) CHECK(writer.append(makeTrip(id)));
+    CHECK_EQ(writer.getBuffered(), 3);
+    CHECK(writer.flush());
+
+    TripHistoryReader reader;
+    CHECK(reader.open(path));
+    CHECK_EQ(reader.getNumBlocks(), 3);
+    Collected all;
+    all.rows = 0;
+    reader.scan(0, 1LL << 62, allColumns(), collect, &all, nullptr);
+    checkRows(all, 1, 19);
+
+    TripHistoryStats stats;
+    CHECK(reader.aggregate(makeTrip(1).requestedAt, makeTrip(19).requestedAt + 1, stats));
+    CHECK_EQ(stats.trips, 19);
+    CHECK_EQ(stats.cancelled, 4);
+}
+
+void testCorruptFiles(const std::string& path, const std::string& damaged) {
+    std::remove(path.c_str());
+    TripHistoryWriter writer(8);
+    writer.setFilePath(path);
+    for (int id = 1; id <= 16; ++id) writer.append(makeTrip(id));
+    CHECK_EQ(writer.getTotalWritten(), 16);
+    long long size = fileSize(path);
+
+    // Truncated mid-way through the second block: only the first survives
+    copyPrefix(path, damaged, size - 3, -1);
+    TripHistoryReader truncated;
+    CHECK(truncated.open(damaged));
+    CHECK_EQ(truncated.getNumRows(), 8);
+    Collected rows;
+    rows.rows = 0;
+    truncated.scan(0, 1LL << 62, allColumns(), collect, &rows, nullptr);
+    checkRows(rows, 1, 8);
+
+    // Garbage in the last payload byte: the second block's final chunk no
+    // longer decodes, so that block is skipped instead of read past its end
+    copyPrefix(path, damaged, size, size - 1);
+    TripHistoryReader garbled;
+    CHECK(garbled.open(damaged));
+    rows.rows = 0;
+    garbled.scan(0, 1LL << 62, allColumns(), collect, &rows, nullptr);
+    checkRows(rows, 1, 8);
+
+    // Header only
+    copyPrefix(path, damaged, 8, -1);
+    TripHistoryReader empty;
+    CHECK(empty.open(damaged));
+    CHECK_EQ(empty.getNumRows(), 0);
+}
+
+Trip makeLiveTrip(int id) {
+    ArchivedTrip a = makeTrip(id);
+    Trip trip(a.id, a.riderId, a.pickupLocationId, a.dropoffLocationId);
+    trip.setDriverId(a.driverId);
+    trip.setPickupZoneId(a.pickupZoneId);
+    trip.setPickupDistance(a.pickupDistance);
+    trip.setStatus(a.status);
+    trip.setDistance(a.distance);
+    trip.setRequestedAt(a.requestedAt);
+    trip.setFinishedAt(a.finishedAt);
+    trip.setFare(a.fare);
+    return trip;
+}
+
+// The fare survives the archive segment and its import into history
+void testArchiveFare(const std::string& segment, const std::string& path) {
+    std::remove(segment.c_str());
+    std::remove(path.c_str());
+    TripArchive archive(4);
+    archive.setFilePath(segment);
+    for (int id = 1; id <= 6; ++id) archive.append(makeLiveTrip(id));
+    CHECK(archive.flush());
+    CHECK_EQ(fileSize(segment), 8 + 6LL * TripArchive::RECORD_SIZE);
+
+    ArchivedTrip* records = nullptr;
+    CHECK_EQ(TripArchive::readFile(segment, records), 6);
+    for (int i = 0; i < 6 && records; ++i) {
+        CHECK_EQ(records[i].id, i + 1);
+        CHECK(records[i].fare == makeTrip(i + 1).fare);
+        CHECK(records[i].distance == makeTrip(i + 1).distance);
+    }
+    delete[] records;
+
+    TripHistoryWriter writer(4);
+    writer.setFilePath(path);
+    CHECK_EQ(writer.importArchive(segment), 6);
+    TripHistoryReader reader;
+    CHECK(reader.open(path));
+    Collected all;
+    all.rows = 0;
+    reader.scan(0, 1LL << 62, allColumns(), collect, &all, nullptr);
+    checkRows(all, 1, 6);
+}
+
+// A version 1 segment (no fare) is still read and keeps its record format
+// when appended to
+void testArchiveVersion1(const std::string& segment) {
+    std::remove(segment.c_str());
+    FILE* f = std::fopen(segment.c_str(), "wb");
+    unsigned char header[8] = {'R', 'S', 'T', 'A', 1, 0, 0, 0};
+    std::fwrite(header, 1, sizeof(header), f);
+    unsigned char record[TripArchive::RECORD_SIZE_V1];
+    std::memset(record, 0, sizeof(record));
+    record[0] = 42;        // id
+    record[28] = static_cast<unsigned char>(TripStatus::COMPLETED);
+    std::fwrite(record, 1, sizeof(record), f);
+    std::fclose(f);
+
+    TripArchive archive;
+    archive.setFilePath(segment);
+    archive.append(makeLiveTrip(1));
+    CHECK(archive.flush());
+    CHECK_EQ(fileSize(segment), 8 + 2LL * TripArchive::RECORD_SIZE_V1);
+
+    ArchivedTrip* records = nullptr;
+    CHECK_EQ(TripArchive::readFile(segment, records), 2);
+    if (records) {
+        CHECK_EQ(records[0].id, 42);
+        CHECK(records[0].status == TripStatus::COMPLETED);
+        CHECK_EQ(records[1].id, 1);
+        CHECK_EQ(records[1].riderId, makeTrip(1).riderId);
+        CHECK(records[1].fare == 0.0);
+    }
+    delete[] records;
+
+    // Not a segment file: nothing is appended to it
+    f = std::fopen(segment.c_str(), "wb");
+    std::fputs("not an archive", f);
+    std::fclose(f);
+    archive.append(makeLiveTrip(2));
+    CHECK(!archive.flush());
+    CHECK_EQ(archive.size(), 1);
+    CHECK_EQ(TripArchive::readFile(segment, records), -1);
+}
+
+} // namespace
+
+int main() {
+    std::string base = "/tmp/rideshare_test_history_" + std::to_string(getpid());
+    std::string path = base + ".bin";
+    std::string damaged = base + "_damaged.bin";
+    std::string segment = base + "_archive.bin";
+
+    testRoundTripAfterFailedFlush(path);
+    testPartialBlocks(path);
+    testCorruptFiles(path, damaged);
+    testArchiveFare(segment, path);
+    testArchiveVersion1(segment);
+
+    std::remove(path.c_str());
+    std::remove(damaged.c_str());
+    std::remove(segment.c_str());
+    return testFailures("test_history");
+}
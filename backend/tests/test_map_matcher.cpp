@@ -0,0 +1,148 @@
+#include "Check.h"
+#include "../src/core/City.h"
+#include "../src/engine/MapMatcher.h"
+#include <cmath>
+#include <string>
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+unsigned nextRandom(unsigned& seed) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+// Uniform in [lo, hi)
+double randomIn(unsigned& seed, double lo, double hi) {
+    return lo + (hi - lo) * (nextRandom(seed) % 1000000) / 1000000.0;
+}
+
+// Same equirectangular projection the matcher uses, from the city's bounds
+struct Projection {
+    double originLat, originLon, lonScale;
+
+    explicit Projection(const City& city) {
+        double minLat = city.getNodeAt(0).lat, maxLat = minLat, minLon = city.getNodeAt(0).lon;
+        for (int i = 1; i < city.getNumNodes(); ++i) {
+            const Node& n = city.getNodeAt(i);
+            minLat = std::fmin(minLat, n.lat);
+            maxLat = std::fmax(maxLat, n.lat);
+            minLon = std::fmin(minLon, n.lon);
+        }
+        originLat = minLat;
+        originLon = minLon;
+        lonScale = 111320.0 * std::cos((minLat + maxLat) * 0.5 * PI / 180.0);
+    }
+
+    double distance(double lat1, double lon1, double lat2, double lon2) const {
+        double dx = (lon1 - lon2) * lonScale;
+        double dy = (lat1 - lat2) * 110574.0;
+        return std::sqrt(dx * dx + dy * dy);
+    }
+};
+
+double distanceToNode(const City& city, const Projection& proj, int nodeId, double lat, double lon) {
+    const Node& n = city.getNodeAt(city.getNodeIndex(nodeId));
+    return proj.distance(lat, lon, n.lat, n.lon);
+}
+
+double bruteNearest(const City& city, const Projection& proj, double lat, double lon) {
+    double best = -1.0;
+    for (int i = 0; i < city.getNumNodes(); ++i) {
+        double d = proj.distance(lat, lon, city.getNodeAt(i).lat, city.getNodeAt(i).lon);
+        if (best < 0.0 || d < best) best = d;
+    }
+    return best;
+}
+
+// Points stored as floats: allow a little slack when comparing to doubles
+void checkAgainstBruteForce(const City& city, const MapMatcher& matcher, unsigned seed, int queries,
+                            double latLo, double latHi, double lonLo, double lonHi) {
+    Projection proj(city);
+    for (int q = 0; q < queries; ++q) {
+        double lat = randomIn(seed, latLo, latHi);
+        double lon = randomIn(seed, lonLo, lonHi);
+        double reported;
+        int nodeId = matcher.nearestNode(lat, lon, &reported);
+        CHECK(nodeId != -1);
+        if (nodeId == -1) continue;
+        double best = bruteNearest(city, proj, lat, lon);
+        CHECK(std::fabs(distanceToNode(city, proj, nodeId, lat, lon) - best) < 0.5);
+        CHECK(std::fabs(reported - best) < 0.5);
+    }
+}
+
+void testRandomNodes() {
+    City city(400);
+    unsigned seed = 42;
+    for (int id = 1; id <= 400; ++id) {
+        city.addNode(id, "N" + std::to_string(id), "Zone A", randomIn(seed, 40.70, 40.80), randomIn(seed, -74.02, -73.93));
+    }
+    MapMatcher matcher;
+    matcher.build(city);
+    CHECK_EQ(matcher.size(), 400);
+
+    // Inside the bounds and well outside them
+    checkAgainstBruteForce(city, matcher, 7, 500, 40.70, 40.80, -74.02, -73.93);
+    checkAgainstBruteForce(city, matcher, 8, 200, 40.50, 41.00, -74.30, -73.70);
+
+    // Exactly on a node
+    const Node& n = city.getNodeAt(123);
+    double reported;
+    CHECK_EQ(matcher.nearestNode(n.lat, n.lon, &reported), n.id);
+    CHECK(reported < 0.5);
+
+    // The batch call agrees with single queries
+    double lats[64], lons[64];
+    int ids[64];
+    for (int i = 0; i < 64; ++i) {
+        lats[i] = randomIn(seed, 40.69, 40.81);
+        lons[i] = randomIn(seed, -74.03, -73.92);
+    }
+    matcher.matchBatch(lats, lons, 64, ids);
+    for (int i = 0; i < 64; ++i) CHECK_EQ(ids[i], matcher.nearestNode(lats[i], lons[i]));
+}
+
+// Clustered and collinear layouts stress uneven cells and a degenerate grid
+void testSkewedLayouts() {
+    City clustered(300);
+    unsigned seed = 99;
+    for (int id = 1; id <= 300; ++id) {
+        bool dense = id <= 280;
+        double lat = dense ? randomIn(seed, 51.500, 51.502) : randomIn(seed, 51.40, 51.60);
+        double lon = dense ? randomIn(seed, -0.120, -0.118) : randomIn(seed, -0.30, 0.10);
+        clustered.addNode(id, "C" + std::to_string(id), "Zone A", lat, lon);
+    }
+    MapMatcher matcher;
+    matcher.build(clustered);
+    checkAgainstBruteForce(clustered, matcher, 3, 300, 51.40, 51.60, -0.30, 0.10);
+    checkAgainstBruteForce(clustered, matcher, 4, 300, 51.499, 51.503, -0.121, -0.117);
+
+    City line(100);
+    for (int id = 1; id <= 100; ++id) line.addNode(id, "L" + std::to_string(id), "Zone A", 10.0, 20.0 + id * 0.001);
+    MapMatcher lineMatcher;
+    lineMatcher.build(line);
+    checkAgainstBruteForce(line, lineMatcher, 5, 200, 9.99, 10.01, 19.99, 20.11);
+}
+
+void testEmpty() {
+    City city;
+    MapMatcher matcher;
+    matcher.build(city);
+    CHECK_EQ(matcher.size(), 0);
+    CHECK_EQ(matcher.nearestNode(1.0, 2.0), -1);
+
+    city.addNode(5, "Only", "Zone A", 1.0, 2.0);
+    matcher.build(city);
+    CHECK_EQ(matcher.nearestNode(-30.0, 100.0), 5);
+}
+
+} // namespace
+
+int main() {
+    testRandomNodes();
+    testSkewedLayouts();
+    testEmpty();
+    return testFailures("test_map_matcher");
+}
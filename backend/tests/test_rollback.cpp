@@ -0,0 +1,148 @@
+#include "Check.h"
+#include "../src/engine/RollbackManager.h"
+#include "../src/system/RideShareSystem.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+long long fakeNow = 1000000;
+long long fakeClock() { return fakeNow; }
+
+// Two nodes a few units apart and one driver waiting at the first
+void buildCity(RideShareSystem& system) {
+    system.setClock(fakeClock);
+    system.addNode(1, "Downtown", "Zone A");
+    system.addNode(2, "Airport", "Zone B");
+    system.addEdge(1, 2, 4);
+    system.addDriver(7, "Driver", 1, "Sedan");
+    system.addRider(1, "Rider", 1);
+}
+
+TripStatus statusOf(RideShareSystem& system, int tripId) {
+    Trip trip;
+    CHECK(system.getTripSnapshot(tripId, trip));
+    return trip.getStatus();
+}
+
+void testUndoDispatch() {
+    RideShareSystem system;
+    buildCity(system);
+
+    int tripId = system.requestTrip(1, 1, 2);
+    CHECK(system.dispatchTrip(tripId));
+    CHECK(statusOf(system, tripId) == TripStatus::ASSIGNED);
+    CHECK_EQ(system.getDriverCount(DriverStatus::BUSY), 1);
+    CHECK_EQ(system.getPendingTripCount(), 0);
+
+    // Back to REQUESTED, the driver freed and the trip queued again
+    CHECK(system.undoLastAction());
+    Trip trip;
+    CHECK(system.getTripSnapshot(tripId, trip));
+    CHECK(trip.getStatus() == TripStatus::REQUESTED);
+    CHECK_EQ(trip.getDriverId(), -1);
+    CHECK_EQ(system.getDriverCount(DriverStatus::AVAILABLE), 1);
+    CHECK_EQ(system.getPendingTripCount(), 1);
+
+    // The queued trip can be dispatched again
+    CHECK(system.dispatchTrip(tripId));
+    CHECK_EQ(system.getPendingTripCount(), 0);
+    CHECK(statusOf(system, tripId) == TripStatus::ASSIGNED);
+}
+
+std::atomic<int> availableAt(-1);
+
+void recordAvailable(const StateEvent& event, void*) {
+    if (event.type == EventType::DRIVER_STATUS && event.newState == static_cast<int>(DriverStatus::AVAILABLE)) {
+        availableAt.store(event.locationId);
+    }
+}
+
+// The AVAILABLE event reports the drop-off node, not the pickup
+void testCompleteMovesDriverFirst() {
+    RideShareSystem system;
+    buildCity(system);
+    system.subscribeEvents(recordAvailable, nullptr);
+    system.startEventLoop();
+
+    int tripId = system.requestTrip(1, 1, 2);
+    CHECK(system.dispatchTrip(tripId));
+    CHECK(system.completeTrip(tripId));
+    for (int i = 0; i < 1000 && availableAt.load() == -1; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    system.stopEventLoop();
+    CHECK_EQ(availableAt.load(), 2);
+
+    DriverView views[1];
+    unsigned long long version;
+    CHECK_EQ(system.getDriversChangedSince(0, views, version), 1);
+    CHECK_EQ(views[0].nodeId, 2);
+    CHECK(views[0].nodeName == "Airport");
+}
+
+bool isTripTwo(const Action& action, void*) { return action.tripId == 2; }
+
+void testDiscard() {
+    RollbackManager manager;
+    manager.recordAction(1, 7, TripStatus::REQUESTED, TripStatus::ASSIGNED);
+    manager.recordAction(2, 7, TripStatus::REQUESTED, TripStatus::ASSIGNED);
+    manager.recordAction(3, 8, TripStatus::REQUESTED, TripStatus::ASSIGNED);
+    manager.recordAction(2, 7, TripStatus::ASSIGNED, TripStatus::COMPLETED);
+    CHECK_EQ(manager.discard(isTripTwo, nullptr), 2);
+
+    int tripId, driverId;
+    TripStatus oldStatus, newStatus;
+    CHECK(manager.rollback(tripId, driverId, oldStatus, newStatus));
+    CHECK_EQ(tripId, 3);
+    CHECK(manager.rollback(tripId, driverId, oldStatus, newStatus));
+    CHECK_EQ(tripId, 1);
+    CHECK(!manager.rollback(tripId, driverId, oldStatus, newStatus));
+}
+
+// Compaction drops undo entries for the trips it archives
+void testUndoAfterCompaction() {
+    RideShareSystem system;
+    buildCity(system);
+    system.setTripRetention(0);
+
+    int tripId = system.requestTrip(1, 1, 2);
+    CHECK(system.cancelTrip(tripId));
+    CHECK_EQ(system.compactTrips(), 1);
+    CHECK(!system.undoLastAction());
+}
+
+// Trips archived but not yet flushed reach the segment file on shutdown
+void testArchiveFlushedOnDestroy() {
+    std::string segment = "/tmp/rideshare_test_rollback_" + std::to_string(getpid()) + ".bin";
+    std::remove(segment.c_str());
+    {
+        RideShareSystem system;
+        buildCity(system);
+        system.setTripRetention(0);
+        system.setArchivePath(segment);
+        int tripId = system.requestTrip(1, 1, 2);
+        CHECK(system.cancelTrip(tripId));
+        CHECK_EQ(system.compactTrips(), 1);
+    }
+    ArchivedTrip* records = nullptr;
+    CHECK_EQ(TripArchive::readFile(segment, records), 1);
+    if (records) CHECK(records[0].status == TripStatus::CANCELLED);
+    delete[] records;
+    std::remove(segment.c_str());
+}
+
+} // namespace
+
+int main() {
+    testUndoDispatch();
+    testCompleteMovesDriverFirst();
+    testDiscard();
+    testUndoAfterCompaction();
+    testArchiveFlushedOnDestroy();
+    return testFailures("test_rollback");
+}
@@ -0,0 +1,171 @@
+#include "Check.h"
+#include "../src/system/RideShareSystem.h"
+
+namespace {
+
+long long fakeNow = 0;
+long long fakeClock() { return fakeNow; }
+
+const int NUM_TRIPS = 12;
+const long long START = 1000000;
+const long long STEP = 1000;
+
+// Trip i (1-based) is requested at START + i * STEP from zone (i % 2), by
+// rider 1 + (i % 3); every third trip is cancelled
+void buildTrips(RideShareSystem& system) {
+    system.setClock(fakeClock);
+    system.addNode(1, "Downtown", "Zone A");
+    system.addNode(2, "Airport", "Zone B");
+    system.addEdge(1, 2, 5);
+    for (int r = 1; r <= 3; ++r) system.addRider(r, "Rider", 1);
+    for (int i = 1; i <= NUM_TRIPS; ++i) {
+        fakeNow = START + i * STEP;
+        int tripId = system.requestTrip(1 + i % 3, i % 2 == 0 ? 1 : 2, i % 2 == 0 ? 2 : 1);
+        CHECK_EQ(tripId, i);
+        if (i % 3 == 0) system.cancelTrip(tripId);
+    }
+}
+
+TripQuery anyTrip() {
+    return TripQuery{-1, -1, -1, -1, -1, -1, -1};
+}
+
+// Pages through the query; writes the ids seen and returns how many pages it took
+int readAll(RideShareSystem& system, TripQuery query, int limit, int* ids, int& numIds) {
+    Trip page[NUM_TRIPS];
+    numIds = 0;
+    int pages = 0;
+    while (true) {
+        int nextCursor;
+        int count = system.queryTrips(query, page, limit, nextCursor);
+        pages++;
+        CHECK(count <= limit);
+        for (int k = 0; k < count && numIds < NUM_TRIPS; ++k) ids[numIds++] = page[k].getId();
+        if (nextCursor == -1) break;
+        CHECK_EQ(count, limit);
+        CHECK_EQ(nextCursor, page[count - 1].getId());
+        query.afterTripId = nextCursor;
+        if (pages > NUM_TRIPS) break;
+    }
+    return pages;
+}
+
+void checkIds(const int* ids, int numIds, const int* expected, int numExpected) {
+    CHECK_EQ(numIds, numExpected);
+    for (int k = 0; k < numIds && k < numExpected; ++k) CHECK_EQ(ids[k], expected[k]);
+}
+
+void testCursorPaging(RideShareSystem& system) {
+    int ids[NUM_TRIPS];
+    int numIds;
+    int all[NUM_TRIPS];
+    for (int i = 0; i < NUM_TRIPS; ++i) all[i] = i + 1;
+
+    CHECK_EQ(readAll(system, anyTrip(), 5, ids, numIds), 3);
+    checkIds(ids, numIds, all, NUM_TRIPS);
+
+    // The last page ends exactly on the last trip: no cursor, no empty page
+    CHECK_EQ(readAll(system, anyTrip(), 4, ids, numIds), 3);
+    checkIds(ids, numIds, all, NUM_TRIPS);
+    CHECK_EQ(readAll(system, anyTrip(), NUM_TRIPS, ids, numIds), 1);
+
+    // Cursor past the end
+    TripQuery query = anyTrip();
+    query.afterTripId = NUM_TRIPS;
+    Trip page[NUM_TRIPS];
+    int nextCursor;
+    CHECK_EQ(system.queryTrips(query, page, 5, nextCursor), 0);
+    CHECK_EQ(nextCursor, -1);
+    CHECK_EQ(system.queryTrips(anyTrip(), page, 0, nextCursor), 0);
+    CHECK_EQ(nextCursor, -1);
+}
+
+void testFilteredPaging(RideShareSystem& system) {
+    int ids[NUM_TRIPS];
+    int numIds;
+
+    // Cancelled trips 3, 6, 9, 12 with requested ones after each: the page
+    // holding 12 is the last even though candidates follow earlier ones
+    TripQuery cancelled = anyTrip();
+    cancelled.status = static_cast<int>(TripStatus::CANCELLED);
+    int expectedCancelled[] = {3, 6, 9, 12};
+    CHECK_EQ(readAll(system, cancelled, 2, ids, numIds), 2);
+    checkIds(ids, numIds, expectedCancelled, 4);
+
+    // Requested trips in zone B (odd ids), status and zone both filtered:
+    // 1, 5, 7, 11
+    TripQuery zoneB = anyTrip();
+    zoneB.status = static_cast<int>(TripStatus::REQUESTED);
+    zoneB.zoneId = system.findZone("Zone B");
+    int expectedZoneB[] = {1, 5, 7, 11};
+    CHECK_EQ(readAll(system, zoneB, 2, ids, numIds), 2);
+    checkIds(ids, numIds, expectedZoneB, 4);
+
+    // Cancelled in zone B: 3 and 9. The status list is scanned and still
+    // holds 12 after the page fills on 9
+    TripQuery cancelledB = cancelled;
+    cancelledB.zoneId = system.findZone("Zone B");
+    int expectedCancelledB[] = {3, 9};
+    CHECK_EQ(readAll(system, cancelledB, 2, ids, numIds), 1);
+    checkIds(ids, numIds, expectedCancelledB, 2);
+
+    // Rider 2 requested trips 1, 4, 7, 10; 10 is the last match
+    TripQuery rider = anyTrip();
+    rider.riderId = 2;
+    int expectedRider[] = {1, 4, 7, 10};
+    CHECK_EQ(readAll(system, rider, 4, ids, numIds), 1);
+    checkIds(ids, numIds, expectedRider, 4);
+}
+
+void testTimeRange(RideShareSystem& system) {
+    int ids[NUM_TRIPS];
+    int numIds;
+
+    // [trip 4, trip 8): from is inclusive, to exclusive
+    TripQuery range = anyTrip();
+    range.fromMs = START + 4 * STEP;
+    range.toMs = START + 8 * STEP;
+    int expected[] = {4, 5, 6, 7};
+    CHECK_EQ(readAll(system, range, 3, ids, numIds), 2);
+    checkIds(ids, numIds, expected, 4);
+    // A page ending on trip 7, with trip 8 just outside the range
+    CHECK_EQ(readAll(system, range, 2, ids, numIds), 2);
+    checkIds(ids, numIds, expected, 4);
+
+    // Bounds between request times
+    range.fromMs = START + 4 * STEP - 1;
+    range.toMs = START + 8 * STEP + 1;
+    int widened[] = {4, 5, 6, 7, 8};
+    readAll(system, range, 10, ids, numIds);
+    checkIds(ids, numIds, widened, 5);
+
+    // Time range combined with a filter and a cursor
+    TripQuery cancelled = anyTrip();
+    cancelled.status = static_cast<int>(TripStatus::CANCELLED);
+    cancelled.fromMs = START + 4 * STEP;
+    cancelled.toMs = START + 12 * STEP;
+    int expectedCancelled[] = {6, 9};
+    CHECK_EQ(readAll(system, cancelled, 1, ids, numIds), 2);
+    checkIds(ids, numIds, expectedCancelled, 2);
+
+    // Empty ranges
+    range.fromMs = START + (NUM_TRIPS + 1) * STEP;
+    range.toMs = -1;
+    readAll(system, range, 5, ids, numIds);
+    CHECK_EQ(numIds, 0);
+    range.fromMs = 0;
+    range.toMs = START;
+    readAll(system, range, 5, ids, numIds);
+    CHECK_EQ(numIds, 0);
+}
+
+} // namespace
+
+int main() {
+    RideShareSystem system(10, 10, 10, 100);
+    buildTrips(system);
+    testCursorPaging(system);
+    testFilteredPaging(system);
+    testTimeRange(system);
+    return testFailures("test_states");
+}
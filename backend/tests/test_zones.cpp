@@ -0,0 +1,262 @@
+#include "Check.h"
+#include "../src/engine/PricingEngine.h"
+#include "../src/engine/RebalancingEngine.h"
+#include "../src/engine/ZoneStats.h"
+#include "../src/system/RideShareSystem.h"
+
+namespace {
+
+long long fakeNow = 1000000;
+long long fakeClock() { return fakeNow; }
+
+// Six 1 s buckets
+void testWindowExpiry() {
+    ZoneStats stats(2, 6, 1000);
+    stats.recordRequest(0, 500);
+    stats.recordRequest(0, 1500);
+    stats.recordRequest(0, 1600);
+    stats.recordRequest(1, 2500);
+    stats.recordDispatch(0, 3500, 200);
+    stats.recordDispatch(0, 3550, 400);
+    stats.recordCancellation(0, 3600);
+
+    ZoneWindow w = stats.getWindow(0, 3999, 6000);
+    CHECK_EQ(w.requests, 3);
+    CHECK_EQ(w.dispatches, 2);
+    CHECK_EQ(w.cancellations, 1);
+    CHECK(w.avgWaitMs == 300.0);
+    CHECK_EQ(stats.getCount(1, ZC_REQUESTS, 3999, 6000), 1);
+
+    // Shorter windows cover whole buckets back from now
+    CHECK_EQ(stats.getCount(0, ZC_REQUESTS, 3999, 2000), 0);
+    CHECK_EQ(stats.getCount(0, ZC_REQUESTS, 3999, 2500), 2);
+    // ... and longer ones are capped at the full window
+    CHECK_EQ(stats.getCount(0, ZC_REQUESTS, 3999, 60000), 3);
+    CHECK_EQ(stats.getWindowMs(), 6000);
+
+    // The first bucket ages out, then the next
+    CHECK_EQ(stats.getCount(0, ZC_REQUESTS, 6500, 6000), 2);
+    CHECK_EQ(stats.getCount(0, ZC_REQUESTS, 7000, 6000), 0);
+    CHECK_EQ(stats.getCount(0, ZC_DISPATCHES, 7000, 6000), 2);
+    w = stats.getWindow(0, 9999, 6000);
+    CHECK_EQ(w.requests + w.dispatches + w.cancellations, 0);
+    CHECK(w.avgWaitMs == 0.0);
+}
+
+// A bucket reused for a later period drops its old counts, and events
+// older than what it now holds are ignored
+void testBucketReuse() {
+    ZoneStats stats(1, 6, 1000);
+    stats.recordRequest(0, 500);
+    stats.recordRequest(0, 1500);
+    stats.recordRequest(0, 6200);  // same slot as 500
+    CHECK_EQ(stats.getCount(0, ZC_REQUESTS, 6500, 6000), 2);
+    CHECK_EQ(stats.getCount(0, ZC_REQUESTS, 7000, 6000), 1);
+
+    stats.recordRequest(0, 400);
+    CHECK_EQ(stats.getCount(0, ZC_REQUESTS, 6500, 6000), 2);
+}
+
+void testZoneBounds() {
+    ZoneStats stats(2, 6, 1000);
+    stats.recordRequest(-1, 100);
+    stats.recordRequest(2, 100);
+    CHECK_EQ(stats.getCount(-1, ZC_REQUESTS, 100, 6000), 0);
+    CHECK_EQ(stats.getCount(2, ZC_REQUESTS, 100, 6000), 0);
+
+    // Growing keeps existing counts and admits the new zones
+    stats.recordRequest(1, 100);
+    stats.reserveZones(5);
+    CHECK(stats.getMaxZones() >= 5);
+    stats.recordRequest(4, 200);
+    CHECK_EQ(stats.getCount(1, ZC_REQUESTS, 200, 6000), 1);
+    CHECK_EQ(stats.getCount(4, ZC_REQUESTS, 200, 6000), 1);
+}
+
+// Zone A: 5 - 1 - 2, zone B: 3 - 4 - 6, joined 2 - 3. Nodes 1 and 4 are
+// nearest their zones' centroids, so they represent the zones.
+void buildTwoZones(City& city) {
+    city.addNode(1, "A1", "Zone A", 0.0, 0.0);
+    city.addNode(2, "A2", "Zone A", 0.0, 0.3);
+    city.addNode(5, "A3", "Zone A", 0.0, -0.1);
+    city.addNode(3, "B1", "Zone B", 0.0, 1.0);
+    city.addNode(4, "B2", "Zone B", 0.0, 1.2);
+    city.addNode(6, "B3", "Zone B", 0.0, 1.4);
+    city.addEdge(5, 1, 1);
+    city.addEdge(1, 2, 3);
+    city.addEdge(2, 3, 10);
+    city.addEdge(3, 4, 2);
+    city.addEdge(4, 6, 2);
+}
+
+void testRebalancePlan() {
+    City city;
+    buildTwoZones(city);
+    RebalancingEngine engine;
+    engine.buildZoneCosts(city);
+    CHECK_EQ(engine.getNumZones(), 2);
+    CHECK_EQ(engine.getRepresentative(0), 1);
+    CHECK_EQ(engine.getRepresentative(1), 4);
+    CHECK_EQ(engine.getZoneCost(0, 1), 15);
+    CHECK_EQ(engine.getZoneCost(1, 0), 15);
+    CHECK_EQ(engine.getZoneCost(0, 0), 0);
+
+    // Four idle in A, demand split evenly: two move to B
+    ZoneMove moves[4];
+    int supply[] = {4, 0};
+    double demand[] = {1.0, 1.0};
+    CHECK_EQ(engine.plan(supply, demand, 10, moves, 4), 1);
+    CHECK_EQ(moves[0].fromZone, 0);
+    CHECK_EQ(moves[0].toZone, 1);
+    CHECK_EQ(moves[0].drivers, 2);
+    CHECK_EQ(moves[0].cost, 15);
+
+    // Capped by maxMoves; nothing to do when balanced or without demand
+    CHECK_EQ(engine.plan(supply, demand, 1, moves, 4), 1);
+    CHECK_EQ(moves[0].drivers, 1);
+    int balanced[] = {2, 2};
+    CHECK_EQ(engine.plan(balanced, demand, 10, moves, 4), 0);
+    double none[] = {0.0, 0.0};
+    CHECK_EQ(engine.plan(supply, none, 10, moves, 4), 0);
+}
+
+// Through the system, on the same map: requests in B pull A's idle drivers,
+// nearest first
+void testRebalanceSystem() {
+    RideShareSystem system;
+    system.setClock(fakeClock);
+    system.addNode(1, "A1", "Zone A", 0.0, 0.0);
+    system.addNode(2, "A2", "Zone A", 0.0, 0.3);
+    system.addNode(5, "A3", "Zone A", 0.0, -0.1);
+    system.addNode(3, "B1", "Zone B", 0.0, 1.0);
+    system.addNode(4, "B2", "Zone B", 0.0, 1.2);
+    system.addNode(6, "B3", "Zone B", 0.0, 1.4);
+    system.addEdge(5, 1, 1);
+    system.addEdge(1, 2, 3);
+    system.addEdge(2, 3, 10);
+    system.addEdge(3, 4, 2);
+    system.addEdge(4, 6, 2);
+    system.addDriver(11, "Far", 5, "Sedan");
+    system.addDriver(12, "Near", 2, "Sedan");
+    system.addDriver(13, "Mid", 1, "Sedan");
+    system.addRider(1, "Rider", 3);
+    for (int i = 0; i < 3; ++i) system.requestTrip(1, 3, 4);
+
+    CHECK_EQ(system.rebalance(), 3);
+    RepositionSuggestion out[8];
+    CHECK_EQ(system.getRepositionSuggestions(out, 8), 3);
+    int expectedDriver[] = {12, 13, 11};
+    int expectedCost[] = {12, 15, 16};
+    for (int i = 0; i < 3; ++i) {
+        CHECK_EQ(out[i].driverId, expectedDriver[i]);
+        CHECK_EQ(out[i].fromZone, 0);
+        CHECK_EQ(out[i].toZone, 1);
+        CHECK_EQ(out[i].targetNodeId, 4);
+        CHECK_EQ(out[i].cost, expectedCost[i]);
+    }
+
+    system.setMaxRepositionsPerRun(1);
+    CHECK_EQ(system.rebalance(), 1);
+    CHECK_EQ(system.getRepositionSuggestions(out, 8), 1);
+    CHECK_EQ(out[0].driverId, 12);
+
+    // Once the requests leave the demand window there is nothing to chase
+    fakeNow += system.getStatsWindowMs() + 1;
+    CHECK_EQ(system.rebalance(), 0);
+}
+
+// Default schedule: slope 0.5 per unit of demand/supply above 1, capped at 3x
+void testSurgeClamp() {
+    ZoneStats stats(4, 6, 1000);
+    PricingEngine pricing(stats, 4);
+    CHECK(pricing.getMultiplier(0) == 1.0);
+
+    // Idle drivers and no demand never push the price below 1x
+    pricing.driverArrived(0, 0);
+    pricing.driverArrived(0, 0);
+    CHECK(pricing.getMultiplier(0) == 1.0);
+    pricing.driverLeft(0, 0);
+    pricing.driverLeft(0, 0);
+    pricing.driverLeft(0, 0);  // extra departures are ignored
+    CHECK_EQ(pricing.getIdleDrivers(0), 0);
+
+    // No supply counts as one driver: 3 waiting -> 1 + 0.5 * 2
+    for (int i = 0; i < 3; ++i) pricing.requestOpened(0, 0);
+    CHECK(pricing.getMultiplier(0) == 2.0);
+    CHECK(pricing.getMultiplier(1) == 1.0);
+
+    // Far above supply the multiplier stops at the cap
+    for (int i = 0; i < 30; ++i) pricing.requestOpened(0, 0);
+    CHECK(pricing.getMultiplier(0) == 3.0);
+    FareSchedule schedule = PricingEngine::defaultSchedule();
+    schedule.maxMultiplier = 1.5;
+    pricing.setSchedule(schedule);
+    pricing.refresh(4, 0);
+    CHECK(pricing.getMultiplier(0) == 1.5);
+
+    // Closing requests brings it back down to 1x
+    for (int i = 0; i < 33; ++i) pricing.requestClosed(0, 0);
+    CHECK_EQ(pricing.getWaitingRequests(0), 0);
+    CHECK(pricing.getMultiplier(0) == 1.0);
+
+    // Unknown zones quote at 1x
+    CHECK(pricing.getMultiplier(-1) == 1.0);
+    CHECK(pricing.getMultiplier(4) == 1.0);
+    pricing.requestOpened(4, 0);
+}
+
+// Each request counts once: while it waits, then as a recent dispatch
+void testDemandCountedOnce() {
+    ZoneStats stats(2, 6, 1000);
+    PricingEngine pricing(stats, 2);
+    pricing.driverArrived(0, 0);
+
+    stats.recordRequest(0, 100);
+    pricing.requestOpened(0, 100);
+    CHECK(pricing.getMultiplier(0) == 1.0);
+    stats.recordRequest(0, 200);
+    pricing.requestOpened(0, 200);
+    CHECK(pricing.getMultiplier(0) == 1.5);
+
+    // Dispatching one keeps demand at 2 while it is in the window
+    stats.recordDispatch(0, 300, 200);
+    pricing.requestClosed(0, 300);
+    CHECK(pricing.getMultiplier(0) == 1.5);
+
+    // Cancelling the other while it waits removes it
+    pricing.requestClosed(0, 400);
+    CHECK(pricing.getMultiplier(0) == 1.0);
+
+    // Two waiting and one dispatch that has aged out of the window
+    pricing.requestOpened(0, 500);
+    pricing.requestOpened(0, 500);
+    pricing.refresh(2, 70 * 1000);
+    CHECK(pricing.getMultiplier(0) == 1.5);
+}
+
+void testFareQuote() {
+    ZoneStats stats(2, 6, 1000);
+    PricingEngine pricing(stats, 2);
+    // base 2 + 0.5 per unit, minimum 5
+    CHECK(pricing.quote(0, 20.0).fare == 12.0);
+    CHECK(pricing.quote(0, 2.0).fare == 5.0);
+
+    for (int i = 0; i < 3; ++i) pricing.requestOpened(0, 0);
+    FareQuote q = pricing.quote(0, 20.0);
+    CHECK(q.multiplier == 2.0);
+    CHECK(q.fare == 24.0);
+}
+
+} // namespace
+
+int main() {
+    testWindowExpiry();
+    testBucketReuse();
+    testZoneBounds();
+    testRebalancePlan();
+    testRebalanceSystem();
+    testSurgeClamp();
+    testDemandCountedOnce();
+    testFareQuote();
+    return testFailures("test_zones");
+}
@@ -0,0 +1,104 @@
+#include "../src/sim/CityGenerator.h"
+#include "../src/sim/TripRequestStream.h"
+#include "../src/storage/CityFile.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Generates a synthetic city and fleet into a CityFile, and optionally a
+// request capture (one JSON object per line) drawn from the same city:
+//   {"at_ms":1234,"method":"POST","path":"/api/trip/request","body":{...}}
+//
+//   rideshare_citygen --out=city.bin [--layout=grid|planar|clustered]
+//                     [--nodes=10000] [--zones=16] [--drivers=500]
+//                     [--riders=5000] [--seed=1]
+//                     [--requests=0 --rate=2000 --capture=requests.jsonl]
+//
+// Serve the city with RIDESHARE_CITY_FILE=city.bin ./rideshare_server.
+
+namespace {
+
+const char* optionValue(const char* arg, const char* name) {
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) == 0 && arg[len] == '=') return arg + len + 1;
+    return nullptr;
+}
+
+bool parseLayout(const char* name, CityLayout& out) {
+    if (std::strcmp(name, "grid") == 0) out = LAYOUT_GRID;
+    else if (std::strcmp(name, "planar") == 0) out = LAYOUT_PLANAR;
+    else if (std::strcmp(name, "clustered") == 0) out = LAYOUT_CLUSTERED;
+    else return false;
+    return true;
+}
+
+bool writeCapture(const std::string& path, const GeneratedCity& city, long long count, double rate,
+                  unsigned long long seed) {
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    DemandProfile profile = TripRequestStream::defaultProfile();
+    profile.requestsPerHour = rate;
+    TripRequestStream stream(city, profile, seed ^ 0x7e9u);
+    TripRequestSpec req;
+    for (long long i = 0; i < count; ++i) {
+        stream.next(req);
+        std::fprintf(f,
+                     "{\"at_ms\":%lld,\"method\":\"POST\",\"path\":\"/api/trip/request\",\"body\":"
+                     "{\"riderId\":%d,\"pickupNode\":%d,\"dropoffNode\":%d%s}}\n",
+                     req.atMs, req.riderId, req.pickupId, req.dropoffId, req.pooled ? ",\"pooled\":true" : "");
+    }
+    return std::fclose(f) == 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    CityGenConfig config = CityGenerator::defaultConfig();
+    std::string outPath;
+    std::string capturePath;
+    long long numRequests = 0;
+    double rate = TripRequestStream::defaultProfile().requestsPerHour;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value;
+        if ((value = optionValue(argv[i], "--out"))) outPath = value;
+        else if ((value = optionValue(argv[i], "--layout"))) {
+            if (!parseLayout(value, config.layout)) {
+                std::fprintf(stderr, "unknown layout: %s\n", value);
+                return 1;
+            }
+        }
+        else if ((value = optionValue(argv[i], "--nodes"))) config.numNodes = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--zones"))) config.numZones = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--drivers"))) config.numDrivers = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--riders"))) config.numRiders = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--seed"))) config.seed = std::strtoull(value, nullptr, 10);
+        else if ((value = optionValue(argv[i], "--requests"))) numRequests = std::atoll(value);
+        else if ((value = optionValue(argv[i], "--rate"))) rate = std::atof(value);
+        else if ((value = optionValue(argv[i], "--capture"))) capturePath = value;
+        else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (outPath.empty() && capturePath.empty()) {
+        std::fprintf(stderr, "nothing to do: pass --out and/or --capture\n");
+        return 1;
+    }
+
+    GeneratedCity city;
+    CityGenerator::generate(config, city);
+    std::fprintf(stderr, "generated %d nodes, %d edges, %d zones, %d drivers, %d riders\n", city.numNodes,
+                 city.numEdges, city.numZones, city.numDrivers, city.numRiders);
+
+    if (!outPath.empty() && !CityFile::write(outPath, city)) {
+        std::fprintf(stderr, "could not write %s\n", outPath.c_str());
+        return 1;
+    }
+    if (!capturePath.empty() && !writeCapture(capturePath, city, numRequests, rate, config.seed)) {
+        std::fprintf(stderr, "could not write %s\n", capturePath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include "../src/metrics/Metrics.h"
+#include "../include/httplib.h"
+#include "../include/json.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Open-loop HTTP load generator that replays a JSONL request capture, one
+// object per line:
+//   {"at_ms":1234,"method":"POST","path":"/api/trip/request","body":{...}}
+// (rideshare_citygen --capture writes this format; at_ms and body are
+// optional).
+//
+// Every request has an intended send time, taken from the capture's at_ms
+// (divided by --speed) or from a fixed --rate. Workers send requests in
+// order and never wait for the server before scheduling the next one, and
+// latency is measured from the intended send time rather than the actual
+// one. A stalled server therefore shows up as queueing delay in the
+// percentiles instead of silently lowering the offered load (no coordinated
+// omission).
+//
+//   rideshare_loadgen --capture=requests.jsonl [--host=localhost]
+//                     [--port=8082] [--connections=16] [--rate=0]
+//                     [--speed=1] [--duration=0] [--loop]
+//
+// Prints one JSON line per endpoint ("METHOD /path", query stripped) and a
+// total line with throughput and p50/p99/p999 latency in milliseconds.
+// Latencies cover every request, including errors and timeouts.
+
+using json = nlohmann::json;
+
+namespace {
+
+struct ReplayRequest {
+    std::string method;
+    std::string path;
+    std::string body;
+    long long offsetNs;  // intended send time relative to the start of one pass
+    int endpoint;        // index into endpoint histograms
+};
+
+struct Endpoint {
+    std::string name;
+    int histogram;
+    std::atomic<long long> sent;
+    std::atomic<long long> errors;
+};
+
+const int MAX_ENDPOINTS = 48;
+
+const char* optionValue(const char* arg, const char* name) {
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) == 0 && arg[len] == '=') return arg + len + 1;
+    return nullptr;
+}
+
+int findEndpoint(Endpoint* endpoints, int& numEndpoints, const std::string& name) {
+    for (int i = 0; i < numEndpoints; ++i) {
+        if (endpoints[i].name == name) return i;
+    }
+    if (numEndpoints == MAX_ENDPOINTS) return -1;
+    Endpoint& e = endpoints[numEndpoints];
+    e.name = name;
+    e.histogram = Metrics::registerHistogram("loadgen " + name);
+    e.sent = 0;
+    e.errors = 0;
+    return numEndpoints++;
+}
+
+bool loadCapture(const std::string& path, std::vector<ReplayRequest>& out, Endpoint* endpoints, int& numEndpoints) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    long long firstAt = -1;
+    long long lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        if (line.empty()) continue;
+        json j = json::parse(line, nullptr, false);
+        if (j.is_discarded() || !j.is_object() || !j.contains("path")) {
+            std::fprintf(stderr, "skipping malformed line %lld\n", lineNo);
+            continue;
+        }
+        ReplayRequest req;
+        req.method = j.value("method", std::string("GET"));
+        req.path = j["path"].get<std::string>();
+        if (j.contains("body")) req.body = j["body"].is_string() ? j["body"].get<std::string>() : j["body"].dump();
+        long long at = j.value("at_ms", -1LL);
+        if (at >= 0 && firstAt < 0) firstAt = at;
+        req.offsetNs = at >= 0 ? (at - firstAt) * 1000000LL : -1;
+
+        std::string route = req.path.substr(0, req.path.find('?'));
+        req.endpoint = findEndpoint(endpoints, numEndpoints, req.method + " " + route);
+        if (req.endpoint == -1) {
+            std::fprintf(stderr, "too many endpoints; skipping %s %s\n", req.method.c_str(), route.c_str());
+            continue;
+        }
+        out.push_back(req);
+    }
+    return true;
+}
+
+bool send(httplib::Client& client, const ReplayRequest& req, int& status) {
+    httplib::Result res;
+    if (req.method == "GET") res = client.Get(req.path);
+    else if (req.method == "POST") res = client.Post(req.path, req.body, "application/json");
+    else if (req.method == "PUT") res = client.Put(req.path, req.body, "application/json");
+    else if (req.method == "DELETE") res = client.Delete(req.path, req.body, "application/json");
+    else return false;
+    if (!res) return false;
+    status = res->status;
+    return true;
+}
+
+void printLine(const char* name, long long sent, long long errors, double seconds, const HistogramSnapshot& snap) {
+    std::printf("{\"endpoint\":%s,\"requests\":%lld,\"errors\":%lld,\"throughput_rps\":%.1f,"
+                "\"mean_ms\":%.3f,\"p50_ms\":%.3f,\"p99_ms\":%.3f,\"p999_ms\":%.3f,\"max_ms\":%.3f}\n",
+                json(name).dump().c_str(), sent, errors, seconds > 0 ? sent / seconds : 0.0, snap.mean() / 1e6,
+                snap.quantile(0.5) / 1e6, snap.quantile(0.99) / 1e6, snap.quantile(0.999) / 1e6, snap.max / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string capturePath;
+    std::string host = "localhost";
+    int port = 8082;
+    int connections = 16;
+    double rate = 0.0;
+    double speed = 1.0;
+    double durationSec = 0.0;
+    bool loop = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* value;
+        if ((value = optionValue(argv[i], "--capture"))) capturePath = value;
+        else if ((value = optionValue(argv[i], "--host"))) host = value;
+        else if ((value = optionValue(argv[i], "--port"))) port = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--connections"))) connections = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--rate"))) rate = std::atof(value);
+        else if ((value = optionValue(argv[i], "--speed"))) speed = std::atof(value);
+        else if ((value = optionValue(argv[i], "--duration"))) durationSec = std::atof(value);
+        else if (std::strcmp(argv[i], "--loop") == 0) loop = true;
+        else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (capturePath.empty() || connections <= 0 || speed <= 0.0) {
+        std::fprintf(stderr, "usage: rideshare_loadgen --capture=FILE [--rate=N | --speed=X] ...\n");
+        return 1;
+    }
+
+    static Endpoint endpoints[MAX_ENDPOINTS];
+    int numEndpoints = 0;
+    std::vector<ReplayRequest> requests;
+    if (!loadCapture(capturePath, requests, endpoints, numEndpoints) || requests.empty()) {
+        std::fprintf(stderr, "no requests in %s\n", capturePath.c_str());
+        return 1;
+    }
+
+    // Fixed rate overrides capture timing; captures without timestamps need it
+    bool timed = rate <= 0.0;
+    for (size_t i = 0; timed && i < requests.size(); ++i) timed = requests[i].offsetNs >= 0;
+    if (!timed && rate <= 0.0) {
+        std::fprintf(stderr, "capture has no at_ms timestamps; pass --rate\n");
+        return 1;
+    }
+    long long intervalNs = timed ? 0 : static_cast<long long>(1e9 / rate);
+    // Looping a timed capture restarts it one pass length later
+    long long passNs = timed ? static_cast<long long>(requests.back().offsetNs / speed) + 1 : 0;
+    long long durationNs = static_cast<long long>(durationSec * 1e9);
+    long long total = loop ? -1 : static_cast<long long>(requests.size());
+
+    std::atomic<long long> next(0);
+    auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    auto worker = [&]() {
+        httplib::Client client(host, port);
+        client.set_keep_alive(true);
+        client.set_tcp_nodelay(true);
+        client.set_connection_timeout(5);
+        client.set_read_timeout(30);
+        while (true) {
+            long long seq = next.fetch_add(1);
+            if (total >= 0 && seq >= total) break;
+            long long pass = seq / static_cast<long long>(requests.size());
+            const ReplayRequest& req = requests[seq % requests.size()];
+            long long offset = timed ? pass * passNs + static_cast<long long>(req.offsetNs / speed) : seq * intervalNs;
+            if (durationNs > 0 && offset >= durationNs) break;
+
+            auto intended = start + std::chrono::nanoseconds(offset);
+            std::this_thread::sleep_until(intended);
+            int status = 0;
+            bool ok = send(client, req, status);
+            long long latency =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - intended).count();
+
+            Endpoint& e = endpoints[req.endpoint];
+            e.sent++;
+            if (!ok || status >= 400) e.errors++;
+            // Failures and timeouts count too: dropping them would hide the
+            // slowest requests from the percentiles
+            Metrics::record(e.histogram, latency);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < connections; ++i) workers.emplace_back(worker);
+    for (std::thread& t : workers) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long long totalSent = 0;
+    long long totalErrors = 0;
+    HistogramSnapshot merged = {};
+    for (int i = 0; i < numEndpoints; ++i) {
+        HistogramSnapshot snap;
+        Metrics::snapshot(endpoints[i].histogram, snap);
+        if (endpoints[i].sent == 0) continue;
+        printLine(endpoints[i].name.c_str(), endpoints[i].sent, endpoints[i].errors, seconds, snap);
+        totalSent += endpoints[i].sent;
+        totalErrors += endpoints[i].errors;
+        merged.count += snap.count;
+        merged.sum += snap.sum;
+        if (snap.max > merged.max) merged.max = snap.max;
+        for (int b = 0; b < HISTOGRAM_BUCKETS; ++b) merged.buckets[b] += snap.buckets[b];
+    }
+    printLine("total", totalSent, totalErrors, seconds, merged);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "../src/sim/Simulator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Runs a discrete-event simulation of RideShareSystem on a generated city and
+// prints one JSON line per simulated hour plus a summary.
+//
+//   rideshare_sim [--hours=24] [--layout=grid|planar|clustered] [--nodes=10000]
+//                 [--zones=16] [--drivers=1500] [--riders=5000]
+//                 [--rate=2000] [--patience=300] [--seed=1]
+
+namespace {
+
+const char* optionValue(const char* arg, const char* name) {
+    size_t len = std::strlen(name);
+    if (std::strncmp(arg, name, len) == 0 && arg[len] == '=') return arg + len + 1;
+    return nullptr;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    SimConfig config = Simulator::defaultConfig();
+    for (int i = 1; i < argc; ++i) {
+        const char* value;
+        if ((value = optionValue(argv[i], "--hours"))) config.hours = std::atof(value);
+        else if ((value = optionValue(argv[i], "--layout"))) {
+            if (std::strcmp(value, "grid") == 0) config.city.layout = LAYOUT_GRID;
+            else if (std::strcmp(value, "planar") == 0) config.city.layout = LAYOUT_PLANAR;
+            else if (std::strcmp(value, "clustered") == 0) config.city.layout = LAYOUT_CLUSTERED;
+            else {
+                std::fprintf(stderr, "unknown layout: %s\n", value);
+                return 1;
+            }
+        }
+        else if ((value = optionValue(argv[i], "--nodes"))) config.city.numNodes = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--zones"))) config.city.numZones = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--drivers"))) config.city.numDrivers = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--riders"))) config.city.numRiders = std::atoi(value);
+        else if ((value = optionValue(argv[i], "--rate"))) config.demand.requestsPerHour = std::atof(value);
+        else if ((value = optionValue(argv[i], "--patience"))) config.patienceMeanSec = std::atof(value);
+        else if ((value = optionValue(argv[i], "--seed"))) {
+            config.seed = std::strtoull(value, nullptr, 10);
+            config.city.seed = config.seed;
+        }
+        else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Simulator simulator(config);
+    simulator.run();
+    return 0;
+}
@@ -306,13 +306,13 @@ const AdminDashboardContent = () => {
               <CardContent className="p-8 space-y-6">
                 <div className="space-y-4">
                   <div className="flex justify-between items-center px-1">
-                    <span className="text-[10px] font-black uppercase tracking-widest text-slate-400">Load Distribution</span>
-                    <span className="text-xs font-black italic text-primary">{realTimeMetrics?.coreEngineLoad || 82}%</span>
+                    <span className="text-[10px] font-black uppercase tracking-widest text-slate-400">Fleet Utilization</span>
+                    <span className="text-xs font-black italic text-primary">{realTimeMetrics?.fleetUtilization ?? 82}%</span>
                   </div>
                   <div className="h-1.5 w-full bg-gray-50 rounded-full overflow-hidden border border-gray-100">
                     <motion.div
                       initial={{ width: 0 }}
-                      animate={{ width: `${realTimeMetrics?.coreEngineLoad || 82}%` }}
+                      animate={{ width: `${realTimeMetrics?.fleetUtilization ?? 82}%` }}
                       transition={{ duration: 0.5 }}
                       className="h-full bg-gradient-to-r from-primary to-accent"
                     />
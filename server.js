@@ -67,7 +67,8 @@ app.use('/api', async (req, res) => {
     if (req.path === '/auth/login' || req.path === '/auth/signup') return;
 
     try {
-        const url = `${BACKEND_URL}/api${req.path}`;
+        // originalUrl keeps the /api prefix and the query string (filters, cursors)
+        const url = `${BACKEND_URL}${req.originalUrl}`;
         const response = await axios({
             method: req.method,
             url,
@@ -81,17 +82,70 @@ app.use('/api', async (req, res) => {
     }
 });
 
-// Real-time Simulation
-setInterval(() => {
-    const load = Math.floor(Math.random() * 40) + 10;
-    const availableDrivers = Math.floor(Math.random() * 20) + 5;
-    io.emit('metrics_update', {
-        coreEngineLoad: load,
-        availableDrivers: availableDrivers,
-        timestamp: new Date().toLocaleTimeString(),
-        activeTrips: Math.floor(load / 2)
+// Real-time updates pushed by the C++ engine (server-sent events)
+const relayEngineEvents = () => {
+    // 'end', 'close' and 'error' can all fire for one dropped connection
+    let reconnectScheduled = false;
+    const reconnect = () => {
+        if (reconnectScheduled) return;
+        reconnectScheduled = true;
+        setTimeout(relayEngineEvents, 2000);
+    };
+
+    const req = http.get(`${BACKEND_URL}/api/events`, (res) => {
+        if (res.statusCode !== 200) {
+            res.resume();
+            reconnect();
+            return;
+        }
+        res.setEncoding('utf8');
+        let buffer = '';
+        res.on('data', (chunk) => {
+            buffer += chunk;
+            let end;
+            while ((end = buffer.indexOf('\n\n')) !== -1) {
+                const block = buffer.slice(0, end);
+                buffer = buffer.slice(end + 2);
+                let type = 'message';
+                let data = '';
+                for (const line of block.split('\n')) {
+                    if (line.startsWith('event: ')) type = line.slice(7);
+                    else if (line.startsWith('data: ')) data += line.slice(6);
+                }
+                if (!data) continue;
+                let payload;
+                try {
+                    payload = JSON.parse(data);
+                } catch (err) {
+                    console.error('Skipping malformed engine event:', err.message);
+                    continue;
+                }
+                emitEngineEvent(type, payload);
+            }
+        });
+        res.on('end', reconnect);
+        res.on('close', reconnect);
     });
-}, 2000);
+    req.on('error', reconnect);
+};
+
+const emitEngineEvent = (type, data) => {
+    if (!data || typeof data !== 'object') return;
+    if (type === 'metrics') {
+        if (!data.drivers || !data.trips) return;
+        const { available = 0, busy = 0 } = data.drivers;
+        io.emit('metrics_update', {
+            fleetUtilization: available + busy > 0 ? Math.round((busy * 100) / (available + busy)) : 0,
+            availableDrivers: available,
+            timestamp: new Date(data.timestamp).toLocaleTimeString(),
+            activeTrips: (data.trips.assigned || 0) + (data.trips.ongoing || 0)
+        });
+    } else {
+        io.emit('engine_event', { type, ...data });
+    }
+};
+
+relayEngineEvents();
 
 io.on('connection', (socket) => {
     console.log('Client connected for real-time updates');